@@ -0,0 +1,163 @@
+//
+// Created by richard on 2021-07-08.
+//
+
+/**
+ * @file CommandListTest.cpp
+ * @brief Tests that drawing through the gm::Context command list produces the same pixels as drawing directly,
+ * with fewer SDL draw calls.
+ * @details Each scene is drawn to a target texture and read back with SDL_RenderReadPixels(). Rendering uses
+ * the software renderer on the SDL dummy video driver.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Texture.h"
+#include "RendererFixture.h"
+
+using namespace rose;
+
+static constexpr int CanvasWidth = 64;
+static constexpr int CanvasHeight = 64;
+
+/**
+ * @brief Fixture: a hidden window with a software renderer, source textures and a canvas to draw scenes on.
+ */
+struct CommandListFixture : RendererFixture {
+    gm::Texture opaque{};       ///< An opaque source texture with two colors.
+    gm::Texture translucent{};  ///< A translucent source texture drawn with blending.
+
+    /// Create the Context and the source textures.
+    bool createSources() {
+        if (!createContext(Size{CanvasWidth, CanvasHeight}))
+            return false;
+
+        opaque = gm::Texture{context, Size{8, 8}};
+        translucent = gm::Texture{context, Size{8, 8}};
+        {
+            gm::RenderTargetGuard guard{context, opaque};
+            context.setDrawColor(color::RGBA{200u, 0u, 0u, 255u});
+            context.renderClear();
+            context.fillRect(Rectangle{0, 0, 4, 8}, color::RGBA{0u, 200u, 0u, 255u});
+            guard.setRenderTarget(translucent);
+            context.setDrawColor(color::RGBA{0u, 0u, 255u, 128u});
+            context.renderClear();
+        }
+        translucent.setBlendMode(SDL_BLENDMODE_BLEND);
+        return true;
+    }
+
+    /**
+     * @brief Draw a scene on a cleared canvas and read back the pixels.
+     * @param scene The drawing operations.
+     * @param deferred Record the drawing in the command list and submit it.
+     * @param counters Set to the Context counters for the scene.
+     * @return The canvas pixels in SDL_PIXELFORMAT_RGBA8888.
+     */
+    template<typename Scene>
+    std::vector<uint32_t> render(Scene scene, bool deferred, gm::RenderStateCounters &counters) {
+        std::vector<uint32_t> pixels(CanvasWidth * CanvasHeight);
+        gm::Texture canvas{context, Size{CanvasWidth, CanvasHeight}};
+        gm::RenderTargetGuard guard{context, canvas};
+        context.setDrawColor(color::RGBA{0u, 0u, 0u, 255u});
+        context.renderClear();
+        context.setDrawBlendMode(SDL_BLENDMODE_BLEND);
+
+        context.resetRenderStateCounters();
+        if (deferred)
+            context.beginCommandList();
+        scene();
+        if (deferred)
+            check(context.submitCommandList() == 0, "submit status");
+        counters = context.renderStateCounters();
+
+        check(SDL_RenderReadPixels(context.get(), nullptr, SDL_PIXELFORMAT_RGBA8888, pixels.data(),
+                                   CanvasWidth * sizeof(uint32_t)) == 0,
+              std::string{"read pixels "} + SDL_GetError());
+        return pixels;
+    }
+
+    /// Draw a scene directly and deferred, check the pixels match and return the counters of both.
+    template<typename Scene>
+    void compare(Scene scene, gm::RenderStateCounters &direct, gm::RenderStateCounters &deferred) {
+        auto directPixels = render(scene, false, direct);
+        auto deferredPixels = render(scene, true, deferred);
+
+        size_t mismatch = 0;
+        for (size_t i = 0; i < directPixels.size(); ++i)
+            if (directPixels[i] != deferredPixels[i])
+                ++mismatch;
+        check(mismatch == 0, "pixels differ " + std::to_string(mismatch));
+
+        size_t background = 0;
+        for (auto pixel : directPixels)
+            if (pixel == 0x000000ffu)
+                ++background;
+        check(background < directPixels.size(), "nothing drawn");
+    }
+};
+
+/**
+ * @brief Copies and fills which do not overlap are grouped by texture and color into one batch each.
+ */
+struct Disjoint : CommandListFixture {
+    Disjoint() { testName = "Disjoint"; }
+
+    void performTest() override {
+        if (!createSources())
+            return;
+
+        gm::RenderStateCounters direct{}, deferred{};
+        compare([this]() {
+            for (int i = 0; i < CanvasWidth / 8; ++i) {
+                context.renderCopy(opaque, Rectangle{i * 8, 0, 8, 8});
+                context.renderCopy(translucent, Rectangle{i * 8, 8, 8, 8});
+                context.fillRect(Rectangle{i * 8, 16, 6, 6}, color::RGBA{255u, 255u, 0u, 160u});
+            }
+        }, direct, deferred);
+
+        check(direct.drawCalls == 24, "direct draw calls " + std::to_string(direct.drawCalls));
+        check(deferred.commands == 24, "recorded commands " + std::to_string(deferred.commands));
+        check(deferred.batches == 3, "batches " + std::to_string(deferred.batches));
+        check(deferred.drawCalls < direct.drawCalls, "deferred draw calls " + std::to_string(deferred.drawCalls));
+        check(deferred.textureChanges < direct.textureChanges,
+              "deferred texture changes " + std::to_string(deferred.textureChanges));
+    }
+};
+
+/**
+ * @brief Blended copies and fills which overlap are kept in drawing order, while those which do not still
+ * join earlier batches.
+ */
+struct Overlapping : CommandListFixture {
+    Overlapping() { testName = "Overlapping"; }
+
+    void performTest() override {
+        if (!createSources())
+            return;
+
+        gm::RenderStateCounters direct{}, deferred{};
+        compare([this]() {
+            context.renderCopy(opaque, Rectangle{0, 0, 16, 16});
+            context.fillRect(Rectangle{8, 8, 16, 16}, color::RGBA{255u, 255u, 255u, 96u});
+            context.renderCopy(translucent, Rectangle{4, 4, 16, 16});
+            context.renderCopy(opaque, Rectangle{16, 16, 16, 16});
+            context.fillRect(Rectangle{12, 0, 8, 8}, color::RGBA{255u, 255u, 255u, 96u});
+            context.renderCopy(opaque, Rectangle{40, 40, 16, 16});
+            context.renderCopy(translucent, Rectangle{40, 0, 16, 16});
+            context.fillRect(Rectangle{48, 48, 8, 8}, color::RGBA{0u, 255u, 255u, 200u});
+        }, direct, deferred);
+
+        check(deferred.commands == 8, "recorded commands " + std::to_string(deferred.commands));
+        check(deferred.batches < deferred.commands, "batches " + std::to_string(deferred.batches));
+        check(deferred.drawCalls < direct.drawCalls, "deferred draw calls " + std::to_string(deferred.drawCalls));
+    }
+};
+
+int main(int argc, char **argv) {
+    return runSdlTests({
+            std::make_shared<Disjoint>(),
+            std::make_shared<Overlapping>()
+    });
+}
@@ -0,0 +1,198 @@
+//
+// Created by richard on 2021-07-08.
+//
+
+/**
+ * @file CompositeFrameTest.cpp
+ * @brief Tests that frames composed on the GraphicsModel back buffer match frames composed directly.
+ * @details A moving, translucent animation is drawn under a second Window for a sequence of frames with
+ * composited animation on, then again with it off, and each frame is read back with SDL_RenderReadPixels().
+ * The sequence restores the damaged areas, falls back to a full compose when the animation moves, and resizes
+ * the back buffer. Rendering uses the SDL dummy video driver.
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Animation.h"
+#include "Application.h"
+#include "TestHarness.h"
+
+using namespace rose;
+
+/**
+ * @class CompositeApplication
+ * @brief An Application which gives the test access to its GraphicsModel.
+ */
+class CompositeApplication : public Application {
+public:
+    CompositeApplication(int argc, char **argv) : Application(argc, argv) {}
+
+    gm::GraphicsModel &graphicsModel() { return mGraphicsModel; }
+};
+
+/**
+ * @class Panel
+ * @brief A Window laid out at a fixed rectangle of the screen.
+ */
+class Panel : public Window {
+protected:
+    Rectangle mRect;
+
+public:
+    explicit Panel(const Rectangle &rect) : mRect(rect) {}
+
+    Rectangle layout(gm::Context &context, const Rectangle &screenRect) override {
+        return mRect;
+    }
+};
+
+/**
+ * @class Mover
+ * @brief An Animation which blends rectangles of a color over the screen.
+ */
+class Mover : public Animation {
+public:
+    std::vector<SDL_Rect> rects{};
+    color::RGBA color{};
+
+    Mover() {
+        mAnimationCallback = [this](gm::Context &context, const Position<int> &position, uint32_t) {
+            context.setDrawBlendMode(SDL_BLENDMODE_BLEND);
+            for (auto &rect : rects)
+                context.fillRect(Rectangle{position.x + rect.x, position.y + rect.y, rect.w, rect.h}, color);
+        };
+    }
+};
+
+/**
+ * @brief Composited and directly composed frames match through damage restore, fall back and resize.
+ */
+struct Composite : Test {
+    /// One frame of the sequence.
+    struct Step {
+        Size size;
+        std::vector<SDL_Rect> rects;
+        color::RGBA color;
+        bool full;      ///< The composited frame is expected to compose every Window.
+    };
+
+    /// A frame read back from the renderer.
+    struct Frame {
+        Size size{};
+        std::vector<uint32_t> pixels{};
+        gm::GraphicsModel::CompositionCounters counters{};
+        std::vector<SDL_Rect> damage{};
+    };
+
+    CompositeApplication &application;
+    std::vector<Step> steps{};
+
+    explicit Composite(CompositeApplication &app) : application(app) {
+        testName = "Composite";
+
+        std::vector<SDL_Rect> overlapping{{8, 8, 16, 16}, {16, 16, 16, 16}};
+        std::vector<SDL_Rect> underPanel{{48, 20, 16, 16}, {52, 24, 16, 16}};
+        color::RGBA red{255u, 0u, 0u, 128u}, green{0u, 255u, 0u, 128u}, blue{0u, 0u, 255u, 128u};
+        steps = {
+                {Size{96, 64}, overlapping, red, true},         // The first frame composes everything.
+                {Size{96, 64}, overlapping, green, false},      // Restore the merged damage.
+                {Size{96, 64}, overlapping, blue, false},
+                {Size{96, 64}, underPanel, red, true},          // Drawn outside the damage, under Panel 2.
+                {Size{96, 64}, underPanel, green, false},       // Restore areas covered by both Panels.
+                {Size{128, 80}, underPanel, blue, true},        // The back buffer is resized.
+                {Size{128, 80}, underPanel, red, false},
+        };
+    }
+
+    Frame readFrame() {
+        auto &context = application.context();
+        Frame frame{};
+        SDL_GetRendererOutputSize(context.get(), &frame.size.w, &frame.size.h);
+        frame.pixels.resize(frame.size.w * frame.size.h);
+        check(SDL_RenderReadPixels(context.get(), nullptr, SDL_PIXELFORMAT_RGBA8888, frame.pixels.data(),
+                                   frame.size.w * static_cast<int>(sizeof(uint32_t))) == 0,
+              std::string{"read pixels "} + SDL_GetError());
+        return frame;
+    }
+
+    std::vector<Frame> run(Mover &mover, bool composited) {
+        auto &model = application.graphicsModel();
+        model.setCompositedAnimation(composited);
+        model.redrawBackground();
+
+        std::vector<Frame> frames{};
+        Size size{};
+        for (auto &step : steps) {
+            if (step.size != size) {
+                SDL_SetWindowSize(model.getSdlWindow().get(), step.size.w, step.size.h);
+                size = step.size;
+            }
+            mover.rects = step.rects;
+            mover.color = step.color;
+            model.drawAll(application.screen());
+            frames.push_back(readFrame());
+            frames.back().counters = model.compositionCounters();
+            frames.back().damage = model.animationDamage();
+        }
+        return frames;
+    }
+
+    void performTest() override {
+        auto panel1 = std::make_shared<Panel>(Rectangle{0, 0, 64, 64});
+        auto panel2 = std::make_shared<Panel>(Rectangle{56, 8, 40, 48});
+        application.screen()->add(panel1);
+        application.screen()->add(panel2);
+        application.layout();
+
+        auto mover = std::make_shared<Mover>();
+        Animation::setAnimation(panel1, mover, Position<int>{});
+
+        auto composited = run(*mover, true);
+        auto direct = run(*mover, false);
+
+        gm::GraphicsModel::CompositionCounters last{};
+        for (size_t i = 0; i < steps.size(); ++i) {
+            auto name = "frame " + std::to_string(i);
+            auto &frame = composited[i];
+            check(frame.size == steps[i].size && direct[i].size == steps[i].size, name + " size");
+
+            size_t mismatch = 0;
+            for (size_t p = 0; p < frame.pixels.size() && p < direct[i].pixels.size(); ++p)
+                if (frame.pixels[p] != direct[i].pixels[p])
+                    ++mismatch;
+            check(mismatch == 0, name + " pixels differ " + std::to_string(mismatch));
+
+            auto full = frame.counters.fullFrames - last.fullFrames;
+            auto partial = frame.counters.partialFrames - last.partialFrames;
+            check(full == (steps[i].full ? 1 : 0) && partial == (steps[i].full ? 0 : 1),
+                  name + (steps[i].full ? " not composed in full" : " not restored"));
+            last = frame.counters;
+
+            check(frame.damage.size() == 1, name + " damage not merged " + std::to_string(frame.damage.size()));
+        }
+
+        // The overlapping rectangles merge to their union.
+        auto &damage = composited[1].damage;
+        check(!damage.empty() && damage[0].x == 8 && damage[0].y == 8 && damage[0].w == 24 && damage[0].h == 24,
+              "merged damage");
+
+        // The animation shows over Panel 1 and is covered by Panel 2.
+        auto &frame = composited[3];
+        check(frame.pixels[22 * frame.size.w + 50] != frame.pixels[2 * frame.size.w + 2], "animation not drawn");
+        check(frame.pixels[22 * frame.size.w + 60] == frame.pixels[2 * frame.size.w + 2], "animation over Panel 2");
+
+        Animation::removeAnimation(panel1, mover);
+    }
+};
+
+int main(int argc, char **argv) {
+    setenv("SDL_VIDEODRIVER", "dummy", 0);
+    CompositeApplication application{argc, argv};
+    application.initialize("CompositeFrameTest", Size{96, 64});
+
+    return runTests({
+            std::make_shared<Composite>(application)
+    });
+}
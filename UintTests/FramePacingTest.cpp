@@ -0,0 +1,129 @@
+//
+// Created by richard on 2021-07-02.
+//
+
+/**
+ * @file FramePacingTest.cpp
+ * @brief Tests of FramePacer intervals, drift correction, missed frame counts and the Adaptive divisor.
+ * @details The tests run on the SDL dummy video driver, which has no VSYNC, so every policy is paced by the
+ * timer. Frame work is simulated with SDL_Delay.
+ */
+
+#include <memory>
+#include "RendererFixture.h"
+
+using namespace rose::gm;
+
+/// Pace frames taking work milliseconds each, return the elapsed time in seconds.
+static double runFrames(FramePacer &pacer, int frames, Uint32 work, bool presented = true) {
+    auto start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < frames; ++frame) {
+        if (work)
+            SDL_Delay(work);
+        pacer.next(presented);
+    }
+    return static_cast<double>(SDL_GetPerformanceCounter() - start) /
+           static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+/**
+ * @brief FixedRate holds the rate over many frames without drift.
+ */
+struct FixedRate : Test {
+    FixedRate() { testName = "FixedRate"; }
+
+    void performTest() override {
+        FramePacer pacer{};
+        pacer.start(FramePacing::FixedRate, false, 60, 20);
+        auto elapsed = runFrames(pacer, 50, 5);
+        check(pacer.statistics().frames == 50, "frames " + std::to_string(pacer.statistics().frames));
+        check(pacer.statistics().missed == 0, "missed " + std::to_string(pacer.statistics().missed));
+        check(elapsed > 2.48 && elapsed < 2.53, "50 frames at 20Hz took " + std::to_string(elapsed));
+        check(pacer.statistics().maxInterval < 0.075, "max interval " +
+                                                      std::to_string(pacer.statistics().maxInterval));
+    }
+};
+
+/**
+ * @brief A long frame is counted as missed intervals, and the pacer does not rush to catch up afterwards.
+ */
+struct Overrun : Test {
+    Overrun() { testName = "Overrun"; }
+
+    void performTest() override {
+        FramePacer pacer{};
+        pacer.start(FramePacing::FixedRate, false, 60, 20);
+        runFrames(pacer, 10, 5);
+        runFrames(pacer, 1, 170);
+        auto missed = pacer.statistics().missed;
+        check(missed == 3, "long frame missed " + std::to_string(missed));
+
+        pacer.resetStatistics();
+        auto elapsed = runFrames(pacer, 10, 5);
+        check(pacer.statistics().missed == 0, "missed after " + std::to_string(pacer.statistics().missed));
+        check(elapsed > 0.48, "caught up " + std::to_string(elapsed));
+    }
+};
+
+/**
+ * @brief Idle frames are paced on the refreshes closest to the frame rate when there is no VSYNC.
+ */
+struct VSyncOnly : Test {
+    VSyncOnly() { testName = "VSyncOnly"; }
+
+    void performTest() override {
+        FramePacer pacer{};
+        pacer.start(FramePacing::VSyncOnly, false, 24, 0);
+        auto elapsed = runFrames(pacer, 48, 2, false);
+        check(pacer.statistics().missed == 0, "missed " + std::to_string(pacer.statistics().missed));
+        check(elapsed > 1.98 && elapsed < 2.03, "48 frames at 24Hz took " + std::to_string(elapsed));
+
+        // The default frame rate presents on every second refresh of a 60Hz display.
+        pacer.start(FramePacing::VSyncOnly, false, 60, 0);
+        check(pacer.statistics().divisor == 2, "default divisor " + std::to_string(pacer.statistics().divisor));
+        elapsed = runFrames(pacer, 30, 2, false);
+        check(pacer.statistics().missed == 0, "missed at 30Hz " + std::to_string(pacer.statistics().missed));
+        check(elapsed > 0.98 && elapsed < 1.03, "30 frames at 30Hz took " + std::to_string(elapsed));
+        check(pacer.frameInterval() > 0.033 && pacer.frameInterval() < 0.034,
+              "frame interval " + std::to_string(pacer.frameInterval()));
+    }
+};
+
+/**
+ * @brief Adaptive divides the refresh rate when frames do not fit, and returns after a probe period.
+ */
+struct Adaptive : Test {
+    Adaptive() { testName = "Adaptive"; }
+
+    void performTest() override {
+        FramePacer pacer{};
+        pacer.start(FramePacing::Adaptive, false, 60, 60);
+
+        // 30ms frames miss every 16.7ms refresh until the divisor reaches 2.
+        runFrames(pacer, static_cast<int>(FramePacer::AdaptWindow), 30);
+        check(pacer.statistics().divisor == 2, "divisor " + std::to_string(pacer.statistics().divisor));
+
+        pacer.resetStatistics();
+        runFrames(pacer, static_cast<int>(FramePacer::AdaptWindow), 30);
+        check(pacer.statistics().missed == 0, "missed at divisor 2 " +
+                                              std::to_string(pacer.statistics().missed));
+        check(pacer.statistics().divisor == 2, "divisor held " + std::to_string(pacer.statistics().divisor));
+
+        // Short frames return to the full rate after the probe period, and stay there.
+        // A miss from scheduling noise restarts the probe period, so allow for one.
+        for (uint32_t frame = 0; frame < 2 * FramePacer::ProbeFrames && pacer.statistics().divisor > 1; ++frame)
+            runFrames(pacer, 1, 2);
+        check(pacer.statistics().divisor == 1, "divisor restored " + std::to_string(pacer.statistics().divisor));
+        runFrames(pacer, static_cast<int>(FramePacer::AdaptWindow) * 2, 2);
+        check(pacer.statistics().divisor == 1, "probe held " + std::to_string(pacer.statistics().divisor));
+    }
+};
+
+int main(int argc, char **argv) {
+    return runSdlTests({
+            std::make_shared<FixedRate>(),
+            std::make_shared<Overrun>(),
+            std::make_shared<VSyncOnly>(),
+            std::make_shared<Adaptive>()
+    }, SDL_INIT_VIDEO | SDL_INIT_TIMER);
+}
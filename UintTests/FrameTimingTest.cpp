@@ -0,0 +1,132 @@
+//
+// Created by richard on 2021-07-01.
+//
+
+/**
+ * @file FrameTimingTest.cpp
+ * @brief Tests of the FrameTiming rolling statistics and frame budget overrun signal.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include "FrameTiming.h"
+#include "TestHarness.h"
+
+using namespace rose;
+using namespace std::chrono;
+
+/**
+ * @brief Percentiles, maximum and mean over a full window, and eviction of the oldest samples.
+ */
+struct History : Test {
+    History() { testName = "History"; }
+
+    void performTest() override {
+        FrameTimeHistory history{100};
+        auto empty = history.statistics();
+        check(empty.count == 0 && empty.max.count() == 0, "empty history");
+
+        // Add 1..100 in an order which is not sorted.
+        for (int n = 0; n < 100; ++n)
+            history.add(FrameDuration{(n * 37) % 100 + 1});
+        auto statistics = history.statistics();
+        check(statistics.count == 100, "count " + std::to_string(statistics.count));
+        check(statistics.p50.count() == 51, "p50 " + std::to_string(statistics.p50.count()));
+        check(statistics.p95.count() == 96, "p95 " + std::to_string(statistics.p95.count()));
+        check(statistics.max.count() == 100, "max " + std::to_string(statistics.max.count()));
+        check(statistics.mean.count() == 50, "mean " + std::to_string(statistics.mean.count()));
+
+        // Replace every sample, the window only holds the most recent.
+        for (int n = 0; n < 100; ++n)
+            history.add(FrameDuration{1000});
+        statistics = history.statistics();
+        check(statistics.count == 100 && statistics.p50.count() == 1000 && statistics.max.count() == 1000,
+              "window not rolled " + std::to_string(statistics.p50.count()));
+
+        history.clear();
+        check(history.statistics().count == 0, "clear");
+    }
+};
+
+/**
+ * @brief Phase times accumulate within a frame, and overruns are counted and signaled.
+ */
+struct Budget : Test {
+    Budget() { testName = "Budget"; }
+
+    void performTest() override {
+        FrameTiming timing{16};
+        timing.setBudget(FrameDuration{1000});
+
+        std::vector<std::pair<uint32_t, FrameDuration>> overruns{};
+        FramePhaseTimes overrunPhases{};
+        auto slot = FrameOverrunProtocol::createSlot();
+        slot->receiver = [&](uint32_t frame, FrameDuration total, FramePhaseTimes phases) {
+            overruns.emplace_back(frame, total);
+            overrunPhases = phases;
+        };
+        timing.frameOverrun.connect(slot);
+
+        for (uint32_t frame = 0; frame < 10; ++frame) {
+            timing.record(FramePhase::Events, FrameDuration{100});
+            timing.record(FramePhase::Animate, FrameDuration{200});
+            timing.record(FramePhase::Animate, FrameDuration{200});
+            if (frame == 7)
+                timing.record(FramePhase::BaseTexture, FrameDuration{5000});
+            timing.endFrame(frame);
+        }
+
+        check(timing.frameCount() == 10, "frame count " + std::to_string(timing.frameCount()));
+        check(timing.overrunCount() == 1, "overrun count " + std::to_string(timing.overrunCount()));
+        check(overruns.size() == 1 && overruns.front().first == 7 && overruns.front().second.count() == 5500,
+              "overrun signal");
+        check(overrunPhases[static_cast<size_t>(FramePhase::BaseTexture)].count() == 5000, "overrun phases");
+
+        check(timing.lastFrame()[static_cast<size_t>(FramePhase::Animate)].count() == 400, "accumulate");
+        check(timing.lastFrame()[static_cast<size_t>(FramePhase::BaseTexture)].count() == 0, "phase reset");
+        check(timing.statistics(FramePhase::Animate).p50.count() == 400, "phase statistics");
+        check(timing.frameStatistics().p50.count() == 500 && timing.frameStatistics().max.count() == 5500,
+              "frame statistics");
+
+        timing.setBudget(FrameDuration{0});
+        timing.record(FramePhase::Present, FrameDuration{100000});
+        timing.endFrame(10);
+        check(overruns.size() == 1, "zero budget disables overrun checks");
+
+        timing.reset();
+        check(timing.frameCount() == 0 && timing.overrunCount() == 0 && timing.frameStatistics().count == 0,
+              "reset");
+    }
+};
+
+/**
+ * @brief PhaseTimer measures its scope only when built with ROSE_FRAME_TIMING.
+ */
+struct Timer : Test {
+    Timer() { testName = "Timer"; }
+
+    void performTest() override {
+        FrameTiming timing{};
+        {
+            FrameTiming::PhaseTimer phaseTimer{timing, FramePhase::FrameSignal};
+            std::this_thread::sleep_for(milliseconds{5});
+        }
+        timing.endFrame(0);
+
+        auto measured = timing.lastFrame()[static_cast<size_t>(FramePhase::FrameSignal)];
+        if constexpr (FrameTiming::Enabled)
+            check(measured >= milliseconds{5}, "measured " + std::to_string(measured.count()));
+        else
+            check(measured.count() == 0, "measured when disabled " + std::to_string(measured.count()));
+    }
+};
+
+int main(int argc, char **argv) {
+    return runTests({
+            std::make_shared<History>(),
+            std::make_shared<Budget>(),
+            std::make_shared<Timer>()
+    });
+}
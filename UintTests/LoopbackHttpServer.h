@@ -0,0 +1,335 @@
+//
+// Created by richard on 2021-06-28.
+//
+
+/**
+ * @file LoopbackHttpServer.h
+ * @brief A minimal HTTP/1.1 server on the loopback interface to stand in for web resources in tests.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @class LoopbackHttpServer
+ * @brief Serve fixture resources from memory on 127.0.0.1 at an ephemeral port.
+ * @details Connections are kept alive and served on their own thread. Resources may carry a status code and
+ * ETag/Last-Modified validators, conditional requests matching the validators are answered with 304. A
+ * per request latency and a per connection bandwidth limit simulate slow networks. The server counts accepted
+ * connections, requests and conditional requests so tests can verify connection reuse and revalidation.
+ */
+class LoopbackHttpServer {
+public:
+    /// A parsed request.
+    struct Request {
+        std::string method{};
+        std::string path{};
+        std::map<std::string, std::string> headers{};   ///< Header names are lower case.
+    };
+
+    /// A response to send.
+    struct Response {
+        int status{200};
+        std::string reason{"OK"};
+        std::vector<std::string> headers{};
+        std::string body{};
+    };
+
+    /// A served resource.
+    struct Resource {
+        std::string body{};
+        int status{200};
+        std::string eTag{};                     ///< Sent as ETag and matched against If-None-Match.
+        std::string lastModified{};             ///< Sent as Last-Modified and matched against If-Modified-Since.
+        std::vector<std::string> headers{};     ///< Additional response headers.
+    };
+
+    /// A request handler.
+    using Handler = std::function<Response(const Request &)>;
+
+protected:
+    int mListen{-1};
+    uint16_t mPort{0};
+    std::atomic_bool mRun{true};
+    std::thread mAcceptThread{};
+    std::mutex mMutex{};
+    std::vector<std::thread> mConnections{};
+    std::vector<int> mSockets{};
+    std::map<std::string, Resource> mResources{};
+    Handler mHandler{};
+    std::chrono::milliseconds mLatency{0};
+    size_t mBandwidth{0};
+
+    std::atomic_size_t mConnectionCount{0};
+    std::atomic_size_t mRequestCount{0};
+    std::atomic_size_t mConditionalCount{0};
+    std::atomic_size_t mNotModifiedCount{0};
+
+    static std::string reasonPhrase(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 304: return "Not Modified";
+            case 404: return "Not Found";
+            case 408: return "Request Timeout";
+            case 429: return "Too Many Requests";
+            case 500: return "Internal Server Error";
+            case 503: return "Service Unavailable";
+            default: return "Status";
+        }
+    }
+
+    static bool readRequest(int fd, std::string &buffer, Request &request) {
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            char block[4096];
+            auto n = ::recv(fd, block, sizeof(block), 0);
+            if (n <= 0)
+                return false;
+            buffer.append(block, static_cast<size_t>(n));
+        }
+
+        std::istringstream strm{buffer.substr(0, end)};
+        buffer.erase(0, end + 4);
+
+        std::string line{};
+        std::getline(strm, line);
+        std::istringstream requestLine{line};
+        requestLine >> request.method >> request.path;
+        request.headers.clear();
+        while (std::getline(strm, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (auto colon = line.find(':'); colon != std::string::npos) {
+                auto name = line.substr(0, colon);
+                for (auto &c : name)
+                    c = static_cast<char>(std::tolower(c));
+                auto value = line.substr(line.find_first_not_of(' ', colon + 1));
+                request.headers[name] = value;
+            }
+        }
+        return true;
+    }
+
+    static bool sendAll(int fd, const char *data, size_t size) {
+        while (size) {
+            auto n = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /// Send data no faster than bandwidth bytes per second, in slices of 1/20 second.
+    static bool sendThrottled(int fd, const char *data, size_t size, size_t bandwidth) {
+        if (!bandwidth)
+            return sendAll(fd, data, size);
+
+        auto slice = std::max(bandwidth / 20, static_cast<size_t>(1));
+        auto next = std::chrono::steady_clock::now();
+        while (size) {
+            std::this_thread::sleep_until(next);
+            auto n = std::min(slice, size);
+            if (!sendAll(fd, data, n))
+                return false;
+            data += n;
+            size -= n;
+            next += std::chrono::milliseconds{50};
+        }
+        return true;
+    }
+
+    Response serveResource(const Request &request) {
+        Response response{};
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto found = mResources.find(request.path);
+        if (found == mResources.end()) {
+            response.status = 404;
+            response.reason = reasonPhrase(response.status);
+            return response;
+        }
+
+        auto &resource = found->second;
+        response.status = resource.status;
+        response.headers = resource.headers;
+        if (!resource.eTag.empty())
+            response.headers.push_back("ETag: " + resource.eTag);
+        if (!resource.lastModified.empty())
+            response.headers.push_back("Last-Modified: " + resource.lastModified);
+
+        auto noneMatch = request.headers.find("if-none-match");
+        auto modifiedSince = request.headers.find("if-modified-since");
+        if (noneMatch != request.headers.end() || modifiedSince != request.headers.end())
+            ++mConditionalCount;
+
+        bool notModified;
+        if (noneMatch != request.headers.end())
+            notModified = !resource.eTag.empty() && noneMatch->second == resource.eTag;
+        else
+            notModified = modifiedSince != request.headers.end() && !resource.lastModified.empty() &&
+                          modifiedSince->second == resource.lastModified;
+
+        if (resource.status == 200 && notModified) {
+            ++mNotModifiedCount;
+            response.status = 304;
+        } else {
+            response.body = resource.body;
+        }
+        response.reason = reasonPhrase(response.status);
+        return response;
+    }
+
+    void serveConnection(int fd) {
+        std::string buffer{};
+        Request request{};
+        while (mRun && readRequest(fd, buffer, request)) {
+            ++mRequestCount;
+            std::chrono::milliseconds latency;
+            size_t bandwidth;
+            {
+                std::lock_guard<std::mutex> lockGuard{mMutex};
+                latency = mLatency;
+                bandwidth = mBandwidth;
+            }
+            if (latency.count())
+                std::this_thread::sleep_for(latency);
+
+            auto response = mHandler ? mHandler(request) : serveResource(request);
+
+            std::ostringstream head{};
+            head << "HTTP/1.1 " << response.status << ' ' << response.reason << "\r\n"
+                 << "Content-Length: " << response.body.size() << "\r\n";
+            for (auto &header : response.headers)
+                head << header << "\r\n";
+            head << "\r\n";
+            auto message = head.str();
+            if (request.method != "HEAD" && response.status != 304)
+                message.append(response.body);
+
+            if (!sendThrottled(fd, message.data(), message.size(), bandwidth))
+                break;
+        }
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    void acceptConnections() {
+        while (mRun) {
+            auto fd = ::accept(mListen, nullptr, nullptr);
+            if (fd < 0)
+                break;
+            ++mConnectionCount;
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            mSockets.push_back(fd);
+            mConnections.emplace_back(&LoopbackHttpServer::serveConnection, this, fd);
+        }
+    }
+
+public:
+    LoopbackHttpServer() {
+        mListen = ::socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        ::setsockopt(mListen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        socklen_t length = sizeof(address);
+        if (::bind(mListen, reinterpret_cast<sockaddr *>(&address), length) == 0 && ::listen(mListen, 64) == 0 &&
+            ::getsockname(mListen, reinterpret_cast<sockaddr *>(&address), &length) == 0) {
+            mPort = ntohs(address.sin_port);
+            mAcceptThread = std::thread(&LoopbackHttpServer::acceptConnections, this);
+        }
+    }
+
+    ~LoopbackHttpServer() {
+        mRun = false;
+        ::shutdown(mListen, SHUT_RDWR);
+        ::close(mListen);
+        if (mAcceptThread.joinable())
+            mAcceptThread.join();
+
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        for (auto fd : mSockets)
+            ::shutdown(fd, SHUT_RDWR);
+        for (auto &thread : mConnections)
+            if (thread.joinable())
+                thread.join();
+        for (auto fd : mSockets)
+            ::close(fd);
+    }
+
+    LoopbackHttpServer(const LoopbackHttpServer &) = delete;
+
+    LoopbackHttpServer(LoopbackHttpServer &&) = delete;
+
+    LoopbackHttpServer &operator=(const LoopbackHttpServer &) = delete;
+
+    LoopbackHttpServer &operator=(LoopbackHttpServer &&) = delete;
+
+    /// True if the server is listening.
+    explicit operator bool() const { return mPort != 0; }
+
+    /// The root URI of the server, ending with '/'.
+    std::string rootUri() const {
+        return "http://127.0.0.1:" + std::to_string(mPort) + '/';
+    }
+
+    /// Add or replace a resource served at path.
+    void setResource(const std::string &path, Resource resource) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mResources[path] = std::move(resource);
+    }
+
+    /// Add or replace a resource served at path with status 200 and no validators.
+    void setResource(const std::string &path, std::string body) {
+        Resource resource{};
+        resource.body = std::move(body);
+        setResource(path, std::move(resource));
+    }
+
+    /// Delay each response by latency.
+    void setLatency(std::chrono::milliseconds latency) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mLatency = latency;
+    }
+
+    /// Limit each connection to bytesPerSecond, 0 for no limit.
+    void setBandwidth(size_t bytesPerSecond) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mBandwidth = bytesPerSecond;
+    }
+
+    /// Replace the default resource handler, set before the first request.
+    void setHandler(Handler handler) {
+        mHandler = std::move(handler);
+    }
+
+    /// The number of connections accepted.
+    size_t connectionCount() const { return mConnectionCount; }
+
+    /// The number of requests served.
+    size_t requestCount() const { return mRequestCount; }
+
+    /// The number of conditional requests received by the resource server.
+    size_t conditionalCount() const { return mConditionalCount; }
+
+    /// The number of 304 responses sent by the resource server.
+    size_t notModifiedCount() const { return mNotModifiedCount; }
+};
@@ -0,0 +1,198 @@
+//
+// Created by richard on 2021-07-08.
+//
+
+/**
+ * @file RenderStateTest.cpp
+ * @brief Tests of the gm::Context shadow render state and the guards which set and restore it.
+ * @details The renderer state is read back through the SDL API to check the shadow state matches it. Rendering
+ * uses the software renderer on the SDL dummy video driver.
+ */
+
+#include <memory>
+#include <string>
+#include "Texture.h"
+#include "RendererFixture.h"
+
+using namespace rose;
+
+/**
+ * @brief Fixture: a renderer with access to the renderer state.
+ */
+struct RenderStateFixture : RendererFixture {
+    /// The draw color set on the renderer, after pending state is applied.
+    SDL_Color rendererColor() {
+        SDL_Color color{};
+        SDL_GetRenderDrawColor(context.get(), &color.r, &color.g, &color.b, &color.a);
+        return color;
+    }
+
+    /// The clip rectangle set on the renderer.
+    SDL_Rect rendererClip() {
+        SDL_Rect clip{};
+        SDL_RenderGetClipRect(context.get(), &clip);
+        return clip;
+    }
+};
+
+/**
+ * @brief A DrawColorGuard restores the draw color, and a color set and restored without drawing is not issued.
+ */
+struct DrawColor : RenderStateFixture {
+    DrawColor() { testName = "DrawColor"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        SDL_Color base{10, 20, 30, 255};
+        SDL_Color guarded{200, 100, 50, 255};
+        context.setDrawColor(base);
+        check(rendererColor() == base, "base color");
+
+        context.resetRenderStateCounters();
+        {
+            gm::DrawColorGuard guard{context, guarded};
+            check(static_cast<bool>(guard), "guard status");
+            check(context.getDrawColor() == guarded, "guarded color");
+        }
+        check(context.getDrawColor() == base, "color not restored");
+        check(rendererColor() == base, "renderer color not restored");
+        auto counters = context.renderStateCounters();
+        check(counters.issued == 0, "issued without drawing " + std::to_string(counters.issued));
+        check(counters.skipped >= 3, "skipped without drawing " + std::to_string(counters.skipped));
+
+        context.resetRenderStateCounters();
+        {
+            gm::DrawColorGuard guard{context, guarded};
+            context.drawLine(Position<int>{0, 0}, Position<int>{8, 8});
+            check(rendererColor() == guarded, "renderer color while drawing");
+        }
+        check(rendererColor() == base, "renderer color restored after drawing");
+        counters = context.renderStateCounters();
+        check(counters.issued == 2, "issued with drawing " + std::to_string(counters.issued));
+
+        // Setting the current color again does not reach the renderer.
+        context.resetRenderStateCounters();
+        context.setDrawColor(base);
+        context.drawLine(Position<int>{0, 0}, Position<int>{8, 8});
+        counters = context.renderStateCounters();
+        check(counters.issued == 0 && counters.skipped == 1, "same color issued " +
+                                                             std::to_string(counters.issued));
+    }
+};
+
+/**
+ * @brief A ClipRectangleGuard restores the clip rectangle, both enabled and disabled.
+ */
+struct ClipRectangle : RenderStateFixture {
+    ClipRectangle() { testName = "ClipRectangle"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        SDL_Rect none{0, 0, 0, 0};
+        SDL_Rect outer{4, 4, 40, 40};
+        SDL_Rect inner{8, 8, 16, 16};
+
+        context.setClipRect(nullptr);
+        {
+            gm::ClipRectangleGuard guard{context, inner};
+            check(static_cast<bool>(guard), "guard status");
+            check(rendererClip() == inner, "renderer clip in guard");
+        }
+        check(context.getClipRect() == none, "disabled clip not restored");
+        check(rendererClip() == none, "renderer clip not disabled");
+
+        context.setClipRect(&outer);
+        {
+            gm::ClipRectangleGuard guard{context, inner};
+            check(context.getClipRect() == inner, "shadow clip in guard");
+        }
+        check(context.getClipRect() == outer, "clip not restored");
+        check(rendererClip() == outer, "renderer clip not restored");
+
+        context.resetRenderStateCounters();
+        context.setClipRect(&outer);
+        context.getClipRect();
+        auto counters = context.renderStateCounters();
+        check(counters.issued == 0 && counters.skipped == 2, "current clip issued " +
+                                                             std::to_string(counters.issued));
+    }
+};
+
+/**
+ * @brief A RenderTargetGuard restores the render target, and the target change resets the shadow clip.
+ */
+struct RenderTarget : RenderStateFixture {
+    RenderTarget() { testName = "RenderTarget"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        gm::Texture texture{context, Size{32, 32}};
+        SDL_Rect clip{2, 2, 10, 10};
+        context.setClipRect(&clip);
+        {
+            gm::RenderTargetGuard guard{context, texture};
+            check(static_cast<bool>(guard), "guard status");
+            check(context.getRenderTarget() == texture.get(), "shadow target in guard");
+            check(SDL_GetRenderTarget(context.get()) == texture.get(), "renderer target in guard");
+            check(context.getClipRect() == rendererClip(), "clip after target change");
+
+            context.resetRenderStateCounters();
+            guard.setRenderTarget(texture);
+            check(context.renderStateCounters().skipped == 1 && context.renderStateCounters().issued == 0,
+                  "current target issued");
+        }
+        check(context.getRenderTarget() == nullptr, "shadow target not restored");
+        check(SDL_GetRenderTarget(context.get()) == nullptr, "renderer target not restored");
+    }
+};
+
+/**
+ * @brief After the renderer state is changed through the SDL API, invalidateRenderState() reads it back.
+ */
+struct Invalidate : RenderStateFixture {
+    Invalidate() { testName = "Invalidate"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        context.setDrawColor(SDL_Color{1, 2, 3, 255});
+        context.setDrawBlendMode(SDL_BLENDMODE_NONE);
+        auto renderer = context.get();
+        SDL_SetRenderDrawColor(renderer, 40, 50, 60, 255);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        context.invalidateRenderState();
+
+        context.resetRenderStateCounters();
+        check(context.getDrawColor() == SDL_Color{40, 50, 60, 255}, "color read back");
+        check(context.getDrawBlendMode() == SDL_BLENDMODE_BLEND, "blend mode read back");
+        check(context.renderStateCounters().issued == 2, "read back issued " +
+                                                         std::to_string(context.renderStateCounters().issued));
+
+        context.getDrawColor();
+        context.getDrawBlendMode();
+        check(context.renderStateCounters().issued == 2 && context.renderStateCounters().skipped == 2,
+              "second read issued");
+
+        // Setting a color before any is known is applied when drawing.
+        context.invalidateRenderState();
+        SDL_Color color{70, 80, 90, 255};
+        check(context.setDrawColor(color) == 0, "set unknown color");
+        check(rendererColor() == color, "unknown color not applied");
+    }
+};
+
+int main(int argc, char **argv) {
+    return runSdlTests({
+            std::make_shared<DrawColor>(),
+            std::make_shared<ClipRectangle>(),
+            std::make_shared<RenderTarget>(),
+            std::make_shared<Invalidate>()
+    });
+}
@@ -0,0 +1,60 @@
+//
+// Created by richard on 2021-07-08.
+//
+
+/**
+ * @file RendererFixture.h
+ * @brief The renderer fixture and SDL runner shared by the unit test programs which draw.
+ * @details Tests render with the software renderer on the SDL dummy video driver so they run without a display.
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include "GraphicsModel.h"
+#include "TestHarness.h"
+
+/**
+ * @brief Fixture: a hidden window with a software renderer.
+ */
+struct RendererFixture : Test {
+    rose::gm::SdlWindow window{};
+    rose::gm::Context context{};
+
+    /**
+     * @brief Create the window and Context, recording a failed check if the renderer is not available.
+     * @param size The window size.
+     * @return True if the Context is valid.
+     */
+    bool createContext(rose::Size size = rose::Size{64, 64}) {
+        window.reset(SDL_CreateWindow(testName.c_str(), 0, 0, size.w, size.h, SDL_WINDOW_HIDDEN));
+        if (window)
+            context = rose::gm::Context{window, -1, SDL_RENDERER_SOFTWARE};
+        check(static_cast<bool>(context), std::string{"renderer "} + SDL_GetError());
+        return static_cast<bool>(context);
+    }
+};
+
+/**
+ * @brief Initialize SDL on the dummy video driver, run the tests and quit SDL.
+ * @param testList The tests, run in order.
+ * @param flags The SDL subsystems to initialize.
+ * @return The runTests() status, or 1 if SDL could not be initialized.
+ */
+inline int runSdlTests(const std::vector<std::shared_ptr<Test>> &testList, Uint32 flags = SDL_INIT_VIDEO) {
+    setenv("SDL_VIDEODRIVER", "dummy", 0);
+    if (SDL_Init(flags)) {
+        std::cerr << "SDL_Init: " << SDL_GetError() << '\n';
+        return 1;
+    }
+
+    auto status = runTests(testList);
+
+    SDL_Quit();
+    return status;
+}
@@ -0,0 +1,312 @@
+//
+// Created by richard on 2021-07-05.
+//
+
+/**
+ * @file SurfacePixelTest.cpp
+ * @brief Tests of gm::Surface pitch correct pixel and row access, the bulk pixel converters against
+ * SDL_GetRGBA() and SDL_MapRGBA(), and uploads into existing Textures.
+ * @details The upload tests render with the software renderer on the SDL dummy video driver.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include "Surface.h"
+#include "Text.h"
+#include "RendererFixture.h"
+
+using namespace rose;
+using namespace std::chrono;
+
+/// A pixel value with a different byte in each position.
+static uint32_t testPixel(size_t n) {
+    return static_cast<uint32_t>(n * 2654435761u);
+}
+
+/**
+ * @brief pixel() and row() locate rows by pitch, not width.
+ */
+struct Pitch : Test {
+    Pitch() { testName = "Pitch"; }
+
+    void performTest() override {
+        static constexpr int Width = 5, Height = 4, Pitch = 32;
+        std::vector<uint32_t> memory(Pitch / 4 * Height, 0);
+        gm::Surface surface{SDL_CreateRGBSurfaceWithFormatFrom(memory.data(), Width, Height, 32, Pitch,
+                                                               SDL_PIXELFORMAT_RGBA8888)};
+        check(static_cast<bool>(surface), "surface created");
+        if (!surface)
+            return;
+
+        surface.pixel(Width - 1, 2) = 0x11223344;
+        check(memory[2 * Pitch / 4 + Width - 1] == 0x11223344, "pixel() used width for pitch");
+
+        auto row = surface.row(3);
+        check(row.size() == Width && row.data() == &memory[3 * Pitch / 4], "row(y)");
+        for (auto &pixel : row)
+            pixel = 0xdeadbeef;
+        check(memory[3 * Pitch / 4] == 0xdeadbeef && memory[3 * Pitch / 4 + Width - 1] == 0xdeadbeef &&
+              memory[3 * Pitch / 4 + Width] == 0, "row span bounds");
+
+        auto part = surface.row(1, 2, 2);
+        check(part.size() == 2 && part.data() == &memory[Pitch / 4 + 2], "row(y, x, width)");
+    }
+};
+
+/**
+ * @brief The format specialised converters agree with SDL for every supported layout and the fallback.
+ */
+struct Convert : Test {
+    Convert() { testName = "Convert"; }
+
+    void convert(uint32_t formatEnum, const std::string &name) {
+        std::unique_ptr<SDL_PixelFormat, decltype(&SDL_FreeFormat)> format{SDL_AllocFormat(formatEnum),
+                                                                           &SDL_FreeFormat};
+        check(static_cast<bool>(format), name + " format");
+        if (!format)
+            return;
+
+        static constexpr size_t Count = 257;
+        auto bits = format->BitsPerPixel;
+        auto pixelMask = bits < 32 ? (1u << bits) - 1u : ~0u;
+        std::vector<uint32_t> pixels(Count);
+        for (size_t n = 0; n < Count; ++n)
+            pixels[n] = testPixel(n) & pixelMask;
+
+        std::vector<uint8_t> rgba8(4 * Count);
+        gm::pixelsToRGBA8(format.get(), pixels.data(), Count, rgba8.data());
+        bool match = true;
+        for (size_t n = 0; n < Count; ++n) {
+            uint8_t r, g, b, a;
+            SDL_GetRGBA(pixels[n], format.get(), &r, &g, &b, &a);
+            match &= rgba8[4 * n] == r && rgba8[4 * n + 1] == g && rgba8[4 * n + 2] == b && rgba8[4 * n + 3] == a;
+        }
+        check(match, name + " pixelsToRGBA8");
+
+        std::vector<uint32_t> mapped(Count);
+        gm::rgba8ToPixels(format.get(), rgba8.data(), Count, mapped.data());
+        match = true;
+        for (size_t n = 0; n < Count; ++n)
+            match &= mapped[n] == SDL_MapRGBA(format.get(), rgba8[4 * n], rgba8[4 * n + 1], rgba8[4 * n + 2],
+                                              rgba8[4 * n + 3]);
+        check(match, name + " rgba8ToPixels");
+
+        std::vector<color::RGBA> rgba(Count);
+        gm::pixelsToRGBA(format.get(), pixels.data(), Count, rgba.data());
+        std::vector<uint32_t> roundTrip(Count);
+        gm::rgbaToPixels(format.get(), rgba.data(), Count, roundTrip.data());
+        check(roundTrip == mapped, name + " RGBA round trip");
+        check(gm::getRGBA(format.get(), pixels[7]) == rgba[7], name + " getRGBA");
+        check(gm::mapRGBA(format.get(), rgba[7]) == mapped[7], name + " mapRGBA");
+    }
+
+    void performTest() override {
+        convert(SDL_PIXELFORMAT_RGBA8888, "RGBA8888");
+        convert(SDL_PIXELFORMAT_ARGB8888, "ARGB8888");
+        convert(SDL_PIXELFORMAT_ABGR8888, "ABGR8888");
+        convert(SDL_PIXELFORMAT_RGB888, "RGB888");
+        convert(SDL_PIXELFORMAT_RGB565, "RGB565");
+    }
+};
+
+/**
+ * @brief Rectangle reads and writes, and color()/setColor().
+ */
+struct Rect : Test {
+    Rect() { testName = "Rect"; }
+
+    void performTest() override {
+        gm::Surface surface{8, 6};
+        for (int y = 0; y < surface->h; ++y)
+            for (int x = 0; x < surface->w; ++x)
+                surface.pixel(x, y) = testPixel(static_cast<size_t>(y * surface->w + x));
+
+        Rectangle rect{2, 1, 4, 3};
+        std::vector<uint8_t> rgba8(static_cast<size_t>(4 * rect.w * rect.h));
+        surface.readRGBA8(rect, rgba8.data());
+        auto expected = surface.color(rect.x + 1, rect.y + 2);
+        auto offset = 4 * (2 * rect.w + 1);
+        check(color::RGBA{(uint) rgba8[offset], (uint) rgba8[offset + 1], (uint) rgba8[offset + 2],
+                          (uint) rgba8[offset + 3]} == expected, "readRGBA8");
+
+        gm::Surface copy{8, 6};
+        copy.fillRectangle(color::RGBA::TransparentBlack);
+        copy.writeRGBA8(rect, rgba8.data());
+        bool match = true;
+        for (int y = 0; y < copy->h; ++y)
+            for (int x = 0; x < copy->w; ++x) {
+                bool inside = x >= rect.x && x < rect.x + rect.w && y >= rect.y && y < rect.y + rect.h;
+                match &= copy.pixel(x, y) == (inside ? surface.pixel(x, y) : 0u);
+            }
+        check(match, "writeRGBA8");
+
+        std::vector<color::RGBA> rgba(static_cast<size_t>(rect.w * rect.h));
+        surface.readRGBA(rect, rgba.data());
+        copy.fillRectangle(color::RGBA::TransparentBlack);
+        copy.writeRGBA(rect, rgba.data());
+        check(copy.pixel(rect.x + 3, rect.y + 2) == surface.pixel(rect.x + 3, rect.y + 2), "RGBA rectangle");
+
+        color::RGBA blue{0u, 0u, 255u, 255u};
+        copy.setColor(0, 0, blue);
+        check(copy.color(0, 0) == blue, "setColor blue channel");
+    }
+};
+
+/**
+ * @brief Uploads into existing streaming Textures, whole and by dirty rectangle, with and without conversion.
+ */
+struct Upload : RendererFixture {
+    Upload() { testName = "Upload"; }
+
+    /// Copy texture to the render target and compare it with surface.
+    bool matches(gm::Texture &texture, const gm::Surface &surface) {
+        auto renderer = context.get();
+        SDL_Rect rect{0, 0, surface->w, surface->h};
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        texture.setBlendMode(SDL_BLENDMODE_NONE);
+        SDL_RenderCopy(renderer, texture.get(), nullptr, &rect);
+
+        gm::Surface expected{surface->w, surface->h};
+        SDL_BlitSurface(surface.get(), nullptr, expected.get(), nullptr);
+        std::vector<uint32_t> pixels(static_cast<size_t>(surface->w * surface->h));
+        if (SDL_RenderReadPixels(renderer, &rect, SDL_PIXELFORMAT_RGBA8888, pixels.data(), 4 * surface->w))
+            return false;
+        for (int y = 0; y < surface->h; ++y)
+            for (int x = 0; x < surface->w; ++x)
+                if (pixels[y * surface->w + x] != expected.pixel(x, y))
+                    return false;
+        return true;
+    }
+
+    static void fill(gm::Surface &surface, size_t seed) {
+        for (int y = 0; y < surface->h; ++y)
+            for (int x = 0; x < surface->w; ++x)
+                surface.setColor(x, y, color::RGBA{(uint) (seed + x * 16), (uint) (seed + y * 32),
+                                                   (uint) (seed * 7 + x + y), 255u});
+    }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        gm::Surface surface{16, 8};
+        fill(surface, 1);
+        gm::Texture texture{};
+        check(!surface.streamToTexture(context, texture), "new texture reported as reused");
+        check(texture.getAccess() == SDL_TEXTUREACCESS_STREAMING, "streaming access");
+        check(matches(texture, surface), "initial upload");
+
+        auto sdlTexture = texture.get();
+        fill(surface, 50);
+        check(surface.streamToTexture(context, texture) && texture.get() == sdlTexture, "texture reused");
+        check(matches(texture, surface), "reused upload");
+
+        // Only the dirty rectangles are uploaded.
+        fill(surface, 100);
+        std::vector<Rectangle> dirty{Rectangle{0, 0, 16, 1}, Rectangle{4, 3, 5, 4}};
+        check(surface.updateTexture(texture, dirty) == 0, "dirty update");
+        gm::Surface partial{16, 8};
+        fill(partial, 50);
+        for (auto &rect : dirty)
+            for (int y = rect.y; y < rect.y + rect.h; ++y)
+                for (int x = rect.x; x < rect.x + rect.w; ++x)
+                    partial.pixel(x, y) = surface.pixel(x, y);
+        check(matches(texture, partial), "dirty rectangles");
+
+        // A surface in another format is converted into the locked texture.
+        gm::Surface argb{16, 8, 32, SDL_PIXELFORMAT_ARGB8888};
+        fill(argb, 150);
+        check(argb.updateTexture(texture) == 0, "converted update");
+        check(matches(texture, argb), "converted upload");
+
+        gm::Surface larger{20, 8};
+        fill(larger, 200);
+        check(!larger.streamToTexture(context, texture) && texture.getSize() == Size{20, 8}, "size change");
+        check(matches(texture, larger), "resized upload");
+    }
+};
+
+/**
+ * @brief Text set to empty drops the Texture of the previous text rather than keeping it for drawing.
+ */
+struct EmptyText : RendererFixture {
+    /// A Text with access to its Texture, given one as though earlier text had been rendered.
+    struct RenderedText : Text {
+        RenderedText(gm::Context &context, const std::string &text) {
+            mText = text;
+            mTexture = gm::Texture{context, Size{24, 12}};
+            mTextSize = mTexture.getSize();
+            mTextureValid = true;
+        }
+
+        void setText(const std::string &text) {
+            mText = text;
+            textUpdated();
+        }
+
+        bool textureValid() const { return mTextureValid; }
+        bool hasTexture() const { return static_cast<bool>(mTexture); }
+        Size textSize() const { return mTextSize; }
+    };
+
+    EmptyText() { testName = "EmptyText"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        RenderedText text{context, "Label"};
+        text.setText("");
+        check(!text.textureValid(), "texture valid after update");
+        check(text.createTextureBlended(context) == Text::TextEmpty, "empty status");
+        check(!text.hasTexture(), "previous texture kept");
+        check(text.textSize() == Size::Zero, "previous size kept");
+        check(text.textureValid(), "empty text rendered again");
+    }
+};
+
+/**
+ * @brief Report the speed of bulk conversion against per pixel SDL calls.
+ */
+struct Speed : Test {
+    Speed() { testName = "Speed"; }
+
+    void performTest() override {
+        gm::Surface surface{1024, 512};
+        auto format = surface->format;
+        auto size = static_cast<size_t>(surface->w);
+        std::vector<uint8_t> rgba8(4 * size);
+
+        auto start = steady_clock::now();
+        for (int y = 0; y < surface->h; ++y) {
+            auto row = surface.row(y);
+            for (size_t x = 0; x < size; ++x)
+                SDL_GetRGBA(row[x], format, &rgba8[4 * x], &rgba8[4 * x + 1], &rgba8[4 * x + 2], &rgba8[4 * x + 3]);
+        }
+        auto perPixel = duration_cast<microseconds>(steady_clock::now() - start);
+
+        start = steady_clock::now();
+        for (int y = 0; y < surface->h; ++y)
+            gm::pixelsToRGBA8(format, surface.row(y).data(), size, rgba8.data());
+        auto bulk = duration_cast<microseconds>(steady_clock::now() - start);
+
+        std::cout << std::setw(12) << std::left << testName << "  " << surface->w << 'x' << surface->h
+                  << " SDL_GetRGBA " << perPixel.count() << "us, pixelsToRGBA8 " << bulk.count() << "us\n";
+        check(bulk <= perPixel, "bulk conversion slower than per pixel");
+    }
+};
+
+int main(int argc, char **argv) {
+    return runSdlTests({
+            std::make_shared<Pitch>(),
+            std::make_shared<Convert>(),
+            std::make_shared<Rect>(),
+            std::make_shared<Upload>(),
+            std::make_shared<EmptyText>(),
+            std::make_shared<Speed>()
+    });
+}
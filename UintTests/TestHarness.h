@@ -0,0 +1,67 @@
+//
+// Created by richard on 2021-07-06.
+//
+
+/**
+ * @file TestHarness.h
+ * @brief The test case base and runner shared by the unit test programs.
+ */
+
+#pragma once
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A test case: performTest() records the result of each check().
+ */
+struct Test {
+    size_t testCount{0};
+    size_t passCount{0};
+    std::string testName{};
+
+    virtual ~Test() = default;
+
+    virtual void performTest() {}
+
+    void operator()() {
+        performTest();
+    }
+
+    void check(bool pass, const std::string &what) {
+        if (pass) {
+            ++passCount;
+        } else {
+            std::cerr << std::setw(12) << std::left << testName
+                      << "Test " << std::setw(3) << testCount << " FAILED: " << what << '\n';
+        }
+        ++testCount;
+    }
+};
+
+/**
+ * @brief Run each test and print the counts for each and the totals.
+ * @param testList The tests, run in order.
+ * @return 0 if every check passed, 1 otherwise, for use as the program exit status.
+ */
+inline int runTests(const std::vector<std::shared_ptr<Test>> &testList) {
+    size_t totalTests = 0;
+    size_t totalPasses = 0;
+    for (auto &test : testList) {
+        test->performTest();
+        std::cout << std::setw(12) << std::left << test->testName
+                  << "  Tests: " << std::setw(4) << test->testCount
+                  << " Passed: " << std::setw(4) << test->passCount << '\n';
+        totalPasses += test->passCount;
+        totalTests += test->testCount;
+    }
+
+    std::cout << "Total Tests: " << std::right << std::setw(5) << totalTests
+              << "\nTotal Passed: " << std::setw(4) << totalPasses
+              << "\nTotal Failed: " << std::setw(4) << totalTests - totalPasses << '\n';
+
+    return totalPasses == totalTests ? 0 : 1;
+}
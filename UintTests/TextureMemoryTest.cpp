@@ -0,0 +1,182 @@
+//
+// Created by richard on 2021-07-06.
+//
+
+/**
+ * @file TextureMemoryTest.cpp
+ * @brief Tests of gm::TextureMemory accounting by format and category, and eviction to stay within a budget.
+ * @details Textures are created with the software renderer on the SDL dummy video driver.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Surface.h"
+#include "Texture.h"
+#include "RendererFixture.h"
+
+using namespace rose;
+
+/**
+ * @brief Fixture: a renderer with access to the TextureMemory statistics.
+ */
+struct MemoryFixture : RendererFixture {
+    static size_t categoryBytes(const gm::TextureMemory::Statistics &statistics, gm::TextureCategory category) {
+        return statistics.categoryBytes[static_cast<size_t>(category)];
+    }
+
+    static size_t formatBytes(const gm::TextureMemory::Statistics &statistics, uint32_t format) {
+        auto entry = statistics.formatBytes.find(format);
+        return entry == statistics.formatBytes.end() ? 0 : entry->second;
+    }
+};
+
+/**
+ * @brief Bytes by format and category follow creation, moves, category changes and destruction.
+ */
+struct Account : MemoryFixture {
+    Account() { testName = "Account"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        auto &memory = gm::TextureMemory::getTextureMemory();
+        auto start = memory.statistics();
+
+        check(gm::TextureMemory::textureBytes(SDL_PIXELFORMAT_RGBA8888, 10, 20) == 800, "RGBA8888 bytes");
+        check(gm::TextureMemory::textureBytes(SDL_PIXELFORMAT_RGB565, 10, 20) == 400, "RGB565 bytes");
+        check(gm::TextureMemory::textureBytes(SDL_PIXELFORMAT_IYUV, 10, 20) == 300, "IYUV bytes");
+
+        {
+            gm::Texture target{context, Size{32, 16}};
+            gm::Texture streaming{context, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_STREAMING, 8, 8};
+            gm::Surface surface{4, 4};
+            auto fromSurface = surface.toTexture(context);
+            size_t expected = 32 * 16 * 4 + 8 * 8 * 2 + gm::TextureMemory::textureBytes(fromSurface.getFormat(), 4, 4);
+
+            auto statistics = memory.statistics();
+            check(statistics.textures == start.textures + 3, "texture count " + std::to_string(statistics.textures));
+            check(statistics.bytes == start.bytes + expected, "bytes " + std::to_string(statistics.bytes));
+            check(statistics.peakBytes >= statistics.bytes, "peak bytes");
+            check(formatBytes(statistics, SDL_PIXELFORMAT_RGB565) ==
+                  formatBytes(start, SDL_PIXELFORMAT_RGB565) + 8 * 8 * 2, "RGB565 format bytes");
+            check(categoryBytes(statistics, gm::TextureCategory::Other) ==
+                  categoryBytes(start, gm::TextureCategory::Other) + expected, "uncategorized bytes");
+
+            target.setCategory(gm::TextureCategory::Window);
+            streaming.setCategory(gm::TextureCategory::Map);
+            statistics = memory.statistics();
+            check(categoryBytes(statistics, gm::TextureCategory::Window) ==
+                  categoryBytes(start, gm::TextureCategory::Window) + 32 * 16 * 4, "window bytes");
+            check(categoryBytes(statistics, gm::TextureCategory::Map) ==
+                  categoryBytes(start, gm::TextureCategory::Map) + 8 * 8 * 2, "map bytes");
+            check(statistics.bytes == start.bytes + expected, "bytes changed by category");
+
+            gm::Texture moved{std::move(target)};
+            check(memory.statistics().bytes == start.bytes + expected, "bytes changed by move");
+
+            streaming.reset();
+            check(memory.statistics().bytes == start.bytes + expected - 8 * 8 * 2, "bytes after reset");
+
+            std::ostringstream strm{};
+            strm << memory.statistics();
+            check(strm.str().find("Window 1/2 KiB") != std::string::npos, "summary " + strm.str());
+        }
+
+        auto end = memory.statistics();
+        check(end.textures == start.textures, "textures after destruction " + std::to_string(end.textures));
+        check(end.bytes == start.bytes, "bytes after destruction " + std::to_string(end.bytes));
+        check(end.formatBytes == start.formatBytes, "format bytes after destruction");
+        check(end.categoryBytes == start.categoryBytes, "category bytes after destruction");
+    }
+};
+
+/**
+ * @brief Going over the budget calls eviction handlers in priority order at the next frame, until the total
+ * is back within the budget.
+ */
+struct Budget : MemoryFixture {
+    Budget() { testName = "Budget"; }
+
+    void performTest() override {
+        if (!createContext())
+            return;
+
+        auto &memory = gm::TextureMemory::getTextureMemory();
+        std::vector<gm::Texture> cached{};
+        std::vector<gm::Texture> inactive{};
+        for (int i = 0; i < 4; ++i) {
+            cached.emplace_back(context, Size{16, 16});
+            inactive.emplace_back(context, Size{16, 16});
+        }
+
+        std::string order{};
+        auto dropInactive = memory.addEvictionHandler(0, [&order, &inactive](size_t) {
+            order.push_back('i');
+            inactive.clear();
+        });
+        auto dropCached = memory.addEvictionHandler(10, [&order, &cached](size_t bytes) {
+            order.push_back('c');
+            while (bytes && !cached.empty()) {
+                bytes -= std::min(bytes, static_cast<size_t>(16 * 16 * 4));
+                cached.pop_back();
+            }
+        });
+        auto removed = memory.addEvictionHandler(5, [&order](size_t) { order.push_back('r'); });
+        auto reentrant = memory.addEvictionHandler(1, [&order, &memory](size_t bytes) {
+            order.push_back(memory.evict(bytes) ? 'E' : 'e');
+        });
+        memory.removeEvictionHandler(removed);
+
+        // Within the budget nothing is evicted.
+        memory.setBudget(memory.bytes() + 1024);
+        auto start = memory.statistics();
+        uint32_t frame = 0;
+        CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+        check(order.empty(), "evicted within budget " + order);
+
+        // Creating a Texture which goes over the budget schedules eviction for the next frame.
+        gm::Texture large{context, Size{32, 16}};
+        check(order.empty(), "evicted before the frame " + order);
+        CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+        check(order == "i", "handler order " + order);
+        check(inactive.empty() && cached.size() == 4, "inactive dropped first");
+        check(memory.bytes() <= memory.budget(), "over budget after eviction");
+
+        // When the first handler does not free enough the next is called.
+        order.clear();
+        memory.setBudget(memory.bytes() - 16 * 16 * 4 * 2);
+        CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+        check(order == "iec", "handler order " + order);
+        check(cached.size() == 2, "cached left " + std::to_string(cached.size()));
+        check(memory.bytes() <= memory.budget(), "over budget after second eviction");
+
+        auto statistics = memory.statistics();
+        check(statistics.evictions == start.evictions + 4, "evictions " + std::to_string(statistics.evictions));
+        check(statistics.evictedBytes == start.evictedBytes + 16 * 16 * 4 * 6,
+              "evicted bytes " + std::to_string(statistics.evictedBytes));
+
+        // An explicit eviction, as when Texture creation fails, runs immediately.
+        order.clear();
+        memory.setBudget(0);
+        check(memory.evict(16 * 16 * 4) == 16 * 16 * 4 && order == "iec", "explicit eviction " + order);
+        CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+        check(order == "iec", "evicted without a budget " + order);
+
+        memory.removeEvictionHandler(dropInactive);
+        memory.removeEvictionHandler(dropCached);
+        memory.removeEvictionHandler(reentrant);
+        check(memory.evict(1024) == 0, "handlers not removed");
+    }
+};
+
+int main(int argc, char **argv) {
+    return runSdlTests({
+            std::make_shared<Account>(),
+            std::make_shared<Budget>()
+    });
+}
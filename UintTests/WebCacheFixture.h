@@ -0,0 +1,102 @@
+//
+// Created by richard on 2021-06-28.
+//
+
+/**
+ * @file WebCacheFixture.h
+ * @brief The WebCache fixture shared by the WebCache test programs.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "WebCache.h"
+#include "LoopbackHttpServer.h"
+#include "TestHarness.h"
+
+static constexpr size_t FixtureCount = 50;
+
+/// Build a fixture body of a few kilobytes, distinct for each item.
+inline std::string fixtureBody(size_t n) {
+    std::stringstream strm{};
+    for (size_t line = 0; line < 64; ++line)
+        strm << "Fixture " << std::setw(3) << n << " line " << std::setw(3) << line
+             << " 1 25544U 98067A   21178.50000000  .00001234  00000-0  12345-4 0  9999\n";
+    return strm.str();
+}
+
+inline std::string fixtureName(size_t n) {
+    std::stringstream strm{};
+    strm << "item" << std::setw(2) << std::setfill('0') << n << ".txt";
+    return strm.str();
+}
+
+inline std::string readFile(const std::filesystem::path &filePath) {
+    std::ifstream strm{filePath};
+    std::stringstream buffer{};
+    buffer << strm.rdbuf();
+    return buffer.str();
+}
+
+/**
+ * @brief Fixture: a loopback server serving FixtureCount items and a WebCache in a scratch directory.
+ */
+struct WebCacheFixture : Test {
+    LoopbackHttpServer server{};
+    std::filesystem::path scratch{};
+    std::unique_ptr<rose::WebCache> webCache{};
+
+    WebCacheFixture() {
+        // Each fixture has its own scratch directory so fixtures may be destroyed in any order.
+        static size_t fixtureCount = 0;
+        scratch = std::filesystem::temp_directory_path();
+        scratch.append("RoseWebCacheTest-" + std::to_string(::getpid()) + '-' + std::to_string(fixtureCount++));
+        for (size_t n = 0; n < FixtureCount; ++n)
+            server.setResource('/' + fixtureName(n), fixtureBody(n));
+    }
+
+    ~WebCacheFixture() override {
+        webCache.reset();
+        std::error_code ec{};
+        std::filesystem::remove_all(scratch, ec);
+    }
+
+    void createCache(const std::string &storeRoot,
+                     std::chrono::system_clock::duration duration = std::chrono::hours{1}) {
+        webCache = std::make_unique<rose::WebCache>(server.rootUri(), scratch, storeRoot, duration);
+        for (size_t n = 0; n < FixtureCount; ++n)
+            webCache->setCacheItem(static_cast<rose::WebCache::key_t>(n), fixtureName(n));
+    }
+
+    /// Drive the cache from the frame signal until all fetches complete or the timeout expires.
+    bool runFrames(std::chrono::milliseconds timeout) {
+        auto start = std::chrono::steady_clock::now();
+        uint32_t frame = 0;
+        while (webCache->pendingFutures()) {
+            if (std::chrono::steady_clock::now() - start > timeout)
+                return false;
+            rose::CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        return true;
+    }
+
+    /// Drive the cache from the frame signal for a period.
+    void runFor(std::chrono::milliseconds period) {
+        auto start = std::chrono::steady_clock::now();
+        uint32_t frame = 0;
+        while (std::chrono::steady_clock::now() - start < period) {
+            rose::CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+};
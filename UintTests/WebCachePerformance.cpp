@@ -0,0 +1,236 @@
+//
+// Created by richard on 2021-06-28.
+//
+
+/**
+ * @file WebCachePerformance.cpp
+ * @brief Throughput and latency tests of WebCache fetchAll(), processFutures() and cacheLoaded against a
+ * loopback server with simulated latency and bandwidth.
+ * @details Bounds are set well clear of the measured values so the tests catch regressions, such as fetches
+ * being serialized or the frame callback blocking, rather than machine speed.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+#include <vector>
+#include "TransferEngine.h"
+#include "WebCacheFixture.h"
+
+using namespace std::chrono;
+
+/**
+ * @brief Fixture: record when each cacheLoaded arrives and how long each frame takes.
+ */
+struct TimedFixture : WebCacheFixture {
+    steady_clock::time_point start{};
+    std::map<rose::WebCache::key_t, std::pair<long, steady_clock::duration>> loaded{};
+    std::vector<steady_clock::duration> frameTimes{};
+    rose::WebCacheProtocol::slot_type slot{};
+
+    void connect() {
+        loaded.clear();
+        slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [this](uint32_t key, long status) {
+            loaded[key] = std::make_pair(status, steady_clock::now() - start);
+        };
+        webCache->cacheLoaded.connect(slot);
+    }
+
+    /// Call fetchAll() and drive the frame signal until all fetches complete, timing each frame.
+    bool timedFetchAll(milliseconds timeout) {
+        loaded.clear();
+        frameTimes.clear();
+        start = steady_clock::now();
+        webCache->fetchAll();
+        uint32_t frame = 0;
+        while (webCache->pendingFutures()) {
+            if (steady_clock::now() - start > timeout)
+                return false;
+            auto frameStart = steady_clock::now();
+            rose::CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+            frameTimes.push_back(steady_clock::now() - frameStart);
+            std::this_thread::sleep_for(milliseconds{1});
+        }
+        return true;
+    }
+
+    milliseconds elapsed() const {
+        steady_clock::duration last{};
+        for (auto &item : loaded)
+            last = std::max(last, item.second.second);
+        return duration_cast<milliseconds>(last);
+    }
+
+    /// The time from fetchAll() to cacheLoaded of the given fraction of items.
+    milliseconds percentile(double fraction) const {
+        std::vector<steady_clock::duration> times{};
+        for (auto &item : loaded)
+            times.push_back(item.second.second);
+        if (times.empty())
+            return milliseconds{0};
+        std::sort(times.begin(), times.end());
+        auto index = std::min(times.size() - 1, static_cast<size_t>(fraction * static_cast<double>(times.size())));
+        return duration_cast<milliseconds>(times[index]);
+    }
+
+    microseconds meanFrameTime() const {
+        if (frameTimes.empty())
+            return microseconds{0};
+        auto total = std::accumulate(frameTimes.begin(), frameTimes.end(), steady_clock::duration{});
+        return duration_cast<microseconds>(total / frameTimes.size());
+    }
+
+    microseconds maxFrameTime() const {
+        if (frameTimes.empty())
+            return microseconds{0};
+        return duration_cast<microseconds>(*std::max_element(frameTimes.begin(), frameTimes.end()));
+    }
+
+    void report(const std::string &what) const {
+        std::cout << std::setw(12) << std::left << testName << "  " << what << ": " << loaded.size()
+                  << " items in " << elapsed().count() << "ms, p50 " << percentile(0.5).count()
+                  << "ms, p95 " << percentile(0.95).count() << "ms, frames " << frameTimes.size()
+                  << " mean " << meanFrameTime().count() << "us max " << maxFrameTime().count() << "us\n";
+    }
+};
+
+/**
+ * @brief Fetch with a per request server latency.
+ * @details With four connections per host the items are fetched in about FixtureCount / 4 round trips. A
+ * serialized fetch takes FixtureCount round trips.
+ */
+struct Latency : TimedFixture {
+    static constexpr milliseconds RoundTrip{40};
+    static constexpr size_t MissingCount = 5;
+
+    Latency() {
+        testName = "Latency";
+        server.setLatency(RoundTrip);
+        for (size_t n = FixtureCount - MissingCount; n < FixtureCount; ++n) {
+            LoopbackHttpServer::Resource resource{};
+            resource.status = 404;
+            server.setResource('/' + fixtureName(n), resource);
+        }
+    }
+
+    void performTest() override {
+        createCache("Latency");
+        connect();
+        check(timedFetchAll(seconds{30}), "fetches did not complete");
+        report("fetchAll");
+
+        auto ok = std::count_if(loaded.begin(), loaded.end(), [](auto &l) { return l.second.first == 200; });
+        auto missing = std::count_if(loaded.begin(), loaded.end(), [](auto &l) { return l.second.first == 404; });
+        check(static_cast<size_t>(ok) == FixtureCount - MissingCount, "items fetched " + std::to_string(ok));
+        check(static_cast<size_t>(missing) == MissingCount, "items missing " + std::to_string(missing));
+
+        auto rounds = (FixtureCount + 3) / 4;
+        check(elapsed() >= RoundTrip * rounds * 9 / 10, "latency not applied " + std::to_string(elapsed().count()));
+        check(elapsed() < RoundTrip * FixtureCount / 2, "fetches serialized " + std::to_string(elapsed().count()));
+        check(percentile(0.5) < RoundTrip * FixtureCount / 4, "p50 " + std::to_string(percentile(0.5).count()));
+
+        // processFutures() polls without blocking, so frames stay short while fetches are in flight.
+        check(meanFrameTime() < milliseconds{2}, "mean frame " + std::to_string(meanFrameTime().count()));
+        check(maxFrameTime() < milliseconds{50}, "max frame " + std::to_string(maxFrameTime().count()));
+    }
+};
+
+/**
+ * @brief Fetch large items from a bandwidth limited server.
+ * @details The limit applies per connection, so fetching on four connections delivers several times the
+ * bandwidth of one.
+ */
+struct Throughput : TimedFixture {
+    static constexpr size_t ItemCount = 16;
+    static constexpr size_t ItemSize = 64 * 1024;
+    static constexpr size_t Bandwidth = 256 * 1024;
+
+    Throughput() {
+        testName = "Throughput";
+        server.setBandwidth(Bandwidth);
+        for (size_t n = 0; n < ItemCount; ++n) {
+            std::string body{};
+            while (body.size() < ItemSize)
+                body.append(fixtureBody(n));
+            body.resize(ItemSize);
+            server.setResource("/bulk" + std::to_string(n) + ".bin", std::move(body));
+        }
+    }
+
+    void performTest() override {
+        webCache = std::make_unique<rose::WebCache>(server.rootUri(), scratch, "Throughput", hours{1});
+        for (size_t n = 0; n < ItemCount; ++n)
+            webCache->setCacheItem(static_cast<rose::WebCache::key_t>(n), "bulk" + std::to_string(n) + ".bin");
+        connect();
+
+        auto &engine = rose::TransferEngine::getEngine();
+        engine.resetStatistics();
+        check(timedFetchAll(seconds{60}), "fetches did not complete");
+        report("fetchAll");
+
+        auto statistics = engine.statistics();
+        auto total = ItemCount * ItemSize;
+        auto rate = static_cast<double>(statistics.bytesReceived) /
+                    std::max(duration<double>(elapsed()).count(), 0.001) / 1024.;
+        std::cout << std::setw(12) << std::left << testName << "  " << statistics.bytesReceived << " bytes at "
+                  << static_cast<long>(rate) << " KiB/s, limit " << Bandwidth / 1024 << " KiB/s per connection\n";
+
+        check(loaded.size() == ItemCount &&
+              std::all_of(loaded.begin(), loaded.end(), [](auto &l) { return l.second.first == 200; }),
+              "items fetched " + std::to_string(loaded.size()));
+        check(statistics.bytesReceived == static_cast<curl_off_t>(total),
+              "bytes received " + std::to_string(statistics.bytesReceived));
+        check(rate > 1.5 * static_cast<double>(Bandwidth) / 1024., "throughput " + std::to_string(rate));
+        check(maxFrameTime() < milliseconds{50}, "max frame " + std::to_string(maxFrameTime().count()));
+    }
+};
+
+/**
+ * @brief Revalidate items from a bandwidth limited server.
+ * @details 304 responses carry no body, so revalidating every item costs a fraction of fetching it.
+ */
+struct Revalidate : TimedFixture {
+    Revalidate() {
+        testName = "Revalidate";
+        server.setBandwidth(64 * 1024);
+        for (size_t n = 0; n < FixtureCount; ++n) {
+            LoopbackHttpServer::Resource resource{};
+            resource.body = fixtureBody(n);
+            resource.eTag = "\"v1-" + std::to_string(n) + '"';
+            resource.lastModified = "Mon, 28 Jun 2021 12:00:00 GMT";
+            server.setResource('/' + fixtureName(n), resource);
+        }
+    }
+
+    void performTest() override {
+        // A zero validity period forces every fetch to revalidate.
+        createCache("Revalidate", seconds{0});
+        connect();
+        check(timedFetchAll(seconds{60}), "fetches did not complete");
+        report("fetch");
+        auto fetchTime = elapsed();
+
+        std::this_thread::sleep_for(milliseconds{1100});
+        check(timedFetchAll(seconds{60}), "revalidation did not complete");
+        report("revalidate");
+
+        check(loaded.size() == FixtureCount &&
+              std::all_of(loaded.begin(), loaded.end(), [](auto &l) { return l.second.first == 304; }),
+              "revalidation status");
+        check(server.notModifiedCount() == FixtureCount,
+              "not modified responses " + std::to_string(server.notModifiedCount()));
+        check(elapsed() < fetchTime / 2, "revalidation " + std::to_string(elapsed().count()) + "ms, fetch " +
+                                         std::to_string(fetchTime.count()) + "ms");
+    }
+};
+
+int main(int argc, char **argv) {
+    return runTests({
+            std::make_shared<Latency>(),
+            std::make_shared<Throughput>(),
+            std::make_shared<Revalidate>()
+    });
+}
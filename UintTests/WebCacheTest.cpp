@@ -0,0 +1,580 @@
+//
+// Created by richard on 2021-06-28.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <unistd.h>
+#include <zlib.h>
+#include "TransferEngine.h"
+#include "WebCacheFixture.h"
+
+struct FetchAll : WebCacheFixture {
+    FetchAll() {
+        testName = "FetchAll";
+    }
+
+    void performTest() override {
+        check(static_cast<bool>(server), "loopback server did not start");
+        createCache("FetchAll");
+
+        std::map<rose::WebCache::key_t, long> loaded{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&loaded](uint32_t key, long status) {
+            loaded[key] = status;
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        auto start = std::chrono::steady_clock::now();
+        webCache->fetchAll();
+        auto complete = runFrames(std::chrono::seconds{30});
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+        std::cout << std::setw(12) << std::left << testName << "  " << FixtureCount << " items in "
+                  << elapsed.count() << "ms over " << server.connectionCount() << " connections, "
+                  << server.requestCount() << " requests\n";
+
+        check(complete, "fetches did not complete");
+        check(loaded.size() == FixtureCount, "cacheLoaded count " + std::to_string(loaded.size()));
+
+        size_t ok = 0;
+        for (size_t n = 0; n < FixtureCount; ++n) {
+            auto key = static_cast<rose::WebCache::key_t>(n);
+            if (loaded[key] == 200)
+                if (auto itemPath = webCache->localItemExists(key); itemPath && readFile(*itemPath) == fixtureBody(n))
+                    ++ok;
+        }
+        check(ok == FixtureCount, "items verified " + std::to_string(ok));
+        check(server.connectionCount() <= 4, "connections " + std::to_string(server.connectionCount()));
+    }
+};
+
+/**
+ * @brief A fixture resource carrying validators.
+ * @param n The fixture index.
+ * @param changed True to serve new content with a new ETag.
+ */
+static LoopbackHttpServer::Resource validatedResource(size_t n, bool changed = false) {
+    LoopbackHttpServer::Resource resource{};
+    resource.body = fixtureBody(n);
+    if (changed)
+        resource.body.append("Changed\n");
+    resource.eTag = (changed ? "\"v2-" : "\"v1-") + std::to_string(n) + '"';
+    resource.lastModified = "Mon, 28 Jun 2021 12:00:00 GMT";
+    return resource;
+}
+
+/// Serve every fixture with validators so conditional requests are answered with 304.
+static void serveValidated(LoopbackHttpServer &server) {
+    for (size_t n = 0; n < FixtureCount; ++n)
+        server.setResource('/' + fixtureName(n), validatedResource(n));
+}
+
+struct Validators : WebCacheFixture {
+    Validators() {
+        testName = "Validators";
+        serveValidated(server);
+    }
+
+    void performTest() override {
+        // A zero validity period forces every fetch to revalidate.
+        createCache("Validators", std::chrono::seconds{0});
+
+        std::map<rose::WebCache::key_t, long> loaded{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&loaded](uint32_t key, long status) {
+            loaded[key] = status;
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "initial fetches did not complete");
+        check(std::all_of(loaded.begin(), loaded.end(), [](auto &l) { return l.second == 200; }),
+              "initial fetch status");
+
+        auto itemPath = *webCache->localItemExists(0);
+        auto writeTime = std::filesystem::last_write_time(itemPath);
+        auto metaPath = itemPath.parent_path();
+        metaPath.append('.' + itemPath.filename().string() + ".meta");
+        rose::WebCacheMetadata before{};
+        check(before.read(metaPath) && before.eTag == "\"v1-0\"", "sidecar validators");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{1100});
+        loaded.clear();
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "revalidation did not complete");
+        check(loaded.size() == FixtureCount &&
+              std::all_of(loaded.begin(), loaded.end(), [](auto &l) { return l.second == 304; }),
+              "revalidation status");
+        check(server.conditionalCount() == FixtureCount,
+              "conditional requests " + std::to_string(server.conditionalCount()));
+        check(std::filesystem::last_write_time(itemPath) == writeTime, "item rewritten on 304");
+        check(readFile(itemPath) == fixtureBody(0), "item content after 304");
+
+        rose::WebCacheMetadata after{};
+        check(after.read(metaPath) && after.fetchTime > before.fetchTime, "fetch time not bumped on 304");
+    }
+};
+
+struct Schedule : WebCacheFixture {
+    Schedule() {
+        testName = "Schedule";
+        serveValidated(server);
+    }
+
+    void performTest() override {
+        createCache("Schedule", std::chrono::seconds{2});
+
+        std::map<rose::WebCache::key_t, long> loaded{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&loaded](uint32_t key, long status) {
+            loaded[key] = status;
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        // Without a jitter budget every missing item is due immediately.
+        webCache->setRefreshSchedule(nullptr, std::chrono::seconds{0});
+        webCache->refreshDue();
+        rose::CommonSignals::getCommonSignals().frameSignal.transmit(0);
+        check(runFrames(std::chrono::seconds{30}), "initial refresh did not complete");
+        check(loaded.size() == FixtureCount, "initial refresh count " + std::to_string(loaded.size()));
+
+        // Nothing is due before the items expire.
+        loaded.clear();
+        webCache->refreshDue();
+        rose::CommonSignals::getCommonSignals().frameSignal.transmit(1);
+        check(loaded.empty() && !webCache->pendingFutures(), "refresh before expiry");
+
+        // Keep one item fresh, the rest expire and are revalidated.
+        std::this_thread::sleep_for(std::chrono::milliseconds{2100});
+        auto metaPath = webCache->itemMetadataPath(fixtureName(0));
+        rose::WebCacheMetadata metadata{};
+        metadata.read(metaPath);
+        metadata.fetchTime = std::chrono::system_clock::now();
+        metadata.write(metaPath);
+        webCache->setRefreshSchedule(nullptr, std::chrono::seconds{0});
+
+        webCache->refreshDue();
+        rose::CommonSignals::getCommonSignals().frameSignal.transmit(2);
+        check(runFrames(std::chrono::seconds{30}), "expired refresh did not complete");
+        check(loaded.size() == FixtureCount - 1 && loaded.find(0) == loaded.end(),
+              "expired refresh count " + std::to_string(loaded.size()));
+        check(server.conditionalCount() == FixtureCount - 1,
+              "conditional requests " + std::to_string(server.conditionalCount()));
+
+        // Jitter spreads expiry times within the budget.
+        webCache->setRefreshSchedule(nullptr, std::chrono::seconds{600});
+        std::set<std::chrono::system_clock::time_point> expiry{};
+        auto base = *webCache->itemExpiry(1);
+        bool inBudget = true;
+        for (size_t n = 1; n < FixtureCount; ++n) {
+            auto itemExpiry = *webCache->itemExpiry(static_cast<rose::WebCache::key_t>(n));
+            expiry.insert(itemExpiry);
+            inBudget &= itemExpiry - base <= std::chrono::seconds{600} + std::chrono::seconds{2} &&
+                        base - itemExpiry <= std::chrono::seconds{600} + std::chrono::seconds{2};
+        }
+        check(expiry.size() > FixtureCount / 2, "jitter spread " + std::to_string(expiry.size()));
+        check(inBudget, "jitter exceeds budget");
+    }
+};
+
+struct ServeStale : WebCacheFixture {
+    ServeStale() {
+        testName = "ServeStale";
+        serveValidated(server);
+    }
+
+    void performTest() override {
+        // Populate the store, then start again as if after a restart with one item changed on the server.
+        createCache("ServeStale", std::chrono::seconds{0});
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "initial fetches did not complete");
+        server.setResource('/' + fixtureName(3), validatedResource(3, true));
+
+        createCache("ServeStale", std::chrono::seconds{0});
+        webCache->setServeStale(true);
+
+        std::map<rose::WebCache::key_t, std::vector<long>> loaded{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&loaded](uint32_t key, long status) {
+            loaded[key].push_back(status);
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        webCache->fetchAll();
+        check(loaded.size() == FixtureCount &&
+              std::all_of(loaded.begin(), loaded.end(), [](auto &l) {
+                  return l.second.size() == 1 && l.second.front() == rose::WebCache::CacheStale;
+              }), "local copies not announced before revalidation");
+
+        loaded.clear();
+        check(runFrames(std::chrono::seconds{30}), "revalidation did not complete");
+        check(server.conditionalCount() == FixtureCount,
+              "conditional requests " + std::to_string(server.conditionalCount()));
+        check(loaded.size() == 1 && loaded[3] == std::vector<long>{200}, "only the changed item signaled");
+        check(readFile(*webCache->localItemExists(3)) == fixtureBody(3) + "Changed\n", "changed item content");
+    }
+};
+
+struct Unchanged : WebCacheFixture {
+    Unchanged() {
+        testName = "Unchanged";
+    }
+
+    void performTest() override {
+        std::string_view checkValue{"123456789"};
+        check(rose::WebCacheMetadata::crc32(0, checkValue.data(), checkValue.size()) == 0xCBF43926u, "crc32");
+
+        // Resources without validators are always served in full.
+        createCache("Unchanged", std::chrono::seconds{0});
+
+        std::map<rose::WebCache::key_t, long> loaded{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&loaded](uint32_t key, long status) {
+            loaded[key] = status;
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "initial fetches did not complete");
+        auto itemPath = *webCache->localItemExists(0);
+        auto writeTime = std::filesystem::last_write_time(itemPath);
+
+        server.setResource('/' + fixtureName(5), fixtureBody(5) + "Changed\n");
+        loaded.clear();
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "second fetches did not complete");
+        check(loaded.size() == FixtureCount, "second fetch count " + std::to_string(loaded.size()));
+        check(loaded[5] == 200, "changed item status " + std::to_string(loaded[5]));
+        check(std::count_if(loaded.begin(), loaded.end(), [](auto &l) {
+            return l.second == rose::WebCache::CacheUnchanged;
+        }) == FixtureCount - 1, "unchanged item status");
+        check(std::filesystem::last_write_time(itemPath) == writeTime, "unchanged item rewritten");
+        check(readFile(*webCache->localItemExists(5)) == fixtureBody(5) + "Changed\n", "changed item content");
+    }
+};
+
+struct Payload : WebCacheFixture {
+    Payload() {
+        testName = "Payload";
+    }
+
+    void performTest() override {
+        std::map<rose::WebCache::key_t, std::pair<long, rose::WebCachePayload>> delivered{};
+        auto slot = rose::WebCachePayloadProtocol::createSlot();
+        slot->receiver = [&delivered](uint32_t key, long status, const rose::WebCachePayload &payload) {
+            delivered[key] = std::make_pair(status, payload);
+        };
+
+        auto verify = [&delivered](long status) {
+            size_t ok = 0;
+            for (size_t n = 0; n < FixtureCount; ++n) {
+                auto &[itemStatus, payload] = delivered[static_cast<rose::WebCache::key_t>(n)];
+                if (itemStatus == status && payload && *payload == fixtureBody(n))
+                    ++ok;
+            }
+            return ok == FixtureCount;
+        };
+
+        createCache("Payload", std::chrono::seconds{0});
+        webCache->setPayloadDelivery(true);
+        webCache->payloadLoaded.connect(slot);
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "fetches did not complete");
+        check(verify(200), "new copy payloads");
+
+        // After a restart local copies are delivered with CacheStale.
+        delivered.clear();
+        createCache("Payload", std::chrono::seconds{0});
+        webCache->setPayloadDelivery(true);
+        webCache->setServeStale(true);
+        webCache->payloadLoaded.connect(slot);
+        webCache->fetchAll();
+        check(verify(rose::WebCache::CacheStale), "stale payloads");
+        check(runFrames(std::chrono::seconds{30}), "revalidation did not complete");
+    }
+};
+
+/// Compress data with gzip framing.
+static std::string gzipCompress(const std::string &data) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string compressed(deflateBound(&zs, data.size()), '\0');
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef *>(compressed.data());
+    zs.avail_out = static_cast<uInt>(compressed.size());
+    deflate(&zs, Z_FINISH);
+    compressed.resize(zs.total_out);
+    deflateEnd(&zs);
+    return compressed;
+}
+
+struct Compression : WebCacheFixture {
+    std::atomic_size_t compressedResponses{0};
+
+    Compression() {
+        testName = "Compression";
+        server.setHandler([this](const LoopbackHttpServer::Request &request) {
+            LoopbackHttpServer::Response response{};
+            auto body = fixtureBody(std::stoul(request.path.substr(5, 2)));
+            if (auto accept = request.headers.find("accept-encoding");
+                    accept != request.headers.end() && accept->second.find("gzip") != std::string::npos) {
+                ++compressedResponses;
+                response.headers.emplace_back("Content-Encoding: gzip");
+                response.body = gzipCompress(body);
+            } else {
+                response.body = body;
+            }
+            return response;
+        });
+    }
+
+    /// Fetch all items into a new store, returning the engine totals and the elapsed time.
+    std::pair<rose::TransferEngine::Statistics, std::chrono::microseconds> fetchAllInto(const std::string &store) {
+        createCache(store);
+        rose::TransferEngine::getEngine().resetStatistics();
+        auto start = std::chrono::steady_clock::now();
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), store + " fetches did not complete");
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        auto statistics = rose::TransferEngine::getEngine().statistics();
+
+        size_t ok = 0;
+        for (size_t n = 0; n < FixtureCount; ++n)
+            if (auto itemPath = webCache->localItemExists(static_cast<rose::WebCache::key_t>(n));
+                    itemPath && readFile(*itemPath) == fixtureBody(n))
+                ++ok;
+        check(ok == FixtureCount, store + " items verified " + std::to_string(ok));
+
+        std::cout << std::setw(12) << std::left << testName << "  " << std::setw(10) << store
+                  << std::right << std::setw(8) << statistics.bytesReceived << " bytes received "
+                  << std::setw(8) << statistics.bytesDelivered << " bytes delivered in "
+                  << elapsed.count() << "us\n";
+        return std::make_pair(statistics, elapsed);
+    }
+
+    void performTest() override {
+        auto &engine = rose::TransferEngine::getEngine();
+        engine.setAcceptEncoding(false);
+        auto[identity, identityTime] = fetchAllInto("Identity");
+        check(compressedResponses == 0, "compressed without negotiation");
+
+        engine.setAcceptEncoding(true);
+        auto[gzip, gzipTime] = fetchAllInto("Gzip");
+        check(compressedResponses == FixtureCount, "compressed responses " + std::to_string(compressedResponses));
+
+        check(gzip.bytesDelivered == identity.bytesDelivered, "decoded size differs");
+        check(gzip.bytesReceived * 2 < identity.bytesReceived, "compression did not reduce transfer size");
+    }
+};
+
+/// Serve fixtures after failing the first failCount requests for each path with 503.
+static LoopbackHttpServer::Handler failingHandler(size_t failCount) {
+    auto attempts = std::make_shared<std::map<std::string, size_t>>();
+    auto mutex = std::make_shared<std::mutex>();
+    return [failCount, attempts, mutex](const LoopbackHttpServer::Request &request) {
+        LoopbackHttpServer::Response response{};
+        {
+            std::lock_guard<std::mutex> lockGuard{*mutex};
+            if ((*attempts)[request.path]++ < failCount) {
+                response.status = 503;
+                response.reason = "Service Unavailable";
+                return response;
+            }
+        }
+        response.body = fixtureBody(std::stoul(request.path.substr(5, 2)));
+        return response;
+    };
+}
+
+struct Retry : WebCacheFixture {
+    Retry() {
+        testName = "Retry";
+        server.setHandler(failingHandler(2));
+    }
+
+    void performTest() override {
+        createCache("Retry");
+        webCache->setRetryPolicy(std::chrono::milliseconds{20}, std::chrono::milliseconds{200}, 5);
+        webCache->setHostFailureBudget(1000, std::chrono::seconds{1});
+
+        std::map<rose::WebCache::key_t, std::vector<long>> loaded{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&loaded](uint32_t key, long status) {
+            loaded[key].push_back(status);
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        webCache->fetchAll();
+        auto start = std::chrono::steady_clock::now();
+        while ((webCache->pendingFutures() || webCache->pendingRetries()) &&
+               std::chrono::steady_clock::now() - start < std::chrono::seconds{30})
+            runFor(std::chrono::milliseconds{10});
+
+        std::vector<long> expected{rose::WebCache::CacheRetryScheduled, rose::WebCache::CacheRetryScheduled, 200};
+        check(loaded.size() == FixtureCount &&
+              std::all_of(loaded.begin(), loaded.end(), [&expected](auto &l) { return l.second == expected; }),
+              "retry statuses");
+        check(server.requestCount() == FixtureCount * 3, "requests " + std::to_string(server.requestCount()));
+
+        size_t ok = 0;
+        for (size_t n = 0; n < FixtureCount; ++n)
+            if (auto itemPath = webCache->localItemExists(static_cast<rose::WebCache::key_t>(n));
+                    itemPath && readFile(*itemPath) == fixtureBody(n))
+                ++ok;
+        check(ok == FixtureCount, "items verified " + std::to_string(ok));
+    }
+};
+
+struct HostBudget : WebCacheFixture {
+    HostBudget() {
+        testName = "HostBudget";
+        server.setHandler(failingHandler(std::numeric_limits<size_t>::max()));
+    }
+
+    void performTest() override {
+        createCache("HostBudget");
+        webCache->setRetryPolicy(std::chrono::milliseconds{10}, std::chrono::milliseconds{20}, 100);
+        webCache->setHostFailureBudget(3, std::chrono::milliseconds{1500});
+
+        std::map<long, size_t> statusCount{};
+        auto slot = rose::WebCacheProtocol::createSlot();
+        slot->receiver = [&statusCount](uint32_t key, long status) {
+            ++statusCount[status];
+        };
+        webCache->cacheLoaded.connect(slot);
+
+        // The initial fetches are all in flight before the budget is exhausted, then the host is paused.
+        webCache->fetchAll();
+        runFor(std::chrono::milliseconds{800});
+        check(server.requestCount() == FixtureCount, "requests while paused " +
+                                                     std::to_string(server.requestCount()));
+        check(statusCount[rose::WebCache::CacheRetryScheduled] == 2, "retry scheduled count");
+        check(statusCount[rose::WebCache::CacheHostPaused] == FixtureCount - 2, "host paused count");
+
+        // Fetches requested while the host is paused are held, not sent.
+        webCache->setCacheItem(static_cast<rose::WebCache::key_t>(FixtureCount), fixtureName(FixtureCount));
+        webCache->fetchAll();
+        webCache->fetchItem(static_cast<rose::WebCache::key_t>(FixtureCount));
+        runFor(std::chrono::milliseconds{100});
+        check(server.requestCount() == FixtureCount, "requests from fetchAll() while paused " +
+                                                     std::to_string(server.requestCount()));
+        check(statusCount[rose::WebCache::CacheHostPaused] == FixtureCount - 1, "held item not signaled");
+
+        // Fetches resume when the pause expires.
+        runFor(std::chrono::milliseconds{1200});
+        check(server.requestCount() > FixtureCount, "fetches did not resume");
+        check(webCache->pendingRetries(), "retries abandoned");
+    }
+};
+
+struct StoreBudget : WebCacheFixture {
+    StoreBudget() {
+        testName = "StoreBudget";
+    }
+
+    size_t storedItems() {
+        size_t count = 0;
+        for (size_t n = 0; n < FixtureCount; ++n) {
+            auto itemPath = scratch;
+            itemPath.append("StoreBudget").append(fixtureName(n));
+            if (std::filesystem::exists(itemPath))
+                ++count;
+        }
+        return count;
+    }
+
+    bool itemStored(size_t n) {
+        auto itemPath = scratch;
+        itemPath.append("StoreBudget").append(fixtureName(n));
+        return std::filesystem::exists(itemPath);
+    }
+
+    void performTest() override {
+        createCache("StoreBudget");
+        webCache->fetchAll();
+        check(runFrames(std::chrono::seconds{30}), "fetches did not complete");
+        check(webCache->storeUsage().second == FixtureCount, "index items");
+
+        // Items accessed most recently survive.
+        for (size_t n = 0; n < 10; ++n)
+            webCache->localItemExists(static_cast<rose::WebCache::key_t>(n));
+        webCache->setStoreBudget(0, 20);
+        bool recent = true;
+        for (size_t n = 0; n < 10; ++n)
+            recent &= itemStored(n);
+        check(storedItems() == 20 && webCache->storeUsage().second == 20, "item budget");
+        check(recent, "recently accessed item evicted");
+
+        // After a restart the index is loaded, items no longer managed are evicted first.
+        webCache.reset();
+        webCache = std::make_unique<rose::WebCache>(server.rootUri(), scratch, "StoreBudget", std::chrono::hours{1});
+        for (size_t n = 0; n < 5; ++n)
+            webCache->setCacheItem(static_cast<rose::WebCache::key_t>(n), fixtureName(n));
+        check(webCache->storeUsage().second == 20, "index not persisted");
+        webCache->setStoreBudget(0, 8);
+        bool managed = true;
+        for (size_t n = 0; n < 5; ++n)
+            managed &= itemStored(n);
+        check(storedItems() == 8, "orphan eviction count " + std::to_string(storedItems()));
+        check(managed, "managed item evicted before orphans");
+
+        // Byte budget.
+        webCache->setStoreBudget(fixtureBody(0).size() * 3 + 10, 0);
+        check(storedItems() == 3, "byte budget " + std::to_string(storedItems()));
+
+        // Without an index the store is walked once and stray temp files are removed.
+        webCache.reset();
+        auto storeRoot = scratch;
+        storeRoot.append("StoreBudget");
+        std::filesystem::remove(storeRoot / ".index");
+        std::ofstream{storeRoot / ".item01.txt"} << "partial";
+        createCache("StoreBudget");
+        check(!std::filesystem::exists(storeRoot / ".item01.txt"), "stray temp file not removed");
+        check(webCache->storeUsage().second == 3, "rebuilt index items");
+    }
+};
+
+struct FetchMissing : WebCacheFixture {
+    FetchMissing() {
+        testName = "FetchMissing";
+    }
+
+    void performTest() override {
+        createCache("FetchMissing");
+        auto itemPath = scratch;
+        itemPath.append("FetchMissing").append("missing.txt");
+        auto tempPath = scratch;
+        tempPath.append("FetchMissing").append(".missing.txt");
+
+        auto[status, key] = rose::WebCache::fetch(7, server.rootUri() + "missing.txt", itemPath, tempPath,
+                                                  std::nullopt);
+        check(status == 404, "status " + std::to_string(status));
+        check(key == 7, "key " + std::to_string(key));
+        check(!std::filesystem::exists(itemPath), "item created for missing resource");
+    }
+};
+
+int main(int argc, char **argv) {
+    return runTests({
+            std::make_shared<FetchAll>(),
+            std::make_shared<Validators>(),
+            std::make_shared<Schedule>(),
+            std::make_shared<ServeStale>(),
+            std::make_shared<Unchanged>(),
+            std::make_shared<Payload>(),
+            std::make_shared<Compression>(),
+            std::make_shared<Retry>(),
+            std::make_shared<HostBudget>(),
+            std::make_shared<StoreBudget>(),
+            std::make_shared<FetchMissing>()
+    });
+}
@@ -0,0 +1,244 @@
+//
+// Created by richard on 2021-07-04.
+//
+
+/**
+ * @file WorkerPoolTest.cpp
+ * @brief Tests of WorkerPool priorities, cancellation, main thread continuations and parallelFor().
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include "WorkerPool.h"
+#include "TestHarness.h"
+
+using namespace rose;
+using namespace std::chrono;
+
+/**
+ * @brief A task which holds a single thread pool busy until it is released.
+ */
+struct Gate {
+    std::promise<void> release{};
+    std::shared_future<void> released{release.get_future().share()};
+
+    std::future<void> block(WorkerPool &pool) {
+        auto future = pool.submit([released = released]() { released.wait(); }, TaskPriority::High);
+        while (pool.queued())
+            std::this_thread::sleep_for(milliseconds{1});
+        return future;
+    }
+};
+
+/**
+ * @brief Results, exceptions and priority order of queued tasks.
+ */
+struct Priority : Test {
+    Priority() { testName = "Priority"; }
+
+    void performTest() override {
+        WorkerPool pool{1, false};
+        check(pool.threadCount() == 1, "thread count " + std::to_string(pool.threadCount()));
+        check(WorkerPool::defaultThreadCount() >= 1, "default thread count");
+
+        check(pool.submit([]() { return 42; }).get() == 42, "result");
+
+        auto thrown = pool.submit([]() -> int { throw std::runtime_error("thrown"); });
+        bool caught = false;
+        try {
+            thrown.get();
+        } catch (const std::runtime_error &e) {
+            caught = std::string{e.what()} == "thrown";
+        }
+        check(caught, "exception delivered through the future");
+
+        Gate gate{};
+        auto blocked = gate.block(pool);
+
+        std::mutex mutex{};
+        std::string order{};
+        auto record = [&mutex, &order](char c) {
+            return [&mutex, &order, c]() {
+                std::lock_guard<std::mutex> lockGuard{mutex};
+                order.push_back(c);
+            };
+        };
+
+        std::vector<std::future<void>> futures{};
+        futures.push_back(pool.submit(record('a'), TaskPriority::Low));
+        futures.push_back(pool.submit(record('b'), TaskPriority::Normal));
+        futures.push_back(pool.submit(record('c'), TaskPriority::High));
+        futures.push_back(pool.submit(record('d'), TaskPriority::Normal));
+        futures.push_back(pool.submit(record('e'), TaskPriority::High));
+        check(pool.queued() == 5, "queued " + std::to_string(pool.queued()));
+
+        gate.release.set_value();
+        blocked.get();
+        for (auto &future : futures)
+            future.get();
+        check(order == "cebda", "order " + order);
+        check(pool.statistics().maxQueued >= 5, "max queued " + std::to_string(pool.statistics().maxQueued));
+    }
+};
+
+/**
+ * @brief Tasks cancelled while queued are not run, running tasks see the token.
+ */
+struct Cancel : Test {
+    Cancel() { testName = "Cancel"; }
+
+    void performTest() override {
+        WorkerPool pool{1, false};
+        Gate gate{};
+        auto blocked = gate.block(pool);
+
+        CancellationToken token{};
+        std::atomic_bool ran{false};
+        auto cancelled = pool.submit([&ran]() { ran = true; return 1; }, TaskPriority::Normal, token);
+        auto kept = pool.submit([]() { return 2; });
+        token.cancel();
+
+        gate.release.set_value();
+        blocked.get();
+
+        bool threw = false;
+        try {
+            cancelled.get();
+        } catch (const TaskCancelled &) {
+            threw = true;
+        }
+        check(threw, "cancelled future holds TaskCancelled");
+        check(!ran, "cancelled task ran");
+        check(kept.get() == 2, "other task lost");
+        check(pool.statistics().tasksCancelled == 1,
+              "cancelled count " + std::to_string(pool.statistics().tasksCancelled));
+
+        // A running task polls the token to stop early.
+        CancellationToken running{};
+        std::atomic_bool started{false};
+        auto polling = pool.submit([&started, running]() {
+            started = true;
+            while (!running.cancelled())
+                std::this_thread::sleep_for(milliseconds{1});
+            return true;
+        }, TaskPriority::Normal, running);
+        while (!started)
+            std::this_thread::sleep_for(milliseconds{1});
+        running.cancel();
+        check(polling.wait_for(seconds{5}) == std::future_status::ready && polling.get(), "running task stopped");
+    }
+};
+
+/**
+ * @brief Continuations run on the thread which processes them, driven by the frame signal.
+ */
+struct Continuation : Test {
+    Continuation() { testName = "Continuation"; }
+
+    void performTest() override {
+        WorkerPool pool{2, true};
+        auto mainThread = std::this_thread::get_id();
+
+        std::thread::id workThread{}, continuationThread{};
+        int result = 0;
+        pool.submitWithContinuation([&workThread]() { workThread = std::this_thread::get_id(); return 7; },
+                                    [&continuationThread, &result](int value) {
+                                        continuationThread = std::this_thread::get_id();
+                                        result = value;
+                                    });
+
+        bool voidRun = false;
+        pool.submitWithContinuation([]() {}, [&voidRun]() { voidRun = true; });
+
+        CancellationToken token{};
+        bool cancelledRun = false;
+        std::atomic_bool workDone{false};
+        pool.submitWithContinuation([&workDone]() { workDone = true; },
+                                    [&cancelledRun]() { cancelledRun = true; }, TaskPriority::Normal, token);
+
+        // Nothing runs on the main thread until a frame.
+        auto start = steady_clock::now();
+        while (!workDone && steady_clock::now() - start < seconds{5})
+            std::this_thread::sleep_for(milliseconds{1});
+        check(result == 0 && !voidRun, "continuation ran before a frame");
+
+        token.cancel();
+        uint32_t frame = 0;
+        while ((!result || !voidRun) && steady_clock::now() - start < seconds{5}) {
+            CommonSignals::getCommonSignals().frameSignal.transmit(frame++);
+            std::this_thread::sleep_for(milliseconds{1});
+        }
+
+        check(result == 7, "result " + std::to_string(result));
+        check(voidRun, "void continuation");
+        check(!cancelledRun, "cancelled continuation ran");
+        check(workThread != mainThread, "work ran on the main thread");
+        check(continuationThread == mainThread, "continuation ran off the main thread");
+        check(pool.statistics().continuationsRun == 3,
+              "continuations " + std::to_string(pool.statistics().continuationsRun));
+    }
+};
+
+/**
+ * @brief parallelFor() covers the range once, stops on failure and does not deadlock when nested.
+ */
+struct Parallel : Test {
+    Parallel() { testName = "Parallel"; }
+
+    void performTest() override {
+        WorkerPool pool{3, false};
+        std::vector<std::atomic_int> visits(1000);
+        bool result = pool.parallelFor(static_cast<int>(visits.size()), [&visits](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                ++visits[i];
+            return true;
+        });
+        check(result, "result");
+        check(std::all_of(visits.begin(), visits.end(), [](auto &v) { return v == 1; }), "each index once");
+
+        check(pool.parallelFor(0, [](int, int) { return false; }), "empty range");
+
+        std::atomic_int calls{0};
+        result = pool.parallelFor(1000, [&calls](int begin, int) {
+            ++calls;
+            return begin != 0;
+        });
+        check(!result, "failure reported");
+
+        // Every worker runs a task which itself calls parallelFor().
+        std::vector<std::future<int>> futures{};
+        for (int n = 0; n < 6; ++n) {
+            futures.push_back(pool.submit([&pool]() {
+                std::atomic_int sum{0};
+                pool.parallelFor(100, [&sum](int begin, int end) {
+                    for (int i = begin; i < end; ++i)
+                        sum += i;
+                    return true;
+                });
+                return sum.load();
+            }));
+        }
+        bool ready = true;
+        int total = 0;
+        for (auto &future : futures) {
+            ready &= future.wait_for(seconds{10}) == std::future_status::ready;
+            if (ready)
+                total += future.get();
+        }
+        check(ready, "nested parallelFor deadlocked");
+        check(total == 6 * 4950, "nested total " + std::to_string(total));
+    }
+};
+
+int main(int argc, char **argv) {
+    return runTests({
+            std::make_shared<Priority>(),
+            std::make_shared<Cancel>(),
+            std::make_shared<Continuation>(),
+            std::make_shared<Parallel>()
+    });
+}
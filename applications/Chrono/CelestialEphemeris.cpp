@@ -0,0 +1,96 @@
+/**
+ * @file CelestialEphemeris.cpp
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-06-14
+ */
+
+#include "CelestialEphemeris.h"
+
+namespace rose {
+
+    /// Interpolate between two angles in radians taking the shortest way around the circle.
+    static double interpolateAngle(double a0, double a1, double f) {
+        auto delta = std::remainder(a1 - a0, 2. * M_PI);
+        return std::remainder(a0 + delta * f, 2. * M_PI);
+    }
+
+    CelestialPosition CelestialEphemeris::compute(std::chrono::system_clock::time_point epoch) {
+        CelestialPosition celestialPosition{};
+        celestialPosition.epoch = epoch;
+
+        auto[latS, lonS] = MapProjection::subSolar(epoch);
+        celestialPosition.subSolar = GeoPosition{latS, lonS, true};
+        celestialPosition.moonPhase = MoonPhase(epoch);
+
+        if (!mMoon.empty()) {
+            // DateTime has no conversion from time_point so offset the current time.
+            auto offset = std::chrono::duration_cast<std::chrono::seconds>(
+                    epoch - std::chrono::system_clock::now()).count();
+            DateTime dateTime{true};
+            mMoon.predict(dateTime + static_cast<long>(offset));
+            auto[lat, lon] = mMoon.front().geo();
+            celestialPosition.subLunar = GeoPosition{lat, lon, true};
+            celestialPosition.lunarValid = true;
+        }
+
+        return celestialPosition;
+    }
+
+    bool CelestialEphemeris::setObserver(const Observer &observer) {
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            mMoon = SatelliteObservation{observer, "Moon"};
+            mValid = false;
+        }
+        update(std::chrono::system_clock::now());
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return !mMoon.empty();
+    }
+
+    void CelestialEphemeris::update(std::chrono::system_clock::time_point epoch) {
+        using namespace std::chrono;
+        auto start = system_clock::time_point{duration_cast<seconds>(epoch.time_since_epoch()) /
+                                              Interval.count() * Interval.count()};
+
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        if (mValid && mTable[0].epoch == start)
+            return;
+
+        if (mValid && mTable[1].epoch == start)
+            mTable[0] = mTable[1];
+        else
+            mTable[0] = compute(start);
+        mTable[1] = compute(start + Interval);
+        mValid = true;
+    }
+
+    CelestialPosition CelestialEphemeris::position(std::chrono::system_clock::time_point epoch) const {
+        using namespace std::chrono;
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        if (!mValid)
+            return CelestialPosition{};
+
+        if (epoch <= mTable[0].epoch)
+            return mTable[0];
+        if (epoch >= mTable[1].epoch)
+            return mTable[1];
+
+        auto f = duration<double>(epoch - mTable[0].epoch).count() /
+                 duration<double>(mTable[1].epoch - mTable[0].epoch).count();
+
+        CelestialPosition celestialPosition{};
+        celestialPosition.epoch = epoch;
+        celestialPosition.subSolar = GeoPosition{
+                mTable[0].subSolar.lat + (mTable[1].subSolar.lat - mTable[0].subSolar.lat) * f,
+                interpolateAngle(mTable[0].subSolar.lon, mTable[1].subSolar.lon, f), true};
+        celestialPosition.lunarValid = mTable[0].lunarValid && mTable[1].lunarValid;
+        if (celestialPosition.lunarValid)
+            celestialPosition.subLunar = GeoPosition{
+                    mTable[0].subLunar.lat + (mTable[1].subLunar.lat - mTable[0].subLunar.lat) * f,
+                    interpolateAngle(mTable[0].subLunar.lon, mTable[1].subLunar.lon, f), true};
+        auto phase = interpolateAngle(mTable[0].moonPhase, mTable[1].moonPhase, f);
+        celestialPosition.moonPhase = phase < 0. ? phase + 2. * M_PI : phase;
+        return celestialPosition;
+    }
+}
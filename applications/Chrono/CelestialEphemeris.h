@@ -0,0 +1,99 @@
+/**
+ * @file CelestialEphemeris.h
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-06-14
+ * @brief A time indexed cache of Sun and Moon positions.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include "MapProjection.h"
+#include "SatelliteModel.h"
+
+namespace rose {
+
+    /**
+     * @struct CelestialPosition
+     * @brief The positions of the Sun and Moon at a point in time.
+     */
+    struct CelestialPosition {
+        std::chrono::system_clock::time_point epoch{};  ///< The time the positions apply to.
+        GeoPosition subSolar{};                         ///< The sub-solar point in radians.
+        GeoPosition subLunar{};                         ///< The sub-lunar point in radians.
+        double moonPhase{0.};                           ///< The moon phase [0..2*M_PI].
+        bool lunarValid{false};                         ///< True if subLunar was computed.
+    };
+
+    /**
+     * @class CelestialEphemeris
+     * @brief A time indexed cache of Sun and Moon positions.
+     * @details Positions are computed at the start and end of the current interval when update() is called,
+     * normally once per TimerTick minute. Positions for any time are interpolated between the two samples
+     * so drawing requires no ephemeris computation. update() may be called from the TimerTick thread while
+     * position() is called from the rendering thread.
+     */
+    class CelestialEphemeris {
+    public:
+        /// The interval between computed samples.
+        static constexpr std::chrono::seconds Interval{60};
+
+    protected:
+        /// Protect the sample table and the Moon observation.
+        mutable std::mutex mMutex{};
+
+        /// Observation used to compute the Moon position.
+        SatelliteObservation mMoon{};
+
+        /// The samples at the start and end of the current interval.
+        std::array<CelestialPosition,2> mTable{};
+
+        /// True when the table holds computed samples.
+        bool mValid{false};
+
+        /// Compute a sample, mMutex must be held.
+        CelestialPosition compute(std::chrono::system_clock::time_point epoch);
+
+    public:
+        CelestialEphemeris() = default;
+
+        ~CelestialEphemeris() = default;
+
+        CelestialEphemeris(const CelestialEphemeris&) = delete;
+
+        CelestialEphemeris(CelestialEphemeris&&) = delete;
+
+        CelestialEphemeris& operator=(const CelestialEphemeris&) = delete;
+
+        CelestialEphemeris& operator=(CelestialEphemeris&&) = delete;
+
+        /**
+         * @brief Set the observer used to compute the Moon position and recompute the table.
+         * @param observer The Observer.
+         * @return True if the Moon ephemeris is available.
+         */
+        bool setObserver(const Observer &observer);
+
+        /**
+         * @brief Make sure the table brackets a time, computing new samples only when it does not.
+         * @param epoch The time.
+         */
+        void update(std::chrono::system_clock::time_point epoch);
+
+        /**
+         * @brief Get the positions at a time, interpolated from the table.
+         * @details If the time is outside the table the nearest sample is returned.
+         * @param epoch The time.
+         * @return The CelestialPosition.
+         */
+        [[nodiscard]] CelestialPosition position(std::chrono::system_clock::time_point epoch) const;
+
+        /// Get the positions now.
+        [[nodiscard]] CelestialPosition position() const {
+            return position(std::chrono::system_clock::now());
+        }
+    };
+}
+
@@ -20,30 +20,31 @@ namespace rose {
     void CelestialOverlay::draw(gm::Context &context, const Position<int>& containerPosition) {
         Rectangle widgetRect{containerPosition + mPos, mSize};
 
+        if (mTrackedSatellite) {
+            if (auto mapProjection = containerAs<MapProjection>(); mapProjection)
+                drawGroundTrack(context, *mapProjection, widgetRect);
+        }
+
         if (mDisplayCelestialObjects) {
             if (auto mapProjection = containerAs<MapProjection>(); mapProjection) {
                 int splitPixel = util::roundToInt((double) widgetRect.w * ((mapProjection->getQth().lon) / 360.));
                 if (splitPixel < 0)
                     splitPixel += widgetRect.w;
-                std::cout << __PRETTY_FUNCTION__ << '\n';
+                auto celestialPosition = mCelestialEphemeris.position();
                 for (auto &celestial : CelestialOverlayFileName) {
                     switch (celestial.mapOverLayImage) {
                         case MapOverLayImage::Sun:
-                            std::cout << "MapOverLayImage::Sun  "
-                                      << static_cast<int>(mMapOverlayId[static_cast<std::size_t>(celestial.mapOverLayImage)])
-                                      << '\n';
                             mapProjection->drawMapItem(
                                     mMapOverlayId[static_cast<std::size_t>(celestial.mapOverLayImage)],
-                                    context, widgetRect, mSubSolar, mapProjection->getProjection(), splitPixel);
+                                    context, widgetRect, celestialPosition.subSolar, mapProjection->getProjection(),
+                                    splitPixel);
                             break;
                         case MapOverLayImage::Moon:
-                            std::cout << "MapOverLayImage::Moon "
-                                      << static_cast<int>(mMapOverlayId[static_cast<std::size_t>(celestial.mapOverLayImage)])
-                                      << '\n';
-
-                            mapProjection->drawMapItem(
-                                    mMapOverlayId[static_cast<std::size_t>(celestial.mapOverLayImage)],
-                                    context, widgetRect, mSubLunar, mapProjection->getProjection(), splitPixel);
+                            if (celestialPosition.lunarValid)
+                                mapProjection->drawMapItem(
+                                        mMapOverlayId[static_cast<std::size_t>(celestial.mapOverLayImage)],
+                                        context, widgetRect, celestialPosition.subLunar,
+                                        mapProjection->getProjection(), splitPixel);
                             break;
                         default:
                             break;
@@ -55,6 +56,27 @@ namespace rose {
         }
     }
 
+    void CelestialOverlay::drawGroundTrack(gm::Context &context, MapProjection &mapProjection, Rectangle widgetRect) {
+        auto &groundTrack = mGroundTrack.compute(*mTrackedSatellite, std::chrono::system_clock::now());
+
+        AntiAliasedDrawing drawing{context, AntiAliasedDrawing::AntiAliased};
+        auto widgetSize = widgetRect.size();
+        drawing.setWidthColor(context, GroundTrackWidth, GroundTrackColor, widgetSize);
+
+        mapProjection.geoToMap(groundTrack.track, mTrackPositions, widgetRect);
+        mapProjection.drawMapPolyline(context, drawing, widgetRect, mTrackPositions);
+        mapProjection.geoToMap(groundTrack.footprint, mTrackPositions, widgetRect);
+        mapProjection.drawMapPolyline(context, drawing, widgetRect, mTrackPositions);
+    }
+
+    void CelestialOverlay::setTrackedSatellite() {
+        SatelliteObservation observation{mSatelliteObservation.observer(), std::string{TrackedSatelliteName}};
+        if (observation.empty())
+            mTrackedSatellite.reset();
+        else
+            mTrackedSatellite = observation.front();
+    }
+
     Rectangle CelestialOverlay::layout(gm::Context &context, const Rectangle &screenRect) {
         return screenRect;
     }
@@ -65,25 +87,37 @@ namespace rose {
 
             mSatelliteObservation = SatelliteObservation{
                     Observer{mapProjection->getQth().lat, mapProjection->getQth().lon, 0.}};
-            mSatelliteObservation.passPrediction(6, "ISS");
 
-            mCelestialObservations = SatelliteObservation{mSatelliteObservation.observer(), "Moon"};
-            mCelestialObservations.predict(DateTime{true});
-            if (mCelestialObservations.empty()) {
+            mPassPredictionSlot = PassPredictionProtocol::createSlot();
+            mPassPredictionSlot->receiver = [&](const std::vector<SatellitePassData> &passData) {
+                mPassPredictions = passData;
+            };
+            mPassPredictor.passesPredicted.connect(mPassPredictionSlot);
+            mPassPredictor.predict(mSatelliteObservation, 6, "ISS");
+            setTrackedSatellite();
+
+            if (!mCelestialEphemeris.setObserver(mSatelliteObservation.observer()))
                 mDisplayCelestialObjects = false;
-            } else {
-                auto[lat, lon] = mCelestialObservations.front().geo();
-                mSubLunar = GeoPosition{lat, lon, true};
-            }
 
+            // The minute signal is transmitted on the SDL timer thread, so it only flags the work which is
+            // then done on the main thread at the next frame.
             mCelestialUpdateTimer = TickProtocol::createSlot();
             mCelestialUpdateTimer->receiver = [&](int minutes) {
-                if ((minutes % 2) == 0) {
-                    if (auto mapProjection = containerAs<MapProjection>(); mapProjection)
-                        if (mapProjection->mapProjectionsValid())
-                            setCelestialObservations();
+                mCelestialUpdateDue = true;
+                if ((minutes % 10) == 0)
+                    mPredictionDue = true;
+            };
+
+            mFrameProtocol = GraphicsModelFrameProtocol::createSlot();
+            mFrameProtocol->receiver = [&](uint32_t) {
+                if (mCelestialUpdateDue.exchange(false))
+                    setCelestialObservations();
+                if (mPredictionDue.exchange(false)) {
+                    mPassPredictor.predict(mSatelliteObservation, 6, "ISS");
+                    setTrackedSatellite();
                 }
             };
+            CommonSignals::getCommonSignals().frameSignal.connect(mFrameProtocol);
         } else {
             throwContainerError();
         }
@@ -11,7 +11,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <optional>
 #include "MapProjection.h"
+#include "CelestialEphemeris.h"
+#include "GroundTrack.h"
 
 namespace rose {
 
@@ -33,24 +37,54 @@ namespace rose {
 
         std::array<ImageId,CelestialOverlayFileName.size()> mMapOverlayId{};
 
+        /// The satellite whose ground track and footprint are displayed.
+        static constexpr std::string_view TrackedSatelliteName{"ISS"};
+
+        /// The ground track and footprint line width.
+        static constexpr int GroundTrackWidth = 1;
+
+        /// The ground track and footprint line color.
+        static constexpr color::RGBA GroundTrackColor{1.f, 0.6f, 0.f, 1.f};
+
         /// Slot to receive celestial update time signals on.
         TickProtocol::slot_type mCelestialUpdateTimer{};
 
-        /// If true celestial objects (Sun, Moon) will be displayed.
-        bool mDisplayCelestialObjects{true};
+        /// Slot to do the updates requested by mCelestialUpdateTimer on the main thread.
+        GraphicsModelFrameProtocol::slot_type mFrameProtocol{};
 
-        /// The last calculated celestial observations.
-        SatelliteObservation mCelestialObservations;
+        /// Set on the timer thread when the Sun and Moon positions are due to be updated.
+        std::atomic_bool mCelestialUpdateDue{false};
 
-        /// The geographic sub-solar position.
-        GeoPosition mSubSolar{};
+        /// Set on the timer thread when a new pass prediction is due.
+        std::atomic_bool mPredictionDue{false};
 
-        /// The geographic sub-lunar position.
-        GeoPosition mSubLunar{};
+        /// If true celestial objects (Sun, Moon) will be displayed.
+        bool mDisplayCelestialObjects{true};
+
+        /// Cached Sun and Moon positions.
+        CelestialEphemeris mCelestialEphemeris{};
 
         /// The last calculated observations.
         SatelliteObservation mSatelliteObservation;
 
+        /// Background pass prediction for mSatelliteObservation.
+        PassPredictor mPassPredictor{};
+
+        /// Slot to receive pass predictions on.
+        PassPredictionProtocol::slot_type mPassPredictionSlot{};
+
+        /// The last pass predictions received, sorted by rise time.
+        std::vector<SatellitePassData> mPassPredictions{};
+
+        /// The tracked satellite, refreshed from the SatelliteModel with each pass prediction.
+        std::optional<Satellite> mTrackedSatellite{};
+
+        /// Cached ground track and footprint of mTrackedSatellite.
+        GroundTrack mGroundTrack{};
+
+        /// Screen positions of the ground track or footprint, reused between draws.
+        std::vector<Position<MapPositionType>> mTrackPositions{};
+
         /// Path to the XDG application data directory.
         std::filesystem::path mXdgDataPath;
 
@@ -93,20 +127,20 @@ namespace rose {
         /// Load overlay images into the ImageStore.
         void loadMapCelestialObjectImages(const std::filesystem::path &xdgResourcePath, gm::Context &context);
 
+        /// Copy the tracked satellite from the SatelliteModel, picking up new TLEs.
+        void setTrackedSatellite();
+
+        /// Draw the ground track and footprint of the tracked satellite.
+        void drawGroundTrack(gm::Context &context, MapProjection &mapProjection, Rectangle widgetRect);
+
+        /// Bring the cached Sun and Moon positions up to date.
         void setCelestialObservations() {
-            auto[latS, lonS] = MapProjection::subSolar();
-            mSubSolar = GeoPosition{latS, lonS, true};
-
-            if (mCelestialObservations.empty()) {
-                mCelestialObservations = SatelliteObservation{mSatelliteObservation.observer(), "Moon"};
-                mCelestialObservations.predict(DateTime{true});
-            }
-
-            if (!mCelestialObservations.empty()) {
-                mCelestialObservations.predict(DateTime{true});
-                auto[lat, lon] = mCelestialObservations.front().geo();
-                mSubLunar = GeoPosition{lat, lon, true};
-            }
+            mCelestialEphemeris.update(std::chrono::system_clock::now());
+        }
+
+        /// The last pass predictions received, sorted by rise time.
+        [[nodiscard]] const std::vector<SatellitePassData>& passPredictions() const noexcept {
+            return mPassPredictions;
         }
 
         static void throwContainerError() {
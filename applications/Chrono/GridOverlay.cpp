@@ -32,6 +32,7 @@ namespace rose {
                     auto widgetSize = widgetRect.size();
                     Rectangle textureRect{Position<int>{}, widgetRect.size()};
                     mTexture = gm::Texture{context, widgetRect.size()};
+                    mTexture.setCategory(gm::TextureCategory::Map);
                     mTexture.setBlendMode(SDL_BLENDMODE_BLEND);
                     gm::RenderTargetGuard renderTargetGuard{context, mTexture};
                     gm::DrawColorGuard drawColorGuard{context, color::RGBA::TransparentBlack};
@@ -0,0 +1,76 @@
+/**
+ * @file GroundTrack.cpp
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-06-24
+ */
+
+#include "GroundTrack.h"
+
+namespace rose {
+
+    GroundTrack::GroundTrack(std::size_t trackSamples, std::size_t footprintSamples, std::chrono::seconds bucket)
+            : mTrackSamples(std::max(trackSamples, static_cast<std::size_t>(2))),
+              mFootprintSamples(std::max(footprintSamples, static_cast<std::size_t>(3))),
+              mBucket(bucket) {
+        mBearings.reserve(mFootprintSamples + 1);
+        for (std::size_t i = 0; i <= mFootprintSamples; ++i) {
+            auto bearing = 2. * M_PI * static_cast<double>(i) / static_cast<double>(mFootprintSamples);
+            mBearings.emplace_back(sin(bearing), cos(bearing));
+        }
+    }
+
+    const GroundTrackData& GroundTrack::compute(Satellite &satellite, std::chrono::system_clock::time_point epoch) {
+        using namespace std::chrono;
+        auto bucketStart = system_clock::time_point{duration_cast<seconds>(epoch.time_since_epoch()) /
+                                                    mBucket.count() * mBucket.count()};
+
+        auto &entry = mCache[std::string{satellite.getName()}];
+        if (entry.epochDay == satellite.DE && entry.epochTime == satellite.TE && entry.data.epoch == bucketStart &&
+            !entry.data.track.empty())
+            return entry.data;
+
+        entry.epochDay = satellite.DE;
+        entry.epochTime = satellite.TE;
+        entry.data.epoch = bucketStart;
+
+        // DateTime has no conversion from time_point so offset the current time.
+        DateTime start{true};
+        start += static_cast<long>(duration_cast<seconds>(bucketStart - system_clock::now()).count());
+
+        // The sub-satellite point and footprint at the start of the bucket.
+        satellite.predict(start);
+        auto[lat, lon] = satellite.geo();
+        entry.data.subSatellite = GeoPosition{lat, lon, true};
+        footprint(entry.data.subSatellite, satellite.viewingRadius(0.), entry.data.footprint);
+
+        // The ground track over one period.
+        auto step = satellite.period() / static_cast<double>(mTrackSamples - 1);
+        entry.data.track.resize(mTrackSamples);
+        for (std::size_t i = 0; i < mTrackSamples; ++i) {
+            satellite.predict(start + step * static_cast<double>(i));
+            auto[tLat, tLon] = satellite.geo();
+            entry.data.track[i] = GeoPosition{tLat, tLon, true};
+        }
+
+        return entry.data;
+    }
+
+    void GroundTrack::footprint(const GeoPosition &subSatellite, double radius,
+                                std::vector<GeoPosition> &footprint) const {
+        auto center = subSatellite.toRadians();
+        auto sinLat = sin(center.lat);
+        auto cosLat = cos(center.lat);
+        auto sinR = sin(radius);
+        auto cosR = cos(radius);
+
+        footprint.resize(mBearings.size());
+        std::transform(mBearings.begin(), mBearings.end(), footprint.begin(),
+                       [&](const std::pair<double,double> &bearing) -> GeoPosition {
+                           auto[sinB, cosB] = bearing;
+                           auto sinLat2 = std::clamp(sinLat * cosR + cosLat * sinR * cosB, -1., 1.);
+                           auto lon2 = center.lon + atan2(sinB * sinR * cosLat, cosR - sinLat * sinLat2);
+                           return GeoPosition{asin(sinLat2), std::remainder(lon2, 2. * M_PI), true};
+                       });
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file GroundTrack.h
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-06-24
+ * @brief Satellite ground track and footprint generation.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <vector>
+#include "MapProjection.h"
+#include "Plan13.h"
+
+namespace rose {
+
+    /**
+     * @struct GroundTrackData
+     * @brief The ground track and visibility footprint of a satellite.
+     * @details All positions are in radians. The track holds samples spaced evenly over one orbital period
+     * starting at the time the data was computed, the footprint holds samples spaced evenly around the
+     * viewing circle at the sub-satellite point at that time.
+     */
+    struct GroundTrackData {
+        std::chrono::system_clock::time_point epoch{};  ///< The start of the time bucket the data was computed for.
+        GeoPosition subSatellite{};                     ///< The sub-satellite point at epoch.
+        std::vector<GeoPosition> track{};               ///< The ground track samples.
+        std::vector<GeoPosition> footprint{};           ///< The footprint circle samples.
+    };
+
+    /**
+     * @class GroundTrack
+     * @brief Generate and cache satellite ground tracks and footprints.
+     * @details Results are cached by satellite name and are reused until the satellite's TLE epoch changes
+     * or the time moves into a new bucket, so per-frame drawing does not re-propagate the orbit.
+     */
+    class GroundTrack {
+    protected:
+        /// Number of ground track samples over one period.
+        std::size_t mTrackSamples;
+
+        /// Number of footprint samples around the viewing circle.
+        std::size_t mFootprintSamples;
+
+        /// The time bucket size.
+        std::chrono::seconds mBucket;
+
+        /// Sine and cosine of the footprint bearings, computed once.
+        std::vector<std::pair<double,double>> mBearings{};
+
+        /// A cached result and the TLE epoch it was computed from.
+        struct CacheEntry {
+            long epochDay{};
+            double epochTime{};
+            GroundTrackData data{};
+        };
+
+        /// The cache keyed by satellite name.
+        std::map<std::string, CacheEntry, std::less<>> mCache{};
+
+    public:
+        /**
+         * @brief Constructor
+         * @param trackSamples Number of ground track samples over one period.
+         * @param footprintSamples Number of footprint samples around the viewing circle.
+         * @param bucket The time bucket size.
+         */
+        explicit GroundTrack(std::size_t trackSamples = 120, std::size_t footprintSamples = 72,
+                             std::chrono::seconds bucket = std::chrono::seconds{60});
+
+        /**
+         * @brief Get the ground track and footprint of a satellite.
+         * @param satellite The satellite, used to propagate the orbit.
+         * @param epoch The time, the data is computed for the start of the bucket containing it.
+         * @return The GroundTrackData, valid until the next call for the same satellite.
+         */
+        const GroundTrackData& compute(Satellite &satellite, std::chrono::system_clock::time_point epoch);
+
+        /**
+         * @brief Compute the footprint circle around a sub-satellite point.
+         * @param subSatellite The sub-satellite point in radians.
+         * @param radius The great-circle viewing radius in radians.
+         * @param footprint The container the footprint samples are written to.
+         */
+        void footprint(const GeoPosition &subSatellite, double radius, std::vector<GeoPosition> &footprint) const;
+
+        /// Discard all cached results.
+        void clear() {
+            mCache.clear();
+        }
+    };
+}
+
@@ -24,6 +24,16 @@ namespace rose {
 
         setLayoutManager(std::make_unique<Overlay>());
 
+        // The projection not on display is the cheapest texture memory to give up, it is rebuilt from the
+        // illuminated maps if it is selected.
+        mEvictionHandler = gm::TextureMemory::getTextureMemory().addEvictionHandler(0, [this](size_t) {
+            if (!mIlluminatedMaps)
+                return;
+            auto &inactive = mProjection == MapProjectionType::StationAzimuthal ? mMercator : mAzimuthal;
+            for (auto &texture : inactive)
+                texture.reset();
+        });
+
         Environment &environment{Environment::getEnvironment()};
 
         mKeyboardShortcutCallback = [&](uint32_t shortcutCode, bool pressed, uint repeat) {
@@ -51,7 +61,7 @@ namespace rose {
                 if (projectionType != mProjection) {
                     mProjection = projectionType;
                     Settings::getSettings().setValue(set::ChronoMapProjection, static_cast<int>(mProjection));
-                    getApplication().redrawBackground();
+                    getApplication().redrawWindow(getWindow());
                 }
 
                 if (mapDepiction != mMapDepiction) {
@@ -63,17 +73,127 @@ namespace rose {
         };
     }
 
+    MapProjection::~MapProjection() {
+        // Abandon work in progress, and drop work which has not started.
+        ++mWork->generation;
+        mWorkToken.cancel();
+        gm::TextureMemory::getTextureMemory().removeEvictionHandler(mEvictionHandler);
+    }
+
     void MapProjection::cacheCurrentMaps() {
         mMapProjectionsInvalid = true;
+        auto generation = ++mWork->generation;
+
+        // Work for the superseded generation finds the generation changed and stops, its result is dropped.
+        mProjectedMapsFuture = std::future<std::shared_ptr<ProjectedMaps>>{};
+        mIlluminatedMapsFuture = std::future<std::shared_ptr<IlluminatedMaps>>{};
+
+        std::array<std::string,2> mapFileName{MapFileName(mMapDepiction,mMapSize,MapIllumination::Day),
+                                              MapFileName(mMapDepiction,mMapSize,MapIllumination::Night)};
+
+        std::array<std::optional<std::filesystem::path>,2> mapPath;
+        std::transform(mapFileName.begin(), mapFileName.end(), mapPath.begin(), [](auto &fileName){
+            return Environment::getEnvironment().appResourcesAppend("maps").append(fileName);
+        });
+
+        if (mapPath[0] && mapPath[1]) {
+            mWork->rows = 0;
+            mProgressTotal = 2 * MapImageSize(mMapSize).h;
+            std::array<std::filesystem::path,2> paths{mapPath[0].value(), mapPath[1].value()};
+            mProjectedMapsFuture = WorkerPool::getWorkerPool().submit(
+                    [work = mWork, generation, qthRad = mQthRad, paths]() {
+                        return projectMaps(work, generation, qthRad, paths);
+                    },
+                    TaskPriority::Low, mWorkToken);
+        }
+
+        if (!mFrameProtocol) {
+            mFrameProtocol = GraphicsModelFrameProtocol::createSlot();
+            mFrameProtocol->receiver = [&](uint32_t frame) {
+                processFutures();
+            };
+            CommonSignals::getCommonSignals().frameSignal.connect(mFrameProtocol);
+        }
+    }
+
+    std::shared_ptr<MapProjection::ProjectedMaps>
+    MapProjection::projectMaps(std::shared_ptr<WorkProgress> work, uint32_t generation, GeoPosition qthRad,
+                               std::array<std::filesystem::path,2> mapPath) {
+        auto maps = std::make_shared<ProjectedMaps>();
+        maps->generation = generation;
+
+        for (size_t i = 0; i < mapPath.size(); i++) {
+            if (generation != work->generation)
+                return nullptr;
+
+            gm::Surface bmp{mapPath[i]};
+            if (!bmp)
+                return nullptr;
+            if (i) {
+                Size bmpSize{bmp->w, bmp->h};
+                if (bmpSize != maps->size)
+                    throw std::runtime_error("Image size mismatch.");
+            } else {
+                maps->size = Size{bmp->w, bmp->h};
+            }
+            maps->mercator[i] = gm::Surface{bmp->w, bmp->h};
+            maps->mercator[i].blitSurface(bmp);
+            maps->azimuthal[i] = gm::Surface{bmp->w, bmp->h};
+        }
+
+        if (!azimuthalProjectionSet([&work, generation](int rows) { return work->current(generation, rows); },
+                                    qthRad, maps->size, maps->azimuthal, maps->mercator, maps->azimuthalIndex))
+            return nullptr;
+
+        return maps;
+    }
+
+    void MapProjection::startIllumination() {
+        if (!mProjectedMaps)
+            return;
+
+        mIlluminatedMapsFuture = WorkerPool::getWorkerPool().submit(
+                [work = mWork, maps = mProjectedMaps]() {
+                    return setForegroundBackground(work, maps, maps->generation);
+                },
+                TaskPriority::Normal, mWorkToken);
+    }
 
-        std::array<std::tuple<MapDepiction,MapSize,MapIllumination>,2> maps{
-                std::make_tuple(mMapDepiction, mMapSize, MapIllumination::Day),
-                std::make_tuple(mMapDepiction, mMapSize, MapIllumination::Night),
+    void MapProjection::processFutures() {
+        auto ready = [](auto &future) {
+            return future.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
         };
 
-        for (auto &map : maps) {
-            auto [depiction,size,illumination] = map;
-            auto name = MapFileName(depiction,size,illumination);
+        if (mProjectedMapsFuture.valid() && ready(mProjectedMapsFuture)) {
+            if (auto maps = mProjectedMapsFuture.get(); maps && maps->generation == mWork->generation) {
+                mProjectedMaps = maps;
+                mMapImgSize = maps->size;
+                mMapProjectionsInvalid = false;
+                startIllumination();
+            }
+        }
+
+        if (mIlluminationDue && !mMapProjectionsInvalid && !mIlluminatedMapsFuture.valid()) {
+            mIlluminationDue = false;
+            mWork->rows = 0;
+            mProgressTotal = mMapImgSize.h;
+            startIllumination();
+        }
+
+        if (mIlluminatedMapsFuture.valid() && ready(mIlluminatedMapsFuture)) {
+            if (auto maps = mIlluminatedMapsFuture.get(); maps) {
+                mIlluminatedMaps = maps;
+                mNewSurfaces = true;
+                getApplication().redrawWindow(getWindow());
+            }
+        }
+
+        bool pending = mProjectedMapsFuture.valid() || mIlluminatedMapsFuture.valid();
+        int total = mProgressTotal;
+        int progress = pending ? std::min(static_cast<int>(mWork->rows), total) : total;
+        if (progress != mProgressReported) {
+            mProgressReported = progress;
+            mapProgress.transmit(progress, total);
         }
     }
 
@@ -91,14 +211,14 @@ namespace rose {
         mMapSlot = WebCacheProtocol::createSlot();
         mMapSlot->receiver = [&](uint32_t key, long status) {
             std::cout << __PRETTY_FUNCTION__ << ' ' << key << ' ' << status << '\n';
-            getApplication().redrawBackground();
+            getApplication().redrawWindow(getWindow());
         };
 
         mMapIlluminationTimer = TickProtocol::createSlot();
         mMapIlluminationTimer->receiver = [&](int minutes){
-            if ((minutes % 2) == 0 && !mMapProjectionsInvalid && !mForegroundBackgroundFuture.valid()) {
-                mForegroundBackgroundFuture = std::async(std::launch::async, &MapProjection::setForegroundBackground, this);
-            }
+            // Runs on the timer thread, the illumination is started from the frame signal on the main thread.
+            if ((minutes % 2) == 0)
+                mIlluminationDue = true;
         };
 
         mTimerTick->minuteSignal.connect(mMapIlluminationTimer);
@@ -107,82 +227,45 @@ namespace rose {
     }
 
     void MapProjection::draw(gm::Context &context, const Position<int>& containerPosition) {
-        if (mMapProjectionsInvalid) {
-            if (!mComputeAzimuthalMapsFuture.valid()) {
-                std::array<std::string,2> mapFileName{MapFileName(mMapDepiction,mMapSize,MapIllumination::Day),
-                                                      MapFileName(mMapDepiction,mMapSize,MapIllumination::Night)};
-
-                std::array<std::optional<std::filesystem::path>,2> mapPath;
-                std::transform(mapFileName.begin(), mapFileName.end(), mapPath.begin(), [](auto &fileName){
-                    return Environment::getEnvironment().appResourcesAppend("maps").append(fileName);
-                });
-
-                if (mapPath[0] && mapPath[1]) {
-                    for (size_t i = 0; i < mapPath.size(); i++) {
-                        gm::Surface bmp{mapPath[i].value()};
-                        if (i) {
-                            Size bmpSize{bmp->w, bmp->h};
-                            if (bmpSize != mMapImgSize)
-                                throw std::runtime_error("Image size mismatch.");
-                        } else {
-                            mMapImgSize = Size{bmp->w, bmp->h};
-                        }
-                        mMapSurface[i] = gm::Surface{bmp->w, bmp->h};
-                        mMapSurface[i].blitSurface(bmp);
-                        mAzSurface[i] = gm::Surface{bmp->w, bmp->h};
-                    }
-
-                    mComputeAzimuthalMapsFuture = std::async(std::launch::async,
-                                                             &MapProjection::computeAzimuthalMaps, this);
-                }
-            } else {
-                std::chrono::milliseconds span{100};
-                if (auto futureStatus = mComputeAzimuthalMapsFuture.wait_for(span); futureStatus ==
-                                                                                    std::future_status::ready) {
-
-                    if (mComputeAzimuthalMapsFuture.get()) {
-                        mForegroundBackgroundFuture = std::async(std::launch::async,
-                                                                 &MapProjection::setForegroundBackground, this);
-                        mMapProjectionsInvalid = false;
-                    } else
-                        std::cout << __PRETTY_FUNCTION__ << " computeAzimuthalMaps returned false.\n";
+        bool azimuthal = mProjection == MapProjectionType::StationAzimuthal;
+        auto &active = azimuthal ? mAzimuthal : mMercator;
+        auto &inactive = azimuthal ? mMercator : mAzimuthal;
+
+        if (mIlluminatedMaps) {
+            // Illumination updates keep the map size, so the Textures are updated in place.
+            auto upload = [&context](std::array<gm::Surface,2> &surfaces, std::array<gm::Texture,2> &textures) {
+                for (size_t i = 0; i < surfaces.size(); ++i) {
+                    surfaces[i].streamToTexture(context, textures[i]);
+                    textures[i].setBlendMode(SDL_BLENDMODE_BLEND);
+                    textures[i].setCategory(gm::TextureCategory::Map);
                 }
-            }
-        }
-
-        if (mForegroundBackgroundFuture.valid()) {
-            std::chrono::milliseconds span{100};
-            if (auto futureStatus = mForegroundBackgroundFuture.wait_for(span); futureStatus ==
-                                                                                std::future_status::ready) {
-
-                if (mNewSurfaces = mForegroundBackgroundFuture.get(); !mNewSurfaces)
-                    std::cout << __PRETTY_FUNCTION__ << " setForegroundBackground returned false.\n";
-            }
-        }
-
-        if (mNewSurfaces) {
+            };
+
+            auto &activeMaps = azimuthal ? mIlluminatedMaps->azimuthal : mIlluminatedMaps->mercator;
+            auto &inactiveMaps = azimuthal ? mIlluminatedMaps->mercator : mIlluminatedMaps->azimuthal;
+            if (mNewSurfaces || !active[0] || !active[1])
+                upload(activeMaps, active);
+
+            // The inactive projection is cached so switching is immediate, unless it has been evicted to stay
+            // within the texture memory budget.
+            auto budget = gm::TextureMemory::getTextureMemory().budget();
+            if (mNewSurfaces && (inactive[0] || !budget))
+                upload(inactiveMaps, inactive);
             mNewSurfaces = false;
-            for (size_t i = 0; i < mMercatorTemp.size(); ++i) {
-                mMercator[i] = mMercatorTemp[i].toTexture(context);
-                mMercator[i].setBlendMode(SDL_BLENDMODE_BLEND);
-                mMercatorTemp[i].reset(nullptr);
-            }
 
-            for (size_t i = 0; i < mAzimuthalTemp.size(); ++i) {
-                mAzimuthal[i] = mAzimuthalTemp[i].toTexture(context);
-                mAzimuthal[i].setBlendMode(SDL_BLENDMODE_BLEND);
-                mAzimuthalTemp[i].reset(nullptr);
-            }
+            // Without a budget nothing is evicted, so the surfaces are not needed once uploaded.
+            if (!budget)
+                mIlluminatedMaps.reset();
         }
 
-        if (!mMercator[0] || !mAzimuthal[0]) {
+        if (!active[0] || !active[1]) {
             return;
         }
 
         Rectangle widgetRect{containerPosition + mPos, mSize};
         gm::ClipRectangleGuard clipRectangleGuard(context, widgetRect);
 
-        auto actualMapImgSize = mMercator[0].getSize();
+        auto actualMapImgSize = active[0].getSize();
         auto splitPixel = projectionSplitPixel(actualMapImgSize);
 
         switch (mProjection) {
@@ -204,6 +287,7 @@ namespace rose {
                 dst1.w = splitPixel;
 
                 gm::Texture tempTexture{context, actualMapImgSize};
+                tempTexture.setCategory(gm::TextureCategory::Map);
                 if (tempTexture){
                     gm::RenderTargetGuard renderTargetGuard{context, tempTexture};
 
@@ -311,14 +395,24 @@ namespace rose {
 
     void MapProjection::azimuthalProjection(gm::Surface &projectedSurface, const gm::Surface &mapSurface,
                                             Position<int> projected, Position<int> map) {
-        projectedSurface.pixel(projected.x, projected.y) = gm::mapRGBA(projectedSurface->format,
-                                                                       gm::getRGBA(mapSurface->format,
-                                                                                   mapSurface.pixel(map.x, map.y)));
+        auto &pixel = projectedSurface.pixel(projected.x, projected.y);
+        if (projectedSurface->format->format == mapSurface->format->format)
+            pixel = mapSurface.pixel(map.x, map.y);
+        else
+            pixel = gm::mapRGBA(projectedSurface->format, gm::getRGBA(mapSurface->format,
+                                                                        mapSurface.pixel(map.x, map.y)));
+    }
+
+    bool MapProjection::parallelRows(int rows, const std::function<bool(int, int)> &rowFunction) {
+        return WorkerPool::getWorkerPool().parallelFor(rows, rowFunction, TaskPriority::Normal);
     }
 
     std::tuple<double, double> MapProjection::subSolar() {
+        return subSolar(std::chrono::system_clock::now());
+    }
+
+    std::tuple<double, double> MapProjection::subSolar(std::chrono::system_clock::time_point epoch) {
         using namespace std::chrono;
-        auto epoch = system_clock::now();
         time_t tt = system_clock::to_time_t(epoch);
 
         double JD = (tt / 86400.0) + 2440587.5;
@@ -336,7 +430,9 @@ namespace rose {
         return std::make_tuple(lat, lng);
     }
 
-    bool MapProjection::setForegroundBackground() {
+    std::shared_ptr<MapProjection::IlluminatedMaps>
+    MapProjection::setForegroundBackground(std::shared_ptr<WorkProgress> work, std::shared_ptr<ProjectedMaps> maps,
+                                           uint32_t generation) {
         // Compute the amount of solar illumination and use it to compute the pixel alpha value
         // GrayLineCos sets the interior angle between the sub-solar point and the location.
         // GrayLinePower sets how fast it gets dark.
@@ -345,81 +441,106 @@ namespace rose {
 
         auto start = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
-        for (size_t i = 0; i < mMercatorTemp.size(); ++i) {
-            mMercatorTemp[i] = gm::Surface{mMapImgSize};
-            mAzimuthalTemp[i] = gm::Surface{mMapImgSize};
-
-            mMercatorTemp[i].setBlendMode(SDL_BLENDMODE_BLEND);
-            mAzimuthalTemp[i].setBlendMode(SDL_BLENDMODE_BLEND);
-            mMercatorTemp[i].blitSurface(mMapSurface[i]);
-            mAzimuthalTemp[i].blitSurface(mAzSurface[i]);
+        auto illuminated = std::make_shared<IlluminatedMaps>();
+        for (size_t i = 0; i < illuminated->mercator.size(); ++i) {
+            illuminated->mercator[i] = gm::Surface{maps->size};
+            illuminated->azimuthal[i] = gm::Surface{maps->size};
+
+            illuminated->mercator[i].setBlendMode(SDL_BLENDMODE_BLEND);
+            illuminated->azimuthal[i].setBlendMode(SDL_BLENDMODE_BLEND);
+            illuminated->mercator[i].blitSurface(maps->mercator[i]);
+            illuminated->azimuthal[i].blitSurface(maps->azimuthal[i]);
         }
 
-        auto sinY = sin(mQthRad.lat);
-        auto cosY = cos(mQthRad.lat);
-
-        // Three loops for: Longitude, Latitude, and map form (Mercator, Azimuthal).
-        // This lets us use the common calculations without repeating them, easier than
-        // debugging two areas with the same computation.
-        for (int x = 0; x < mMapImgSize.w; x += 1) {
-            for (int y = 0; y < mMapImgSize.h; y += 1) {
-                for (int az = 0; az < 2; ++az) {
-                    float alpha = 1.;
-                    bool valid;
-                    float latE;
-                    float lonE;
-
-                    if (mAbortFuture) {
-                        mAbortFuture = false;
-                        return false;
-                    }
+        // The cosine of the angle between the sub-solar point and a location is
+        // sin(latS)sin(lat) + cos(latS)cos(lat)cos(lonS - lon). Latitude is constant along a Mercator row
+        // and longitude along a column so the transcendental functions are only needed per row and column.
+        auto w = maps->size.w;
+        auto h = maps->size.h;
+        std::vector<double> rowSin(h), rowCos(h), colCos(w);
+        for (int y = 0; y < h; ++y) {
+            auto latE = (double) ((float) h / 2.f - (float) y) * M_PI_2 / ((double) h / 2.);
+            rowSin[y] = sin(latS) * sin(latE);
+            rowCos[y] = cos(latS) * cos(latE);
+        }
+        for (int x = 0; x < w; ++x) {
+            auto lonE = (double) ((float) x - (float) w / 2.f) * M_PI / ((double) w / 2.);
+            colCos[x] = cos(abs(lonS - lonE));
+        }
 
-                    if (az == 1) {
-                        // The Azimuthal coordinates that correspond to a map pixel
-                        auto tuple = xyToAzLatLong(x, y, mMapImgSize,
-                                                   mQthRad, sinY, cosY);
-                        valid = std::get<0>(tuple);
-                        latE = std::get<1>(tuple);
-                        lonE = std::get<2>(tuple);
-                    } else {
-                        // The Mercator coordinates for the same map pixel
-                        valid = true;
-                        lonE = (float) ((float) x - (float) mMapImgSize.w / 2.f) * (float) M_PI /
-                               (float) ((float) mMapImgSize.w / 2.);
-                        latE = (float) ((float) mMapImgSize.h / 2.f - (float) y) * (float) M_PI_2 /
-                               (float) ((float) mMapImgSize.h / 2.);
-                    }
-                    if (valid) {
-                        auto cosDeltaSigma = sin(latS) * sin(latE) + cos(latS) * cos(latE) * cos(abs(lonS - lonE));
-                        double dayFraction;
-                        if (cosDeltaSigma < 0) {
-                            if (cosDeltaSigma > GrayLineCos[1]) {
-                                dayFraction = 1.0 - pow(cosDeltaSigma / GrayLineCos[1], GrayLinePow);
-                                alpha = std::clamp((float) dayFraction, 0.0313f, 1.f);
-                            } else
-                                alpha = 0.0313;  // Set the minimum alpha to keep some daytime colour on the night side
-                        }
-                    } else
-                        alpha = 0;
-
-                    // Set the alpha channel in the appropriate map.
-                    if (az == 1) {
-                        auto pixel = gm::getRGBA(mAzimuthalTemp[0]->format, mAzimuthalTemp[0].pixel(x, y));
-                        pixel.a() = alpha;
-                        mAzimuthalTemp[0].pixel(x, y) = gm::mapRGBA(mAzimuthalTemp[0]->format, pixel);
-                    } else {
-                        auto pixel = gm::getRGBA(mMercatorTemp[0]->format, mMercatorTemp[0].pixel(x, y));
-                        pixel.a() = alpha;
-                        mMercatorTemp[0].pixel(x, y) = gm::mapRGBA(mMercatorTemp[0]->format, pixel);
-                    }
+        // The gray line transition from day to night as a lookup table over cosDeltaSigma in [GrayLineCos[1]..0].
+        static constexpr size_t GrayLineSteps = 1024;
+        static constexpr uint8_t NightAlpha = 8;  // Keep some daytime colour on the night side (0.0313)
+        std::array<uint8_t, GrayLineSteps + 1> grayLine{};
+        for (size_t i = 0; i <= GrayLineSteps; ++i) {
+            auto cosDeltaSigma = GrayLineCos[1] * (double) i / (double) GrayLineSteps;
+            auto dayFraction = 1.0 - pow(cosDeltaSigma / GrayLineCos[1], GrayLinePow);
+            grayLine[i] = (uint8_t) std::lround(std::clamp(dayFraction, 0.0313, 1.) * 255.);
+        }
+
+        auto alphaValue = [&grayLine](double cosDeltaSigma) -> uint8_t {
+            if (cosDeltaSigma >= 0.)
+                return 255;
+            if (cosDeltaSigma <= GrayLineCos[1])
+                return NightAlpha;
+            return grayLine[(size_t) std::lround(cosDeltaSigma / GrayLineCos[1] * (double) GrayLineSteps)];
+        };
+
+        // Replace the alpha channel of a pixel, directly when the format has an alpha mask.
+        auto setAlpha = [](const SDL_PixelFormat *format, uint32_t &pixel, uint8_t alpha) {
+            if (format->Amask) {
+                pixel = (pixel & ~format->Amask) | (((uint32_t) alpha << format->Ashift) & format->Amask);
+            } else {
+                color::RGBA rgba{};
+                gm::pixelsToRGBA(format, &pixel, 1, &rgba);
+                rgba.a() = (float) alpha / 255.f;
+                gm::rgbaToPixels(format, &rgba, 1, &pixel);
+            }
+        };
+
+        std::vector<uint8_t> alphaField(static_cast<size_t>(w * h));
+
+        // Compute the alpha field over the Mercator grid and apply it to the Mercator map.
+        bool completed = parallelRows(h, [&](int y0, int y1) -> bool {
+            for (int y = y0; y < y1; ++y) {
+                if (((y - y0) % MapChunkRows) == 0 && generation != work->generation)
+                    return false;
+                auto row = illuminated->mercator[0].row(y);
+                auto format = illuminated->mercator[0]->format;
+                for (int x = 0; x < w; ++x) {
+                    auto alpha = alphaValue(rowSin[y] + rowCos[y] * colCos[x]);
+                    alphaField[y * w + x] = alpha;
+                    setAlpha(format, row[x], alpha);
                 }
+                ++work->rows;
             }
+            return true;
+        });
+
+        // Sample the alpha field for the Azimuthal map.
+        if (completed && maps->azimuthalIndex.size() == alphaField.size()) {
+            completed = parallelRows(h, [&](int y0, int y1) -> bool {
+                for (int y = y0; y < y1; ++y) {
+                    if (((y - y0) % MapChunkRows) == 0 && generation != work->generation)
+                        return false;
+                    auto row = illuminated->azimuthal[0].row(y);
+                    auto format = illuminated->azimuthal[0]->format;
+                    for (int x = 0; x < w; ++x) {
+                        auto index = maps->azimuthalIndex[y * w + x];
+                        setAlpha(format, row[x], index < 0 ? 0 : alphaField[index]);
+                    }
+                }
+                return true;
+            });
         }
+
+        if (!completed)
+            return nullptr;
+
         auto stop = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
         std::cout << __PRETTY_FUNCTION__ << " Duration: " << stop - start << '\n';
-        getApplication().redrawBackground();
-        return true;
+        return illuminated;
     }
 
     void MapProjection::drawMapItem(const ImageId &mapItem, gm::Context& context, Rectangle mapRectangle,
@@ -526,4 +647,38 @@ namespace rose {
         }
         return mapPos;
     }
+
+    void MapProjection::geoToMap(const std::vector<GeoPosition> &geo,
+                                 std::vector<Position<MapPositionType>> &mapPositions, Rectangle mapRect) const {
+        int splitPixel = 0;
+        if (mProjection == MapProjectionType::StationMercator)
+            splitPixel = projectionSplitPixel(mapRect.size());
+
+        auto offset = mapRect.position();
+        mapPositions.resize(geo.size());
+        std::transform(geo.begin(), geo.end(), mapPositions.begin(), [&](const GeoPosition &g) {
+            return geoToMap(g, mProjection, splitPixel, mapRect) + offset;
+        });
+    }
+
+    void MapProjection::drawMapPolyline(gm::Context &context, AntiAliasedDrawing &drawing, Rectangle mapRect,
+                                        const std::vector<Position<MapPositionType>> &mapPositions) const {
+        if (mapPositions.size() < 2)
+            return;
+
+        auto split = static_cast<MapPositionType>(mapRect.w / 2 + mapRect.x);
+        auto maxDx = static_cast<MapPositionType>(mapRect.w) / 4;
+        auto maxDy = static_cast<MapPositionType>(mapRect.h) / 4;
+        bool azimuthal = mProjection == MapProjectionType::StationAzimuthal;
+
+        for (auto p0 = mapPositions.begin(), p1 = p0 + 1; p1 != mapPositions.end(); ++p0, ++p1) {
+            bool noGap;
+            if (azimuthal)
+                noGap = (p0->x < split && p1->x < split) || (p0->x > split && p1->x > split);
+            else
+                noGap = abs(p0->x - p1->x) < maxDx && abs(p0->y - p1->y) < maxDy;
+            if (noGap)
+                drawing.renderLine(context, *p0, *p1);
+        }
+    }
 }
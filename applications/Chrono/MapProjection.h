@@ -17,6 +17,7 @@
 #include "SatelliteModel.h"
 #include "Surface.h"
 #include "AntiAliasedDrawing.h"
+#include "WorkerPool.h"
 
 // https://earthobservatory.nasa.gov/features/NightLights/page3.php
 // https://visibleearth.nasa.gov/images/57752/blue-marble-land-surface-shallow-water-and-shaded-topography
@@ -306,6 +307,12 @@ namespace rose {
         Count,
     };
 
+    /// Protocol for reporting map generation progress as rows completed and total rows.
+    using MapProgressProtocol = Protocol<int,int>;
+
+    /// The number of map rows processed between checks for pre-emption.
+    static constexpr int MapChunkRows = 16;
+
     struct OverlayImageSpec {
         MapOverLayImage mapOverLayImage;
         std::string_view fileName;
@@ -353,16 +360,82 @@ namespace rose {
         /// The size of the map image.
         Size mMapImgSize{};
 
-        std::array<gm::Surface,2> mMapSurface{};
-        std::array<gm::Surface,2> mAzSurface{};
+        /**
+         * @struct ProjectedMaps
+         * @brief The day and night maps and their Azimuthal projections produced by one map generation.
+         */
+        struct ProjectedMaps {
+            uint32_t generation{};                      ///< The generation that produced the maps.
+            Size size{};                                ///< The common size of the maps.
+            std::array<gm::Surface,2> mercator{};       ///< The day and night Mercator maps.
+            std::array<gm::Surface,2> azimuthal{};      ///< The day and night Azimuthal maps.
+            std::vector<int> azimuthalIndex{};          ///< Mercator pixel index of each Azimuthal pixel, or -1.
+        };
+
+        /**
+         * @struct IlluminatedMaps
+         * @brief Background and foreground maps with the foreground alpha set by solar illumination.
+         */
+        struct IlluminatedMaps {
+            std::array<gm::Surface,2> mercator{};       ///< The Mercator background and foreground maps.
+            std::array<gm::Surface,2> azimuthal{};      ///< The Azimuthal background and foreground maps.
+        };
+
+        /// The maps of the last completed generation.
+        std::shared_ptr<ProjectedMaps> mProjectedMaps{};
 
-        std::array<gm::Surface,2> mMercatorTemp{};
-        std::array<gm::Surface,2> mAzimuthalTemp{};
+        /**
+         * @brief The illuminated maps waiting to be converted to Textures.
+         * @details When a texture memory budget is set they are kept after conversion, to rebuild Textures
+         * evicted to stay within the budget.
+         */
+        std::shared_ptr<IlluminatedMaps> mIlluminatedMaps{};
+
+        /// The id of the TextureMemory eviction handler which drops the Textures of the inactive projection.
+        int mEvictionHandler{0};
 
         std::array<gm::Texture,2> mMercator{};     ///< The Mercator projection background and foreground maps.
         std::array<gm::Texture,2> mAzimuthal{};    ///< The Azimuthal projection background and foreground maps.
 
-        std::atomic_bool mAbortFuture{};           ///< A flag to abort background processing.
+        /**
+         * @struct WorkProgress
+         * @brief The generation and progress shared with map generation work on the WorkerPool.
+         * @details Work holds its own reference, so work still running when the MapProjection is destroyed
+         * finds the generation superseded and stops without touching the MapProjection.
+         */
+        struct WorkProgress {
+            /// Incremented for each map generation request, work for an older generation is abandoned.
+            std::atomic_uint32_t generation{0};
+
+            /// Rows completed by the current map generation.
+            std::atomic_int rows{0};
+
+            /// True if work for generation should continue, counting rows completed toward progress.
+            bool current(uint32_t workGeneration, int completedRows) {
+                if (workGeneration != generation)
+                    return false;
+                rows += completedRows;
+                return true;
+            }
+        };
+
+        /// The generation and progress of map generation work.
+        std::shared_ptr<WorkProgress> mWork{std::make_shared<WorkProgress>()};
+
+        /// Cancels map generation work which has not started when the MapProjection is destroyed.
+        CancellationToken mWorkToken{};
+
+        /// Total rows to be processed by the current map generation.
+        std::atomic_int mProgressTotal{0};
+
+        /// The last progress transmitted.
+        int mProgressReported{-1};
+
+        /// Slot to poll map generation each frame.
+        GraphicsModelFrameProtocol::slot_type mFrameProtocol{};
+
+        /// Set by the illumination timer when the illumination should be recomputed.
+        std::atomic_bool mIlluminationDue{false};
 
         /// The station location in degrees.
         GeoPosition mQth{45.,-75.};
@@ -404,26 +477,30 @@ namespace rose {
         /**
          * @brief Compute Azimuthal projection of a set of the same sized maps.
          * @tparam N The number of maps in the set.
-         * @param abort A reference to a std::atomic_bool that will cause an abort when true.
+         * @param chunkComplete Called with the number of rows completed after each chunk of rows, the
+         * projection is abandoned if it returns false.
          * @param qthRad The Latitude and Longitude of the projection origin in Radians.
          * @param mapImageSize The common size of all maps and projections.
          * @param projected A std::array<gm::Surface,N> holding the projected (output) maps.
          * @param map A std::array<gm::Surface,N> holding the source (intput) maps.
+         * @param mercatorIndex Receives, for each projected pixel, the index of the source map pixel, or -1 if
+         * the projected pixel is not on the Earth.
          * @return True if successful, false if aborted.
          */
         template<size_t N>
         static bool
-        azimuthalProjectionSet(std::atomic_bool &abort, const GeoPosition &qthRad, const Size &mapImageSize, std::array<gm::Surface,N> &projected, std::array<gm::Surface,N> &map) {
+        azimuthalProjectionSet(const std::function<bool(int)> &chunkComplete, const GeoPosition &qthRad,
+                               const Size &mapImageSize, std::array<gm::Surface,N> &projected,
+                               std::array<gm::Surface,N> &map, std::vector<int> &mercatorIndex) {
             // Compute Azimuthal maps from the Mercator maps
             auto sinY = sin(qthRad.lat);
             auto cosY = cos(qthRad.lat);
+            mercatorIndex.assign(static_cast<size_t>(mapImageSize.w * mapImageSize.h), -1);
             for (int y = 0; y < mapImageSize.h; y += 1) {
-                for (int x = 0; x < mapImageSize.w; x += 1) {
-                    if (abort) {
-                        abort = false;
-                        return false;
-                    }
+                if (y > 0 && (y % MapChunkRows) == 0 && !chunkComplete(MapChunkRows))
+                    return false;
 
+                for (int x = 0; x < mapImageSize.w; x += 1) {
                     auto[valid, lat, lon] = xyToAzLatLong(x, y, mapImageSize, qthRad, sinY, cosY);
                     if (valid) {
                         auto xx = std::min(mapImageSize.w - 1,
@@ -431,44 +508,70 @@ namespace rose {
                         auto yy = std::min(mapImageSize.h - 1,
                                            (int) round((double) mapImageSize.h * ((M_PI_2 - lat) / M_PI)));
 
+                        mercatorIndex[y * mapImageSize.w + x] = yy * mapImageSize.w + xx;
                         for (auto idx = 0; idx < N; ++idx)
                             azimuthalProjection(projected[idx], map[idx], Position<int>(x, y), Position<int>(xx, yy));
                     }
                 }
             }
+            chunkComplete(mapImageSize.h % MapChunkRows ? mapImageSize.h % MapChunkRows : MapChunkRows);
             return true;
         }
 
         /**
-         * @brief Compute Azimuthal map projections.
-         * @details This should be called by creating the std::future mAzimuthalProjection which will be
-         * completed when the projection is done, and return true if the projection was successful. This
-         * method only generates the Surfaces which are then used to create Textures that are displayed.
-         * The Surface to Texture conversion must happen on the main thread so locking is not an issue and
-         * the normal render cycle can continue as long as the last Texture is valid.
-         */
-        bool computeAzimuthalMaps() {
-            return azimuthalProjectionSet(mAbortFuture, mQthRad, mMapImgSize, mAzSurface, mMapSurface);
-        }
+         * @brief Load and project the maps for a generation.
+         * @details This is run on the WorkerPool. The maps are loaded, then the Azimuthal projections are
+         * computed in chunks of rows. Between chunks progress is counted and the work is abandoned if a newer
+         * generation has been requested. This method only generates the Surfaces which are then used to create
+         * Textures that are displayed. The Surface to Texture conversion must happen on the main thread.
+         * @param work The shared generation and progress.
+         * @param generation The generation.
+         * @param qthRad The Latitude and Longitude of the Azimuthal projection origin in Radians.
+         * @param mapPath The paths of the day and night maps.
+         * @return The ProjectedMaps, or an empty pointer if abandoned or the maps could not be loaded.
+         */
+        static std::shared_ptr<ProjectedMaps> projectMaps(std::shared_ptr<WorkProgress> work, uint32_t generation,
+                                                          GeoPosition qthRad,
+                                                          std::array<std::filesystem::path,2> mapPath);
 
-        /// The std::future result of computeAzimuthalMaps()
-        std::future<bool> mComputeAzimuthalMapsFuture;
+        /// The std::future result of projectMaps(). A superseded future is discarded, it does not block.
+        std::future<std::shared_ptr<ProjectedMaps>> mProjectedMapsFuture;
 
         /// True when base maps have not been loaded or projected for use.
         bool mMapProjectionsInvalid{true};
 
         /// The std::future result of setForegroundBackground()
-        std::future<bool> mForegroundBackgroundFuture;
+        std::future<std::shared_ptr<IlluminatedMaps>> mIlluminatedMapsFuture;
 
         /**
          * @brief Compute the sun illumination pattern.
          * @details This creates a background foreground map pair. The background is the night map, the
          * foreground is the day map which has had the Alpha channel modified to match the projected
-         * illumination from the sun. This method only generates the Surfaces which are then used to create
-         * Textures that are displayed. The Surface to Texture conversion must happen on the main thread so
-         * locking is not an issue and the normal render cycle can continue as long as the last Texture is valid.
+         * illumination from the sun. The illumination is computed once over the Mercator grid from separable
+         * row and column tables, then sampled for the Azimuthal map through the Azimuthal index. This method
+         * only generates the Surfaces which are then used to create Textures that are displayed.
+         * @param work The shared generation and progress.
+         * @param maps The projected maps to illuminate.
+         * @param generation The generation of the request, the work is abandoned if it is superseded.
+         * @return The IlluminatedMaps, or an empty pointer if abandoned.
          */
-        bool setForegroundBackground();
+        static std::shared_ptr<IlluminatedMaps> setForegroundBackground(std::shared_ptr<WorkProgress> work,
+                                                                        std::shared_ptr<ProjectedMaps> maps,
+                                                                        uint32_t generation);
+
+        /// Start illuminating the current projected maps.
+        void startIllumination();
+
+        /// Collect finished map generation work, start due illumination and report progress.
+        void processFutures();
+
+        /**
+         * @brief Run a function over ranges of map rows on the WorkerPool.
+         * @param rows The number of rows.
+         * @param rowFunction The function, called with the first and one past the last row of a range.
+         * @return True if all calls to rowFunction returned true.
+         */
+        static bool parallelRows(int rows, const std::function<bool(int, int)> &rowFunction);
 
         /**
          * @brief Convert a GeoPosition in radians to a map Position in pixels.
@@ -485,7 +588,7 @@ namespace rose {
 
         explicit MapProjection(std::shared_ptr<TimerTick> timerTick, std::filesystem::path& xdgDataPath);
 
-        ~MapProjection() override = default;
+        ~MapProjection() override;
 
         MapProjection(const MapProjection &) = delete;
 
@@ -514,16 +617,27 @@ namespace rose {
         void addedToContainer() override;
 
         /**
-         * @brief Add the selected maps to the current cache list and invoke a load if required.
+         * @brief Start generating the selected maps.
+         * @details Any map generation in progress is pre-empted and abandoned at the end of its current chunk.
          */
         void cacheCurrentMaps();
 
+        /// Signal transmitted on the main thread with rows completed and total rows while maps are generated.
+        MapProgressProtocol::signal_type mapProgress{};
+
         /**
          * Compute the sub-solar geographic coordinates, used in plotting the solar illumination.
          * @return a tuple with the latitude, longitude in radians
          */
         static std::tuple<double, double> subSolar();
 
+        /**
+         * Compute the sub-solar geographic coordinates at a specified time.
+         * @param epoch The time to compute the position for.
+         * @return a tuple with the latitude, longitude in radians
+         */
+        static std::tuple<double, double> subSolar(std::chrono::system_clock::time_point epoch);
+
         /*
          * @brief Accessor for Qth
          */
@@ -536,7 +650,7 @@ namespace rose {
          * @return Return true if valid, false otherwise.
          */
         bool mapProjectionsValid() const {
-            return !mMapProjectionsInvalid; // && !mForegroundBackgroundFuture.valid();
+            return !mMapProjectionsInvalid;
         }
 
         /**
@@ -627,6 +741,26 @@ namespace rose {
             } while (!g0.end);
         }
 
+        /**
+         * @brief Convert a sequence of GeoPositions in radians to screen Positions in a single call.
+         * @param geo The geographic positions in radians.
+         * @param mapPositions The container the screen positions are written to.
+         * @param mapRect The screen rectangle of the map.
+         */
+        void geoToMap(const std::vector<GeoPosition> &geo, std::vector<Position<MapPositionType>> &mapPositions,
+                      Rectangle mapRect) const;
+
+        /**
+         * @brief Draw a polyline through screen positions produced by the batched geoToMap().
+         * @details Segments which would cross a plotting gap of the current projection are skipped.
+         * @param context The graphics Context
+         * @param drawing The anti-aliased drawing context.
+         * @param mapRect The screen rectangle of the map.
+         * @param mapPositions The screen positions.
+         */
+        void drawMapPolyline(gm::Context &context, AntiAliasedDrawing &drawing, Rectangle mapRect,
+                             const std::vector<Position<MapPositionType>> &mapPositions) const;
+
         void drawInterpolate(gm::Context &context, AntiAliasedDrawing &drawing, Rectangle mapRect, GeoPosition &geo0,
                              GeoPosition &geo1) {
             auto r0 = geo0.toRadians();
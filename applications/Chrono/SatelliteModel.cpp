@@ -15,15 +15,18 @@ namespace rose {
     }
 
     void Ephemeris::readFile(const std::filesystem::path &filePath) {
-        clear();
-        mEphemerisSet.clear();
+        if (auto buffer = WebCache::readPayload(filePath); buffer)
+            readBuffer(buffer);
+        else
+            readBuffer(std::make_shared<const std::string>());
+    }
 
-        std::ifstream ephemFile(filePath.string());
-        std::string str((std::istreambuf_iterator<char>(ephemFile)),std::istreambuf_iterator<char>());
-        mEphemerisSet = str;
+    void Ephemeris::readBuffer(WebCachePayload buffer) {
+        clear();
+        mEphemerisSet = std::move(buffer);
 
-        auto first = mEphemerisSet.c_str();
-        auto last = mEphemerisSet.c_str() + mEphemerisSet.length();
+        auto first = mEphemerisSet->c_str();
+        auto last = mEphemerisSet->c_str() + mEphemerisSet->length();
 
         auto ptr = first;
         while (ptr < last) {
@@ -49,16 +52,17 @@ namespace rose {
                                                               "Ephemeris", std::chrono::hours{24},
                                                               CS_Ephem.begin(), CS_Ephem.end());
 
-        mCacheLoaded = WebCacheProtocol::createSlot();
-        mCacheLoaded->receiver = [&](uint32_t id,long status) {
+        mCacheLoaded = WebCachePayloadProtocol::createSlot();
+        mCacheLoaded->receiver = [&](uint32_t id, long status, const WebCachePayload &payload) {
             std::cout << __PRETTY_FUNCTION__ << ' ' << id << ' ' << status << '\n';
-            if (id == 1) {
-                auto path = mEphemerisCache->itemLocalPath(id);
-                mEphemeris.readFile(path);
+            if (id == 1 && payload) {
+                mEphemeris.readBuffer(payload);
             }
         };
-        mEphemerisCache->cacheLoaded.connect(mCacheLoaded);
+        mEphemerisCache->payloadLoaded.connect(mCacheLoaded);
 
+        mEphemerisCache->setServeStale(true);
+        mEphemerisCache->setPayloadDelivery(true);
         mEphemerisCache->fetchAll();
     }
 
@@ -96,12 +100,27 @@ namespace rose {
 
     void SatelliteObservation::passPrediction(uint maxCount, const std::string &favorite) {
         auto start = std::chrono::high_resolution_clock::now();
+        std::atomic_bool abort{false};
+        auto passData = predictPasses(maxCount, favorite, abort);
+
+        auto stop = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+        std::cout << __PRETTY_FUNCTION__ << " Time: " << duration.count() << "ms\n";
+
+        auto relative = time(nullptr);
+        for (auto &pass : passData) {
+            std::cout << pass.satellite.getName() << ": " << pass.passTimeString(relative) << '\n';
+        }
+    }
+
+    std::vector<SatellitePassData>
+    SatelliteObservation::predictPasses(uint maxCount, const std::string &favorite, const std::atomic_bool &abort) const {
         DateTime now{true};
         std::vector<SatellitePassData> passData{};
 
         // Initialize the pass prediction data
         std::transform(mConstellation.begin(), mConstellation.end(), std::back_inserter(passData),
-                       [&](Satellite &satellite) -> SatellitePassData {
+                       [&](const Satellite &satellite) -> SatellitePassData {
                            SatellitePassData pass;
                            pass.satellite = satellite;
                            pass.srchTime = now + -FINE_DT;
@@ -122,6 +141,9 @@ namespace rose {
         bool search = std::any_of(passData.begin(), passData.end(),
                     [&](SatellitePassData &pass) -> bool { return pass.search(now); });
         while (search) {
+            if (abort)
+                return std::vector<SatellitePassData>{};
+
             search = false;
             for (auto &pass : passData) {
                 pass.satellite.predict(pass.srchTime);
@@ -179,14 +201,10 @@ namespace rose {
             }
         }
 
-        std::cout << __PRETTY_FUNCTION__ << " Satellite count: " << passData.size() << '\n';
-
         passData.erase(std::remove_if(passData.begin(), passData.end(), [&](SatellitePassData &pass) -> bool {
             return !pass.goodPass(15.);
         }), passData.end());
 
-        std::cout << __PRETTY_FUNCTION__ << " Good pass count: " << passData.size() << '\n';
-
         std::sort(passData.begin(), passData.end(), [](SatellitePassData &p0, SatellitePassData &p1){
             return p0.riseTime < p1.riseTime;
         });
@@ -198,14 +216,33 @@ namespace rose {
             }), passData.end());
         }
 
-        auto stop = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-        std::cout << __PRETTY_FUNCTION__ << " Time: " << duration.count() << "ms\n";
+        return passData;
+    }
 
-        auto relative = time(nullptr);
-        for (auto &pass : passData) {
-            std::cout << pass.satellite.getName() << ": " << pass.passTimeString(relative) << '\n';
-        }
+    PassPredictor::~PassPredictor() {
+        cancel();
+    }
+
+    void PassPredictor::predict(const SatelliteObservation &observation, uint maxCount, const std::string &favorite) {
+        cancel();
+
+        mToken = CancellationToken{};
+        mPending = true;
+        WorkerPool::getWorkerPool().submitWithContinuation(
+                [observation, maxCount, favorite, token = mToken]() {
+                    return observation.predictPasses(maxCount, favorite, token.flag());
+                },
+                [this](const std::vector<SatellitePassData> &passData) {
+                    mPending = false;
+                    passesPredicted.transmit(passData);
+                },
+                TaskPriority::High, mToken);
+    }
+
+    void PassPredictor::cancel() {
+        // The worker polls the token and stops, and its continuation is not run.
+        mToken.cancel();
+        mPending = false;
     }
 
     std::string SatellitePassData::passTimeString(time_t relative) const {
@@ -11,9 +11,12 @@
 #include "WebCache.h"
 #include "Plan13.h"
 #include "Math.h"
+#include "WorkerPool.h"
 #include <memory>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <future>
 
 namespace rose {
 
@@ -22,18 +25,26 @@ namespace rose {
     static constexpr std::time_t LunarNewMoonEpoch{1618194720};
 
     /**
-     * @brief Calculate the current phase of the moon in days between [0..2*M_PI].
+     * @brief Calculate the phase of the moon at a specified time in days between [0..2*M_PI].
+     * @param epoch The time to compute the phase for.
      * @return The moon phase.
      */
-    inline double MoonPhase() {
+    inline double MoonPhase(std::chrono::system_clock::time_point epoch) {
         std::chrono::system_clock::time_point newEpoch = std::chrono::system_clock::from_time_t(LunarNewMoonEpoch);
-        std::chrono::system_clock::time_point epoch = std::chrono::system_clock::now();
         auto moonAge = std::chrono::duration_cast<std::chrono::milliseconds>(epoch - newEpoch);
         auto phase = static_cast<double>((moonAge % LunarMonthMilliseconds).count()) /
                      static_cast<double>(LunarMonthMilliseconds.count()) * 2. * M_PI;
         return phase;
     }
 
+    /**
+     * @brief Calculate the current phase of the moon in days between [0..2*M_PI].
+     * @return The moon phase.
+     */
+    inline double MoonPhase() {
+        return MoonPhase(std::chrono::system_clock::now());
+    }
+
     class ClearSkyEphemeris : public WebCache {
     public:
         ClearSkyEphemeris() = delete;
@@ -78,7 +89,7 @@ namespace rose {
      */
     class Ephemeris : public std::map<std::string_view, std::array<std::string_view,3>> {
     protected:
-        std::string mEphemerisSet{};
+        WebCachePayload mEphemerisSet{};
 
     public:
         using iterator = std::map<std::string_view, std::array<std::string_view,3>>::iterator;
@@ -89,6 +100,13 @@ namespace rose {
 
         void readFile(const std::filesystem::path &filePath);
 
+        /**
+         * @brief Parse an ephemeris set held in memory.
+         * @details The buffer is shared, not copied, the map entries are views into it.
+         * @param buffer The ephemeris set.
+         */
+        void readBuffer(WebCachePayload buffer);
+
     };
 
     /**
@@ -99,7 +117,7 @@ namespace rose {
     protected:
         std::unique_ptr<ClearSkyEphemeris> mEphemerisCache{};
 
-        WebCacheProtocol::slot_type mCacheLoaded{};
+        WebCachePayloadProtocol::slot_type mCacheLoaded{};
 
         Ephemeris mEphemeris{};
 
@@ -119,6 +137,14 @@ namespace rose {
 
         SatelliteModel& operator=(SatelliteModel&&) = delete;
 
+        /**
+         * @brief Refresh the ephemeris cache when items expire.
+         * @param timerTick The source of minute signals.
+         */
+        void setRefreshSchedule(std::shared_ptr<TimerTick> timerTick) {
+            mEphemerisCache->setRefreshSchedule(std::move(timerTick), std::chrono::minutes{30});
+        }
+
         auto begin() {
             return mEphemeris.begin();
         }
@@ -136,6 +162,8 @@ namespace rose {
         }
     };
 
+    struct SatellitePassData;
+
     class SatelliteObservation {
     protected:
         Observer mObserver{};
@@ -153,6 +181,16 @@ namespace rose {
 
         void passPrediction(uint maxCount, const std::string &favorite);
 
+        /**
+         * @brief Predict the next passes of the satellites in the constellation.
+         * @param maxCount The maximum number of passes to return.
+         * @param favorite The name of a satellite to keep in the result even if it falls beyond maxCount.
+         * @param abort A flag which, when set, causes the prediction to be abandoned.
+         * @return The passes found sorted by rise time, empty if the prediction was aborted.
+         */
+        [[nodiscard]] std::vector<SatellitePassData>
+        predictPasses(uint maxCount, const std::string &favorite, const std::atomic_bool &abort) const;
+
         [[nodiscard]] const Observer& observer() const {
             return mObserver;
         }
@@ -221,5 +259,55 @@ namespace rose {
             lonRad = std::get<1>(geo);
         }
     };
-}
 
+    /// Protocol for delivering a set of pass predictions sorted by rise time.
+    using PassPredictionProtocol = Protocol<const std::vector<SatellitePassData>&>;
+
+    /**
+     * @class PassPredictor
+     * @brief Run satellite pass prediction on the WorkerPool.
+     * @details Results are delivered on the main thread, as a WorkerPool continuation, through the
+     * passesPredicted signal. Starting a new prediction, or destroying the PassPredictor, cancels any
+     * prediction still running.
+     */
+    class PassPredictor {
+    protected:
+        /// The cancellation token of the prediction in progress.
+        CancellationToken mToken{};
+
+        /// True while a prediction is in progress.
+        bool mPending{false};
+
+    public:
+        PassPredictor() = default;
+
+        ~PassPredictor();
+
+        PassPredictor(const PassPredictor&) = delete;
+
+        PassPredictor(PassPredictor&&) = delete;
+
+        PassPredictor& operator=(const PassPredictor&) = delete;
+
+        PassPredictor& operator=(PassPredictor&&) = delete;
+
+        /**
+         * @brief Start a pass prediction, cancelling any prediction in progress.
+         * @param observation The observer and constellation to predict for, copied for use by the worker.
+         * @param maxCount The maximum number of passes to return.
+         * @param favorite The name of a satellite to keep in the result even if it falls beyond maxCount.
+         */
+        void predict(const SatelliteObservation &observation, uint maxCount, const std::string &favorite);
+
+        /// Cancel the prediction in progress, if any. No result will be delivered for it.
+        void cancel();
+
+        /// True if a prediction is in progress.
+        [[nodiscard]] bool pending() const noexcept {
+            return mPending;
+        }
+
+        /// Signal transmitted on the main thread when a prediction completes.
+        PassPredictionProtocol::signal_type passesPredicted{};
+    };
+}
@@ -245,6 +245,7 @@ struct Chrono : public Application {
 
     void build() {
         timerTick = std::make_shared<TimerTick>();
+        SatelliteModel::getModel().setRefreshSchedule(timerTick);
 
         Environment &environment{Environment::getEnvironment()};
 
@@ -285,6 +286,20 @@ int main(int argc, char **argv) {
 
     application.initialize(environment.appName(), Size{800, 480});
 
+    // Log frames which exceed the frame budget when the library is built with ROSE_FRAME_TIMING.
+    auto frameOverrunSlot = FrameOverrunProtocol::createSlot();
+    if constexpr (FrameTiming::Enabled) {
+        frameOverrunSlot->receiver = [](uint32_t frame, FrameDuration total, FramePhaseTimes phases) {
+            std::cerr << "Frame " << frame << " over budget " << total.count() << "us:";
+            for (size_t phase = 0; phase < FramePhaseCount; ++phase)
+                if (phases[phase].count())
+                    std::cerr << ' ' << framePhaseName(static_cast<FramePhase>(phase)) << ' '
+                              << phases[phase].count() << "us";
+            std::cerr << '\n';
+        };
+        application.frameTiming().frameOverrun.connect(frameOverrunSlot);
+    }
+
     ImageStore &imageStore{ImageStore::getStore(application.context())};
     application.build();
     application.run();
@@ -327,6 +327,12 @@ namespace rose {
         mGraphicsModel.redrawBackground();
     }
 
+    void Application::layout(const std::shared_ptr<Window> &window) {
+        auto windowRect = window->layout(mGraphicsModel.context(), mGraphicsModel.screenRectangle());
+        window->setScreenRectangle(windowRect);
+        mGraphicsModel.redrawWindow(window);
+    }
+
     std::shared_ptr<Widget> Application::pointerWidget(const Position<int>& position) {
         for (auto &content : ReverseContainerView(*mScreen)) {
             if (auto window = std::dynamic_pointer_cast<Window>(content); window) {
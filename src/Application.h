@@ -218,10 +218,33 @@ namespace rose {
 
         gm::Context& context() { return mGraphicsModel.context(); }
 
+        /// Access the per phase frame timing, see gm::GraphicsModel::frameTiming().
+        FrameTiming& frameTiming() { return mGraphicsModel.frameTiming(); }
+
+        /// Select the frame pacing policy, call before initialize(), see gm::GraphicsModel::setFramePacing().
+        void setFramePacing(gm::FramePacing pacing, int frameRate = 0) {
+            mGraphicsModel.setFramePacing(pacing, frameRate);
+        }
+
+        /// Access the frame pacer, see gm::FramePacer.
+        gm::FramePacer& framePacer() { return mGraphicsModel.framePacer(); }
+
+        /// Compose frames on a back buffer, see gm::GraphicsModel::setCompositedAnimation().
+        void setCompositedAnimation(bool compositedAnimation) {
+            mGraphicsModel.setCompositedAnimation(compositedAnimation);
+        }
+
         std::shared_ptr<Screen>& screen() { return mScreen; }
 
         void layout();
 
+        /**
+         * @brief Layout one Window, such as a PopupWindow which has just been added to the Screen.
+         * @details Only the base texture of the Window is generated again.
+         * @param window The Window.
+         */
+        void layout(const std::shared_ptr<Window> &window);
+
         std::shared_ptr<Widget> pointerWidget(const Position<int>& position);
 
         [[nodiscard]] Padding windowBorders() const noexcept {
@@ -254,6 +277,24 @@ namespace rose {
             mGraphicsModel.redrawBackground();
         }
 
+        /// Generate the base texture of one Window again, see gm::GraphicsModel::redrawWindow().
+        void redrawWindow(const std::shared_ptr<Window> &window) {
+            mGraphicsModel.redrawWindow(window);
+        }
+
+        /// Compose the screen from the existing Window base textures, see gm::GraphicsModel::recomposeScreen().
+        void recomposeScreen() {
+            mGraphicsModel.recomposeScreen();
+        }
+
+        /**
+         * @brief Record the drawing of each frame in a command list and submit it batched by texture and state.
+         * @param deferredRendering True to enable.
+         */
+        void setDeferredRendering(bool deferredRendering) {
+            mGraphicsModel.setDeferredRendering(deferredRendering);
+        }
+
         [[nodiscard]] bool keyboardFound() const noexcept {
             return mKeyboardFound;
         }
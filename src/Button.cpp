@@ -32,7 +32,7 @@ namespace rose {
         if (mButtonSemantics) {
             mButtonSemantics->setButtonDisplayCallback([&](ButtonDisplayState buttonDisplayState) {
                 buttonDisplayStateChange(buttonDisplayState);
-                getApplication().redrawBackground();
+                getApplication().redrawWindow(getWindow());
             });
 
 //            mButtonSemantics->setButtonStateChangeCallback([&](ButtonStateChange buttonStateChange) {
@@ -69,7 +69,7 @@ namespace rose {
     void TextButton::draw(gm::Context &context, const Position<int>& containerPosition) {
         Frame::draw(context, containerPosition);
 
-        if (!mTexture) {
+        if (!mTexture || !mTextureValid) {
             createTextureBlended(context);
         }
 
@@ -120,7 +120,7 @@ namespace rose {
         if (mButtonSemantics) {
             mButtonSemantics->setButtonDisplayCallback([&](ButtonDisplayState buttonDisplayState) {
                 buttonDisplayStateChange(buttonDisplayState);
-                getApplication().redrawBackground();
+                getApplication().redrawWindow(getWindow());
             });
 
             mButtonSemantics->setButtonStateChangeCallback([&](ButtonStateChange buttonStateChange) {
@@ -188,7 +188,7 @@ namespace rose {
 
     void ImageButton::setImage(ImageId imageId) {
         mImageId = imageId;
-        getApplication().redrawBackground();
+        getApplication().redrawWindow(getWindow());
     }
 
     ImageButtonLayoutManager::ImageButtonLayoutManager(ImageButton &imageButton) : mImageButton(imageButton) {
@@ -29,16 +29,19 @@ namespace rose {
                                     Size frameSize) {
         auto trimColor = color;
         trimColor.a() = 0.f;
-        auto trimCorner = [&surface, &trimColor](int x0, int y0, int xw, int yh, int R2) {
-            for (int x = x0; x0 < xw ? x < xw : x > xw; x0 < xw ? ++x : --x)
-                for (int y = y0; y0 < yh ? y < yh : y > yh; y0 < yh ? ++y : --y) {
+        auto trimPixel = gm::mapRGBA(surface.get()->format, trimColor);
+        auto trimCorner = [&surface, trimPixel](int x0, int y0, int xw, int yh, int R2) {
+            for (int y = y0; y0 < yh ? y < yh : y > yh; y0 < yh ? ++y : --y) {
+                auto row = surface.row(y);
+                int yr = yh - y;
+                for (int x = x0; x0 < xw ? x < xw : x > xw; x0 < xw ? ++x : --x) {
                     int xr = xw - x;
-                    int yr = yh - y;
                     int r2 = xr * xr + yr * yr;
                     if (r2 > R2) {
-                        surface.pixel(x, y) = gm::mapRGBA(surface.get()->format, trimColor);
+                        row[x] = trimPixel;
                     }
                 }
+            }
         };
 
         cornerSize.w /= 2;
@@ -250,6 +253,7 @@ namespace rose {
         }
 
         auto texture = surface.toTexture(context);
+        texture.setCategory(gm::TextureCategory::Frame);
         return std::move(texture);
     }
 
@@ -261,6 +265,7 @@ namespace rose {
 
         texture.setBlendMode(SDL_BLENDMODE_NONE);
         mBorder = gm::Texture{context, dst.size()};
+        mBorder.setCategory(gm::TextureCategory::Frame);
 
         gm::RenderTargetGuard renderTargetGuard(context, mBorder);
         context.renderCopy(texture);
@@ -304,6 +309,7 @@ namespace rose {
     gm::Texture
     FrameElements::createBackgroundMask(gm::Context &context, const Size size, int frameWidth, bool roundCorners) {
         gm::Texture mask{context, size};
+        mask.setCategory(gm::TextureCategory::Frame);
         mask.setBlendMode(SDL_BLENDMODE_NONE);
         ImageStore &is{ImageStore::getStore()};
 
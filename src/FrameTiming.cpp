@@ -0,0 +1,102 @@
+/**
+ * @file FrameTiming.cpp
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-07-01
+ */
+
+#include <algorithm>
+#include <numeric>
+#include "FrameTiming.h"
+
+namespace rose {
+
+    const char *framePhaseName(FramePhase phase) {
+        switch (phase) {
+            case FramePhase::Events:
+                return "Events";
+            case FramePhase::FrameSignal:
+                return "FrameSignal";
+            case FramePhase::PopupPrune:
+                return "PopupPrune";
+            case FramePhase::BaseTexture:
+                return "BaseTexture";
+            case FramePhase::Compose:
+                return "Compose";
+            case FramePhase::Animate:
+                return "Animate";
+            case FramePhase::Present:
+                return "Present";
+            default:
+                return "Unknown";
+        }
+    }
+
+    FrameTimeHistory::FrameTimeHistory(size_t capacity) : mSamples(std::max(capacity, static_cast<size_t>(1))) {}
+
+    void FrameTimeHistory::add(FrameDuration duration) {
+        mSamples[mNext] = duration;
+        mNext = (mNext + 1) % mSamples.size();
+        mCount = std::min(mCount + 1, mSamples.size());
+    }
+
+    void FrameTimeHistory::clear() {
+        mNext = 0;
+        mCount = 0;
+    }
+
+    FrameTimeStatistics FrameTimeHistory::statistics() const {
+        FrameTimeStatistics statistics{};
+        statistics.count = mCount;
+        if (!mCount)
+            return statistics;
+
+        std::vector<FrameDuration> samples{mSamples.begin(), mSamples.begin() + mCount};
+        auto percentile = [&samples](size_t percent) {
+            auto nth = samples.begin() + std::min(samples.size() - 1, samples.size() * percent / 100);
+            std::nth_element(samples.begin(), nth, samples.end());
+            return *nth;
+        };
+
+        statistics.p50 = percentile(50);
+        statistics.p95 = percentile(95);
+        statistics.max = *std::max_element(samples.begin(), samples.end());
+        statistics.mean = std::accumulate(samples.begin(), samples.end(), FrameDuration{}) /
+                          static_cast<FrameDuration::rep>(mCount);
+        return statistics;
+    }
+
+    FrameTiming::FrameTiming(size_t window) : mPhases(FramePhaseCount, FrameTimeHistory{window}),
+                                              mTotal(window) {}
+
+    void FrameTiming::endFrame(uint32_t frame) {
+        FrameDuration total{};
+        for (size_t phase = 0; phase < FramePhaseCount; ++phase) {
+            mPhases[phase].add(mCurrent[phase]);
+            total += mCurrent[phase];
+        }
+        mTotal.add(total);
+        mLast = mCurrent;
+        mCurrent.fill(FrameDuration{});
+        ++mFrameCount;
+
+        if (mBudget.count() && total > mBudget) {
+            ++mOverrunCount;
+            frameOverrun.transmit(frame, total, mLast);
+        }
+    }
+
+    void FrameTiming::reset() {
+        for (auto &phase : mPhases)
+            phase.clear();
+        mTotal.clear();
+        mCurrent.fill(FrameDuration{});
+        mLast.fill(FrameDuration{});
+        mFrameCount = 0;
+        mOverrunCount = 0;
+    }
+
+    FrameTimeStatistics FrameTiming::statistics(FramePhase phase) const {
+        return mPhases.at(static_cast<size_t>(phase)).statistics();
+    }
+}
@@ -0,0 +1,211 @@
+/**
+ * @file FrameTiming.h
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-07-01
+ * @brief Per phase frame timing with rolling statistics and frame budget overrun reporting.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Signals.h"
+
+namespace rose {
+
+    /**
+     * @enum FramePhase
+     * @brief The phases of a GraphicsModel frame.
+     */
+    enum class FramePhase : size_t {
+        Events,         ///< SDL event polling and dispatch.
+        FrameSignal,    ///< Slots connected to CommonSignals::frameSignal.
+        PopupPrune,     ///< Removing closed PopupWindows from the Screen.
+        BaseTexture,    ///< Generating Window base textures.
+        Compose,        ///< Clearing the frame and drawing the base textures.
+        Animate,        ///< Animator::animate().
+        Present,        ///< Submitting deferred commands and presenting the frame.
+        Count,          ///< The number of phases.
+    };
+
+    /// The number of phases in a frame.
+    static constexpr size_t FramePhaseCount = static_cast<size_t>(FramePhase::Count);
+
+    /// The resolution of frame timing.
+    using FrameDuration = std::chrono::microseconds;
+
+    /// The time spent in each phase of a frame, indexed by FramePhase.
+    using FramePhaseTimes = std::array<FrameDuration, FramePhaseCount>;
+
+    /// Protocol for reporting a frame which exceeded the frame budget: frame, total time, phase times.
+    using FrameOverrunProtocol = Protocol<uint32_t, FrameDuration, FramePhaseTimes>;
+
+    /**
+     * @brief Get the name of a frame phase.
+     * @param phase The phase.
+     * @return The name.
+     */
+    const char *framePhaseName(FramePhase phase);
+
+    /**
+     * @struct FrameTimeStatistics
+     * @brief Statistics over the frames in a FrameTimeHistory.
+     */
+    struct FrameTimeStatistics {
+        size_t count{0};            ///< The number of frames.
+        FrameDuration p50{};        ///< The median.
+        FrameDuration p95{};        ///< The 95th percentile.
+        FrameDuration max{};        ///< The maximum.
+        FrameDuration mean{};       ///< The mean.
+    };
+
+    /**
+     * @class FrameTimeHistory
+     * @brief A rolling window of the most recent frame times.
+     */
+    class FrameTimeHistory {
+    protected:
+        std::vector<FrameDuration> mSamples{};  ///< The ring buffer of samples.
+        size_t mNext{0};                        ///< The index of the next sample.
+        size_t mCount{0};                       ///< The number of valid samples.
+
+    public:
+        /**
+         * @brief Constructor.
+         * @param capacity The number of frames in the window.
+         */
+        explicit FrameTimeHistory(size_t capacity);
+
+        /// Add a sample, replacing the oldest if the window is full.
+        void add(FrameDuration duration);
+
+        /// Discard all samples.
+        void clear();
+
+        /// Compute statistics over the samples in the window.
+        [[nodiscard]] FrameTimeStatistics statistics() const;
+
+        /// The number of samples in the window.
+        [[nodiscard]] size_t size() const { return mCount; }
+    };
+
+    /**
+     * @class FrameTiming
+     * @brief Accumulate the time spent in each phase of a frame, keep rolling statistics, and signal frames
+     * which exceed the frame budget.
+     * @details Phases are timed by PhaseTimer objects which only measure anything when Rose is configured with
+     * the ROSE_FRAME_TIMING option, otherwise they compile to nothing. Statistics are computed on request, the
+     * per frame cost is one clock read at each end of each phase and a store per phase.
+     */
+    class FrameTiming {
+    public:
+        /// True when the library is built with frame timing instrumentation.
+#ifdef ROSE_FRAME_TIMING
+        static constexpr bool Enabled = true;
+#else
+        static constexpr bool Enabled = false;
+#endif
+
+        /// The default number of frames in the statistics window.
+        static constexpr size_t DefaultWindow = 256;
+
+        /// The default frame budget, the 30Hz default frame interval. GraphicsModel sets the budget to the paced
+        /// frame interval.
+        static constexpr FrameDuration DefaultBudget{33333};
+
+        /**
+         * @class PhaseTimer
+         * @brief Time a scope and add it to a FrameTiming phase.
+         */
+        class PhaseTimer {
+#ifdef ROSE_FRAME_TIMING
+            FrameTiming &mTiming;
+            FramePhase mPhase;
+            std::chrono::steady_clock::time_point mStart;
+
+        public:
+            PhaseTimer(FrameTiming &timing, FramePhase phase)
+                    : mTiming(timing), mPhase(phase), mStart(std::chrono::steady_clock::now()) {}
+
+            ~PhaseTimer() {
+                mTiming.record(mPhase, std::chrono::duration_cast<FrameDuration>(
+                        std::chrono::steady_clock::now() - mStart));
+            }
+#else
+        public:
+            PhaseTimer(FrameTiming &, FramePhase) {}
+#endif
+
+            PhaseTimer(const PhaseTimer &) = delete;
+
+            PhaseTimer(PhaseTimer &&) = delete;
+
+            PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+            PhaseTimer &operator=(PhaseTimer &&) = delete;
+        };
+
+    protected:
+        FramePhaseTimes mCurrent{};                 ///< The phase times of the frame in progress.
+        FramePhaseTimes mLast{};                    ///< The phase times of the last completed frame.
+        std::vector<FrameTimeHistory> mPhases{};    ///< The rolling history of each phase.
+        FrameTimeHistory mTotal;                    ///< The rolling history of total frame time.
+        FrameDuration mBudget{DefaultBudget};       ///< The frame budget, zero to disable overrun checks.
+        size_t mFrameCount{0};                      ///< Frames completed since the last reset.
+        size_t mOverrunCount{0};                    ///< Frames over budget since the last reset.
+
+    public:
+        /**
+         * @brief Constructor.
+         * @param window The number of frames in the statistics window.
+         */
+        explicit FrameTiming(size_t window = DefaultWindow);
+
+        /**
+         * @brief Add time to a phase of the frame in progress.
+         * @param phase The phase.
+         * @param duration The time spent.
+         */
+        void record(FramePhase phase, FrameDuration duration) {
+            mCurrent[static_cast<size_t>(phase)] += duration;
+        }
+
+        /**
+         * @brief Complete the frame in progress.
+         * @details The phase times are added to the statistics. If the total exceeds the budget frameOverrun
+         * is transmitted.
+         * @param frame The frame number.
+         */
+        void endFrame(uint32_t frame);
+
+        /// Discard all statistics and counts.
+        void reset();
+
+        /// Set the frame budget, zero disables overrun checks.
+        void setBudget(FrameDuration budget) { mBudget = budget; }
+
+        /// Get the frame budget.
+        [[nodiscard]] FrameDuration budget() const { return mBudget; }
+
+        /// Get the statistics of a phase over the window.
+        [[nodiscard]] FrameTimeStatistics statistics(FramePhase phase) const;
+
+        /// Get the statistics of total frame time over the window.
+        [[nodiscard]] FrameTimeStatistics frameStatistics() const { return mTotal.statistics(); }
+
+        /// Get the phase times of the last completed frame.
+        [[nodiscard]] const FramePhaseTimes &lastFrame() const { return mLast; }
+
+        /// Get the number of frames completed since the last reset.
+        [[nodiscard]] size_t frameCount() const { return mFrameCount; }
+
+        /// Get the number of frames over budget since the last reset.
+        [[nodiscard]] size_t overrunCount() const { return mOverrunCount; }
+
+        /// Transmitted by endFrame() when a frame exceeds the budget.
+        FrameOverrunProtocol::signal_type frameOverrun{};
+    };
+}
@@ -6,6 +6,7 @@
  */
 
 #include <iostream>
+#include <thread>
 #include "Animation.h"
 #include "GraphicsModel.h"
 #include "Texture.h"
@@ -13,49 +14,173 @@
 #include "Settings.h"
 #include "Types.h"
 #include "Popup.h"
+#include "Surface.h"
 
 #include <SDL.h>
 #include <SDL_ttf.h>
 
 namespace rose::gm {
 
-    /**
-     * @class Fps
-     * @brief Throttle the application to limit the number of frames per second the scene is refreshed.
-     */
-    class Fps {
-    public:
-        /**
-         * @brief Constructor
-         * @param tickInterval The number of SDL ticks desired between frames.
-         */
-        explicit Fps(int tickInterval = 30)
-                : m_tickInterval(tickInterval), m_nextTime(SDL_GetTicks() + tickInterval) {
+    void FramePacer::start(FramePacing pacing, bool vsync, int refreshRate, int frameRate) {
+        mPacing = pacing;
+        mVSync = vsync && pacing != FramePacing::FixedRate;
+        mFrequency = std::max(SDL_GetPerformanceFrequency(), static_cast<Uint64>(1));
+        if (refreshRate <= 0)
+            refreshRate = DefaultRefreshRate;
+        if (frameRate <= 0)
+            frameRate = DefaultFrameRate;
+        mRefreshPeriod = mFrequency / static_cast<uint64_t>(refreshRate);
+        mFixedInterval = mFrequency / static_cast<uint64_t>(frameRate);
+        mMinDivisor = static_cast<uint32_t>(std::max(1L, std::lround(static_cast<double>(refreshRate) / frameRate)));
+        mDivisor = mMinDivisor;
+        mWindowFrames = mWindowMissed = mCleanFrames = 0;
+        mProbeFrames = ProbeFrames;
+        mProbing = false;
+        mLastFrame = SDL_GetPerformanceCounter();
+        mDeadline = mLastFrame;
+        resetStatistics();
+    }
+
+    uint64_t FramePacer::interval() const {
+        switch (mPacing) {
+            case FramePacing::FixedRate:
+                return mFixedInterval;
+            case FramePacing::Adaptive:
+            case FramePacing::VSyncOnly:
+            default:
+                return mRefreshPeriod * mDivisor;
         }
+    }
 
-        /**
-         * @brief Wait until the next frame interval.
-         */
-        void next() {
-            SDL_Delay(getTicksToNextFrame());
+    void FramePacer::waitUntil(uint64_t target) const {
+        // SDL_Delay sleeps in whole milliseconds and may oversleep, so sleep until about a millisecond before
+        // the target then yield until it arrives.
+        auto millisecond = mFrequency / 1000;
+        for (auto now = SDL_GetPerformanceCounter(); now < target; now = SDL_GetPerformanceCounter()) {
+            if (target - now > 2 * millisecond)
+                SDL_Delay(static_cast<Uint32>((target - now) / millisecond - 1));
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void FramePacer::adapt(uint64_t missed) {
+        if (mPacing != FramePacing::Adaptive)
+            return;
+
+        mWindowMissed += static_cast<uint32_t>(std::min(missed, static_cast<uint64_t>(AdaptWindow)));
+        mCleanFrames = missed ? 0 : mCleanFrames + 1;
 
-            m_nextTime += m_tickInterval;
+        // A probe which survives two windows has succeeded.
+        if (mProbing && ++mSinceProbe > 2 * AdaptWindow) {
+            mProbing = false;
+            mProbeFrames = ProbeFrames;
         }
 
-    private:
-        const int m_tickInterval;       ///< The number of SDL ticks per frame.
-        Uint32 m_nextTime;              ///< The time of the next frame start.
+        if (++mWindowFrames >= AdaptWindow) {
+            if (mWindowMissed > MissedLimit && mDivisor < mMinDivisor + MaxDivisor) {
+                ++mDivisor;
+                mCleanFrames = 0;
+                // A failed probe waits longer before the next one.
+                if (mProbing && mProbeFrames < ProbeFrames * 8)
+                    mProbeFrames *= 2;
+                mProbing = false;
+            }
+            mWindowFrames = mWindowMissed = 0;
+        }
 
-        /**
-         * Compute the number of ticks to wait until the next frame time.
-         * @return The number of ticks to wait
-         */
-        [[nodiscard]] Uint32 getTicksToNextFrame() const {
-            Uint32 now = SDL_GetTicks();
+        if (mDivisor > mMinDivisor && mCleanFrames >= mProbeFrames) {
+            --mDivisor;
+            mCleanFrames = 0;
+            mProbing = true;
+            mSinceProbe = 0;
+        }
+        mStatistics.divisor = mDivisor;
+    }
 
-            return (m_nextTime <= now) ? 0 : m_nextTime - now;
+    void FramePacer::next(bool presented) {
+        auto now = SDL_GetPerformanceCounter();
+        auto frameInterval = interval();
+
+        auto elapsed = now - mLastFrame;
+        uint64_t missed = 0;
+        if (elapsed > frameInterval + frameInterval / 2)
+            missed = (elapsed + frameInterval / 2) / frameInterval - 1;
+
+        ++mStatistics.frames;
+        mStatistics.missed += missed;
+        mStatistics.lastInterval = static_cast<double>(elapsed) / static_cast<double>(mFrequency);
+        mStatistics.maxInterval = std::max(mStatistics.maxInterval, mStatistics.lastInterval);
+        mLastFrame = now;
+        adapt(missed);
+        frameInterval = interval();
+
+        if (mVSync && presented) {
+            // The present waited for the vertical blank. To present on every n-th refresh start the next frame
+            // just after the (n-1)th following blank.
+            mDeadline = now + frameInterval;
+            if (frameInterval > mRefreshPeriod)
+                waitUntil(now + frameInterval - mRefreshPeriod + mRefreshPeriod / 4);
+        } else {
+            // Advance the deadline by whole intervals so timer error does not accumulate, but do not try to
+            // catch up on intervals which have already passed.
+            mDeadline += frameInterval;
+            if (mDeadline < now)
+                mDeadline = now;
+            waitUntil(mDeadline);
         }
-    };
+    }
+
+    Context *Context::sRecordingContext{nullptr};
+
+    /// Bounds which overlap everything, for copies to the whole target.
+    static constexpr SDL_Rect UnboundedRect{-(1 << 20), -(1 << 20), 1 << 21, 1 << 21};
+
+    static bool overlap(const SDL_Rect &r0, const SDL_Rect &r1) {
+        return r0.x < r1.x + r1.w && r1.x < r0.x + r0.w && r0.y < r1.y + r1.h && r1.y < r0.y + r0.h;
+    }
+
+    static SDL_Rect unite(const SDL_Rect &r0, const SDL_Rect &r1) {
+        auto x = std::min(r0.x, r1.x);
+        auto y = std::min(r0.y, r1.y);
+        return SDL_Rect{x, y, std::max(r0.x + r0.w, r1.x + r1.w) - x, std::max(r0.y + r0.h, r1.y + r1.h) - y};
+    }
+
+    /// Bound a rotated destination by a square around the rotation center large enough for any angle.
+    static SDL_Rect rotatedBounds(const SDL_Rect &dst, bool hasCenter, const SDL_Point &center) {
+        auto cx = dst.x + (hasCenter ? center.x : dst.w / 2);
+        auto cy = dst.y + (hasCenter ? center.y : dst.h / 2);
+        auto r = static_cast<int>(std::ceil(std::hypot(std::max(center.x, dst.w), std::max(center.y, dst.h))));
+        return SDL_Rect{cx - r, cy - r, 2 * r + 1, 2 * r + 1};
+    }
+
+    /// Replace overlapping rectangles with their union until no two overlap.
+    static void mergeRectangles(std::vector<SDL_Rect> &rectangles) {
+        for (bool merged = true; merged;) {
+            merged = false;
+            for (size_t i = 0; i < rectangles.size(); ++i) {
+                for (size_t j = i + 1; j < rectangles.size();) {
+                    if (overlap(rectangles[i], rectangles[j])) {
+                        rectangles[i] = unite(rectangles[i], rectangles[j]);
+                        rectangles.erase(rectangles.begin() + static_cast<long>(j));
+                        merged = true;
+                    } else {
+                        ++j;
+                    }
+                }
+            }
+        }
+    }
+
+    /// True if two commands may be issued in one batch.
+    static bool batchable(const RenderCommand &c0, const RenderCommand &c1) {
+        bool copy0 = c0.kind == RenderCommand::Copy || c0.kind == RenderCommand::CopyEx;
+        bool copy1 = c1.kind == RenderCommand::Copy || c1.kind == RenderCommand::CopyEx;
+        if (copy0 != copy1 || (!copy0 && c0.kind != c1.kind))
+            return false;
+        return c0.texture == c1.texture && c0.color == c1.color && c0.blendMode == c1.blendMode &&
+               c0.clip == c1.clip;
+    }
 
     int Context::renderCopy(const Texture &texture, Rectangle dst) {
         SDL_Rect dstRect{dst.x, dst.y, dst.w, dst.h};
@@ -64,6 +189,16 @@ namespace rose::gm {
             return -1;
         }
 
+        if (mRecording) {
+            RenderCommand command{};
+            command.texture = texture.get();
+            command.hasDst = true;
+            command.dst = dstRect;
+            return recordCopy(command);
+        }
+
+        damage(dstRect);
+        countDraw(texture.get());
         return SDL_RenderCopy(mRenderer.get(), texture.get(), nullptr, &dstRect);
     }
 
@@ -74,6 +209,18 @@ namespace rose::gm {
             std::cerr << __PRETTY_FUNCTION__ << "Invalid Texture.\n";
             return -1;
         }
+
+        if (mRecording) {
+            RenderCommand command{};
+            command.texture = texture.get();
+            command.hasSrc = command.hasDst = true;
+            command.src = srcRect;
+            command.dst = dstRect;
+            return recordCopy(command);
+        }
+
+        damage(dstRect);
+        countDraw(texture.get());
         return SDL_RenderCopy(mRenderer.get(), texture.get(), &srcRect, &dstRect);
     }
 
@@ -82,6 +229,15 @@ namespace rose::gm {
             std::cerr << __PRETTY_FUNCTION__ << "Invalid Texture.\n";
             return -1;
         }
+
+        if (mRecording) {
+            RenderCommand command{};
+            command.texture = texture.get();
+            return recordCopy(command);
+        }
+
+        damage(UnboundedRect);
+        countDraw(texture.get());
         return SDL_RenderCopy(mRenderer.get(), texture.get(), nullptr, nullptr);
     }
 
@@ -92,53 +248,455 @@ namespace rose::gm {
     }
 
     int Context::renderCopyEx(Texture &texture, Rectangle src, Rectangle dst, double angle, RenderFlip renderFlip,
-                               std::optional<Position<int>> point) const {
+                               std::optional<Position<int>> point) {
         SDL_Rect srcRect{src.x, src.y, src.w, src.h};
         SDL_Rect dstRect{dst.x, dst.y, dst.w, dst.h};
+        if (mRecording) {
+            RenderCommand command{};
+            command.kind = RenderCommand::CopyEx;
+            command.texture = texture.get();
+            command.hasSrc = command.hasDst = true;
+            command.src = srcRect;
+            command.dst = dstRect;
+            command.angle = angle;
+            command.flip = renderFlip.mFlip;
+            if (point) {
+                command.hasCenter = true;
+                command.center = SDL_Point{point->x, point->y};
+            }
+            return recordCopy(command);
+        }
+
+        if (mTrackDamage) {
+            SDL_Point center{point ? point->x : 0, point ? point->y : 0};
+            damage(angle != 0. ? rotatedBounds(dstRect, point.has_value(), center) : dstRect);
+        }
+        countDraw(texture.get());
         if (point) {
             SDL_Point sdlPoint;
             sdlPoint.x = point->x;
             sdlPoint.y = point->y;
-            return SDL_RenderCopyEx(get(), texture.get(), &srcRect, &dstRect, angle, &sdlPoint, renderFlip.mFlip);
+            return SDL_RenderCopyEx(mRenderer.get(), texture.get(), &srcRect, &dstRect, angle, &sdlPoint,
+                                    renderFlip.mFlip);
         } else {
-            return SDL_RenderCopyEx(get(), texture.get(), &srcRect, &dstRect, angle, nullptr, renderFlip.mFlip);
+            return SDL_RenderCopyEx(mRenderer.get(), texture.get(), &srcRect, &dstRect, angle, nullptr,
+                                    renderFlip.mFlip);
+        }
+    }
+
+    int Context::setDrawColor(SDL_Color color) {
+        if (!mDrawColor)
+            getDrawColor();
+        if (mDrawColor && *mDrawColor == color) {
+            ++mStateCounters.skipped;
+            return 0;
+        }
+        mDrawColor = color;
+        mDrawColorPending = true;
+        return 0;
+    }
+
+    SDL_Color Context::getDrawColor() {
+        if (mDrawColor) {
+            ++mStateCounters.skipped;
+            return *mDrawColor;
+        }
+
+        ++mStateCounters.issued;
+        SDL_Color color{};
+        if (SDL_GetRenderDrawColor(mRenderer.get(), &color.r, &color.g, &color.b, &color.a) == 0) {
+            mDrawColor = color;
+            mAppliedDrawColor = color;
+            mDrawColorPending = false;
+        }
+        return color;
+    }
+
+    int Context::applyDrawColor() {
+        if (!mDrawColorPending)
+            return 0;
+        mDrawColorPending = false;
+
+        // A color set and restored by a guard without drawing in between never reaches the renderer.
+        if (mAppliedDrawColor && *mAppliedDrawColor == *mDrawColor) {
+            ++mStateCounters.skipped;
+            return 0;
+        }
+
+        ++mStateCounters.issued;
+        auto status = SDL_SetRenderDrawColor(mRenderer.get(), mDrawColor->r, mDrawColor->g, mDrawColor->b,
+                                             mDrawColor->a);
+        if (status == 0)
+            mAppliedDrawColor = mDrawColor;
+        else
+            mAppliedDrawColor.reset();
+        return status;
+    }
+
+    int Context::setDrawBlendMode(SDL_BlendMode blendMode) {
+        if (mDrawBlendMode && *mDrawBlendMode == blendMode) {
+            ++mStateCounters.skipped;
+            return 0;
+        }
+
+        ++mStateCounters.issued;
+        auto status = SDL_SetRenderDrawBlendMode(mRenderer.get(), blendMode);
+        if (status == 0)
+            mDrawBlendMode = blendMode;
+        else
+            mDrawBlendMode.reset();
+        return status;
+    }
+
+    SDL_BlendMode Context::getDrawBlendMode() {
+        if (mDrawBlendMode) {
+            ++mStateCounters.skipped;
+            return *mDrawBlendMode;
+        }
+
+        ++mStateCounters.issued;
+        SDL_BlendMode blendMode{SDL_BLENDMODE_NONE};
+        if (SDL_GetRenderDrawBlendMode(mRenderer.get(), &blendMode) == 0)
+            mDrawBlendMode = blendMode;
+        return blendMode;
+    }
+
+    int Context::setRenderTarget(SDL_Texture *texture) {
+        if (texture == mCurrentRenderTarget) {
+            ++mStateCounters.skipped;
+            return 0;
+        }
+
+        // Recorded commands draw to the current target.
+        flushCommandList();
+
+        ++mStateCounters.issued;
+        auto status = SDL_SetRenderTarget(mRenderer.get(), texture);
+        if (status == 0)
+            mCurrentRenderTarget = texture;
+        mClipRect.reset();
+        return status;
+    }
+
+    int Context::setClipRect(const SDL_Rect *clip) {
+        SDL_Rect rect = clip ? *clip : SDL_Rect{0, 0, 0, 0};
+        if (mClipRect && *mClipRect == rect) {
+            ++mStateCounters.skipped;
+            return 0;
         }
+
+        ++mStateCounters.issued;
+        auto status = SDL_RenderSetClipRect(mRenderer.get(), clip);
+        if (status == 0)
+            mClipRect = rect;
+        else
+            mClipRect.reset();
+        return status;
     }
 
-    int Context::setDrawColor(color::RGBA color) {
-        auto c = color.toSdlColor();
-        return SDL_SetRenderDrawColor(get(), c.r, c.g, c.b, c.a);
+    SDL_Rect Context::getClipRect() {
+        if (mClipRect) {
+            ++mStateCounters.skipped;
+            return *mClipRect;
+        }
+
+        ++mStateCounters.issued;
+        SDL_Rect clip{0, 0, 0, 0};
+        SDL_RenderGetClipRect(mRenderer.get(), &clip);
+        mClipRect = clip;
+        return clip;
     }
 
     int Context::fillRect(Rectangle rect, color::RGBA color) {
-        DrawColorGuard drawColorGuard{*this, color};
         SDL_Rect r{rect.x, rect.y, rect.w, rect.h};
-        return SDL_RenderFillRect(get(), &r);
+        if (mRecording) {
+            RenderCommand command{};
+            command.kind = RenderCommand::Fill;
+            command.dst = r;
+            command.color = color.toSdlColor();
+            command.bounds = r;
+            return recordDraw(command);
+        }
+
+        damage(r);
+        DrawColorGuard drawColorGuard{*this, color};
+        countDraw(nullptr);
+        return SDL_RenderFillRect(drawRenderer(), &r);
     }
 
     int Context::drawPoint(const Position<int> &p, const color::RGBA &color) {
+        if (mRecording) {
+            RenderCommand command{};
+            command.kind = RenderCommand::Point;
+            command.p0 = SDL_Point{p.x, p.y};
+            command.color = color.toSdlColor();
+            command.bounds = SDL_Rect{p.x, p.y, 1, 1};
+            return recordDraw(command);
+        }
+
+        damage(SDL_Rect{p.x, p.y, 1, 1});
         DrawColorGuard drawColorGuard{*this, color};
-        return SDL_RenderDrawPoint(get(), p.x, p.y);
+        countDraw(nullptr);
+        return SDL_RenderDrawPoint(drawRenderer(), p.x, p.y);
     }
 
     int Context::drawLine(const Position<int> &p0, const Position<int> &p1) {
-        return SDL_RenderDrawLine(get(), p0.x, p0.y, p1.x, p1.y);
+        if (mRecording) {
+            RenderCommand command{};
+            command.kind = RenderCommand::Line;
+            command.p0 = SDL_Point{p0.x, p0.y};
+            command.p1 = SDL_Point{p1.x, p1.y};
+            command.color = getDrawColor();
+            command.bounds = SDL_Rect{std::min(p0.x, p1.x), std::min(p0.y, p1.y),
+                                      std::abs(p1.x - p0.x) + 1, std::abs(p1.y - p0.y) + 1};
+            return recordDraw(command);
+        }
+
+        damage(SDL_Rect{std::min(p0.x, p1.x), std::min(p0.y, p1.y),
+                        std::abs(p1.x - p0.x) + 1, std::abs(p1.y - p0.y) + 1});
+        countDraw(nullptr);
+        return SDL_RenderDrawLine(drawRenderer(), p0.x, p0.y, p1.x, p1.y);
+    }
+
+    int Context::recordCopy(RenderCommand command) {
+        SDL_GetTextureColorMod(command.texture, &command.color.r, &command.color.g, &command.color.b);
+        SDL_GetTextureAlphaMod(command.texture, &command.color.a);
+        SDL_GetTextureBlendMode(command.texture, &command.blendMode);
+        command.clip = getClipRect();
+
+        if (!command.hasDst) {
+            command.bounds = UnboundedRect;
+        } else if (command.kind == RenderCommand::CopyEx && command.angle != 0.) {
+            command.bounds = rotatedBounds(command.dst, command.hasCenter, command.center);
+        } else {
+            command.bounds = command.dst;
+        }
+
+        damage(command.bounds);
+        ++mStateCounters.commands;
+        mCommands.push_back(command);
+        return 0;
+    }
+
+    int Context::recordDraw(RenderCommand command) {
+        command.blendMode = getDrawBlendMode();
+        command.clip = getClipRect();
+        damage(command.bounds);
+        ++mStateCounters.commands;
+        mCommands.push_back(command);
+        return 0;
+    }
+
+    void Context::addDamage(SDL_Rect bounds) {
+        if (mCurrentRenderTarget != mDamageTarget)
+            return;
+
+        if (auto clip = getClipRect(); !SDL_RectEmpty(&clip) && !SDL_IntersectRect(&bounds, &clip, &bounds))
+            return;
+        if (SDL_IntersectRect(&bounds, &mDamageExtent, &bounds))
+            mDamage.push_back(bounds);
+    }
+
+    void Context::beginDamageTracking() {
+        mTrackDamage = true;
+        mDamageTarget = mCurrentRenderTarget;
+        mDamageExtent = SDL_Rect{0, 0, 0, 0};
+        if (mDamageTarget)
+            SDL_QueryTexture(mDamageTarget, nullptr, nullptr, &mDamageExtent.w, &mDamageExtent.h);
+        else
+            SDL_GetRendererOutputSize(mRenderer.get(), &mDamageExtent.w, &mDamageExtent.h);
+        mDamage.clear();
+    }
+
+    std::vector<SDL_Rect> Context::endDamageTracking() {
+        mTrackDamage = false;
+        mergeRectangles(mDamage);
+        return std::move(mDamage);
+    }
+
+    int Context::renderClear(const SDL_Rect &rect) {
+        flushCommandList();
+        auto blendMode = getDrawBlendMode();
+        setDrawBlendMode(SDL_BLENDMODE_NONE);
+        countDraw(nullptr);
+        auto status = SDL_RenderFillRect(drawRenderer(), &rect);
+        setDrawBlendMode(blendMode);
+        return status;
+    }
+
+    void Context::beginCommandList() {
+        flushCommandList();
+        if (sRecordingContext && sRecordingContext != this)
+            sRecordingContext->submitCommandList();
+        sRecordingContext = this;
+        mRecording = true;
+    }
+
+    int Context::submitCommandList() {
+        auto status = flushCommandList();
+        mRecording = false;
+        if (sRecordingContext == this)
+            sRecordingContext = nullptr;
+        return status;
+    }
+
+    void Context::textureReleased(SDL_Texture *texture) {
+        if (auto context = sRecordingContext; context) {
+            if (std::any_of(context->mCommands.begin(), context->mCommands.end(),
+                            [texture](const RenderCommand &command) { return command.texture == texture; }))
+                context->flushCommandList();
+        }
+    }
+
+    int Context::flushCommandList() {
+        if (mCommands.empty())
+            return 0;
+
+        std::vector<RenderCommand> commands{};
+        commands.swap(mCommands);
+
+        // Assign each command to the latest earlier batch it may join without being moved past a command
+        // which overlaps it. The search is bounded to keep submission linear in the number of commands.
+        static constexpr size_t SearchLimit = 32;
+        struct Batch {
+            std::vector<size_t> members{};
+            SDL_Rect bounds{};
+        };
+        std::vector<Batch> batches{};
+        for (size_t i = 0; i < commands.size(); ++i) {
+            auto &command = commands[i];
+            auto join = batches.size();
+            for (size_t b = batches.size(), searched = 0; b-- > 0 && searched < SearchLimit; ++searched) {
+                auto &batch = batches[b];
+                if (batchable(commands[batch.members.front()], command)) {
+                    join = b;
+                    break;
+                }
+                if (overlap(batch.bounds, command.bounds) &&
+                    std::any_of(batch.members.begin(), batch.members.end(), [&](size_t member) {
+                        return overlap(commands[member].bounds, command.bounds);
+                    }))
+                    break;
+            }
+
+            if (join == batches.size()) {
+                batches.emplace_back();
+                batches.back().bounds = command.bounds;
+            } else {
+                batches[join].bounds = unite(batches[join].bounds, command.bounds);
+            }
+            batches[join].members.push_back(i);
+        }
+
+        // Submission changes the draw state, restore it for drawing which follows.
+        auto drawColor = getDrawColor();
+        auto drawBlendMode = getDrawBlendMode();
+        auto clip = getClipRect();
+
+        int status = 0;
+        for (auto &batch : batches)
+            if (auto batchStatus = submitBatch(commands, batch.members); batchStatus)
+                status = batchStatus;
+        mStateCounters.batches += batches.size();
+
+        setDrawColor(drawColor);
+        setDrawBlendMode(drawBlendMode);
+        setClipRect(clip.w == 0 && clip.h == 0 ? nullptr : &clip);
+        return status;
+    }
+
+    int Context::submitBatch(std::vector<RenderCommand> &commands, const std::vector<size_t> &batch) {
+        auto &first = commands[batch.front()];
+        int status = setClipRect(first.clip.w == 0 && first.clip.h == 0 ? nullptr : &first.clip);
+        auto check = [&status](int callStatus) {
+            if (callStatus)
+                status = callStatus;
+        };
+
+        switch (first.kind) {
+            case RenderCommand::Copy:
+            case RenderCommand::CopyEx: {
+                // Apply the texture state captured when the copies were recorded, then restore it.
+                SDL_Color mod{};
+                SDL_BlendMode blendMode{};
+                SDL_GetTextureColorMod(first.texture, &mod.r, &mod.g, &mod.b);
+                SDL_GetTextureAlphaMod(first.texture, &mod.a);
+                SDL_GetTextureBlendMode(first.texture, &blendMode);
+                bool changeMod = !(mod == first.color);
+                if (changeMod) {
+                    SDL_SetTextureColorMod(first.texture, first.color.r, first.color.g, first.color.b);
+                    SDL_SetTextureAlphaMod(first.texture, first.color.a);
+                }
+                if (blendMode != first.blendMode)
+                    SDL_SetTextureBlendMode(first.texture, first.blendMode);
+
+                for (auto index : batch) {
+                    auto &command = commands[index];
+                    auto src = command.hasSrc ? &command.src : nullptr;
+                    auto dst = command.hasDst ? &command.dst : nullptr;
+                    countDraw(command.texture);
+                    if (command.kind == RenderCommand::Copy)
+                        check(SDL_RenderCopy(mRenderer.get(), command.texture, src, dst));
+                    else
+                        check(SDL_RenderCopyEx(mRenderer.get(), command.texture, src, dst, command.angle,
+                                               command.hasCenter ? &command.center : nullptr, command.flip));
+                }
+
+                if (changeMod) {
+                    SDL_SetTextureColorMod(first.texture, mod.r, mod.g, mod.b);
+                    SDL_SetTextureAlphaMod(first.texture, mod.a);
+                }
+                if (blendMode != first.blendMode)
+                    SDL_SetTextureBlendMode(first.texture, blendMode);
+            }
+                break;
+            case RenderCommand::Fill: {
+                setDrawBlendMode(first.blendMode);
+                setDrawColor(first.color);
+                std::vector<SDL_Rect> rects{};
+                rects.reserve(batch.size());
+                for (auto index : batch)
+                    rects.push_back(commands[index].dst);
+                countDraw(nullptr);
+                check(SDL_RenderFillRects(drawRenderer(), rects.data(), static_cast<int>(rects.size())));
+            }
+                break;
+            case RenderCommand::Point: {
+                setDrawBlendMode(first.blendMode);
+                setDrawColor(first.color);
+                std::vector<SDL_Point> points{};
+                points.reserve(batch.size());
+                for (auto index : batch)
+                    points.push_back(commands[index].p0);
+                countDraw(nullptr);
+                check(SDL_RenderDrawPoints(drawRenderer(), points.data(), static_cast<int>(points.size())));
+            }
+                break;
+            case RenderCommand::Line:
+                setDrawBlendMode(first.blendMode);
+                setDrawColor(first.color);
+                for (auto index : batch) {
+                    auto &command = commands[index];
+                    countDraw(nullptr);
+                    check(SDL_RenderDrawLine(drawRenderer(), command.p0.x, command.p0.y, command.p1.x,
+                                             command.p1.y));
+                }
+                break;
+        }
+        return status;
     }
 
     RenderTargetGuard::RenderTargetGuard(Context &context, Texture &texture) : mContext(context) {
-        mLastTexture = context.mCurrentRenderTarget;
-        context.mCurrentRenderTarget = texture.get();
-        status = SDL_SetRenderTarget(context.get(), context.mCurrentRenderTarget);
+        mLastTexture = context.getRenderTarget();
+        status = context.setRenderTarget(texture.get());
     }
 
     int RenderTargetGuard::setRenderTarget(Texture &texture) {
-        mContext.mCurrentRenderTarget = texture.get();
-        return SDL_SetRenderTarget(mContext.get(), mContext.mCurrentRenderTarget);
+        return mContext.setRenderTarget(texture.get());
     }
 
     RenderTargetGuard::~RenderTargetGuard() noexcept(false) {
-        mContext.mCurrentRenderTarget = mLastTexture;
-        status = SDL_SetRenderTarget(mContext.get(), mContext.mCurrentRenderTarget);
+        status = mContext.setRenderTarget(mLastTexture);
     }
 
     bool GraphicsModel::initialize(const std::string &title, Size initialSize, const Position<int>& initialPosition,
@@ -194,12 +752,28 @@ namespace rose::gm {
                 }
             }
 
-            mContext = Context{mSdlWindow, -1, RendererFlags::RENDERER_ACCELERATED
-                                               | RendererFlags::RENDERER_TARGETTEXTURE
-                                               | RendererFlags::RENDERER_PRESENTVSYNC};
+            // Settings override the pacing selected by the application.
+            mFramePacing = static_cast<FramePacing>(settings.getValue(set::SetFramePacing,
+                                                                      static_cast<int>(mFramePacing)));
+            mFrameRate = settings.getValue(set::SetFrameRate, mFrameRate);
+
+            uint32_t rendererFlags = RendererFlags::RENDERER_ACCELERATED | RendererFlags::RENDERER_TARGETTEXTURE;
+            if (mFramePacing != FramePacing::FixedRate)
+                rendererFlags |= RendererFlags::RENDERER_PRESENTVSYNC;
+            mContext = Context{mSdlWindow, -1, rendererFlags};
 
             if (mContext) {
                 mContext.setDrawBlendMode(SDL_BLENDMODE_BLEND);
+
+                SDL_DisplayMode displayMode{};
+                int refreshRate = 0;
+                if (SDL_GetWindowDisplayMode(mSdlWindow.get(), &displayMode) == 0)
+                    refreshRate = displayMode.refresh_rate;
+                bool vsync = SDL_GetRendererInfo(mContext.get(), &info) == 0 &&
+                             (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+                mFramePacer.start(mFramePacing, vsync, refreshRate, mFrameRate);
+                mFrameTiming.setBudget(std::chrono::duration_cast<FrameDuration>(
+                        std::chrono::duration<double>(mFramePacer.frameInterval())));
             } else {
                 ErrorCode = RoseErrorCode::SDL_RENDERER_CREATE;
                 std::cerr << "Could not create SDL_Renderer: " << SDL_GetError() << '\n';
@@ -222,87 +796,221 @@ namespace rose::gm {
      */
     void GraphicsModel::eventLoop(std::shared_ptr<Screen> &screen) {
         SDL_Event e;
-        Fps fps;
 
         while (mRunEventLoop) {
-            //Handle events on queue
-            while (SDL_PollEvent(&e) != 0) {
-                //User requests quit
-                if (e.type == SDL_QUIT) {
-                    mRunEventLoop = false;
-                    continue;
+            {
+                FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Events};
+                //Handle events on queue
+                while (SDL_PollEvent(&e) != 0) {
+                    //User requests quit
+                    if (e.type == SDL_QUIT) {
+                        mRunEventLoop = false;
+                        continue;
+                    }
+                    if (eventCallback)
+                        eventCallback(e);
                 }
-                if (eventCallback)
-                    eventCallback(e);
             }
 
-            drawAll(screen);
+            auto presented = drawAll(screen);
 
-            fps.next();
+            mFramePacer.next(presented);
         }
     }
 
-    void GraphicsModel::drawAll(std::shared_ptr<Screen> &screen) {
-        CommonSignals::getCommonSignals().frameSignal.transmit(mFrame);
+    bool GraphicsModel::drawAll(std::shared_ptr<Screen> &screen) {
+        {
+            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::FrameSignal};
+            CommonSignals::getCommonSignals().frameSignal.transmit(mFrame);
+        }
 
-        if (mRedrawBackground) {
-            screen->erase(std::remove_if(screen->begin(), screen->end(), [&](auto ref)->bool {
-                if (auto popup = std::dynamic_pointer_cast<PopupWindow>(ref); popup) {
-                    return popup->removePopup();
-                }
-                return false;
-            }),screen->end());
+        if (mDeferredRendering)
+            mContext.beginCommandList();
+
+        bool recompose = mRedrawBackground || mRecompose;
+        if (recompose) {
+            {
+                FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::PopupPrune};
+                screen->erase(std::remove_if(screen->begin(), screen->end(), [&](auto ref) -> bool {
+                    if (auto popup = std::dynamic_pointer_cast<PopupWindow>(ref); popup) {
+                        return popup->removePopup();
+                    }
+                    return false;
+                }), screen->end());
+            }
 
+            // Only Windows whose contents changed are generated again, the others are composed as they are.
+            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::BaseTexture};
             for (auto &content : *screen) {
                 if (auto window = std::dynamic_pointer_cast<Window>(content); window) {
-                    window->generateBaseTexture(mContext, Position<int>{});
+                    if (mRedrawBackground || window->baseTextureDirty())
+                        window->generateBaseTexture(mContext, Position<int>{});
                 }
             }
         }
 
-        if (Animator::getAnimator() || mRedrawBackground) {
-            mContext.renderClear();
+        bool presented = Animator::getAnimator() || recompose;
+        if (presented && mCompositedAnimation) {
+            composeFrame(screen);
+        } else if (presented) {
+            {
+                FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Compose};
+                mContext.renderClear();
+            }
             for (auto & content : *screen) {
                 if (auto window = std::dynamic_pointer_cast<Window>(content); window) {
-                    if (window->baseTextureNeeded(Position<int>{}))
+                    if (window->baseTextureNeeded(Position<int>{})) {
+                        FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::BaseTexture};
                         window->generateBaseTexture(mContext, Position<int>{});
-                    window->drawBaseTexture(mContext, Position<int>{});
+                    }
+                    {
+                        FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Compose};
+                        window->drawBaseTexture(mContext, Position<int>{});
+                    }
 
+                    FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Animate};
                     Animator::getAnimator().animate(window, mContext, mFrame);
                 }
             }
+            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Present};
+            mContext.submitCommandList();
             mContext.renderPresent();
         }
 
+        {
+            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Present};
+            mContext.submitCommandList();
+        }
+
+        if constexpr (FrameTiming::Enabled)
+            mFrameTiming.endFrame(mFrame);
+
         mRedrawBackground = false;
+        mRecompose = false;
         mFrame++;
+        return presented;
     }
 
-    DrawColorGuard::DrawColorGuard(Context &context, SDL_Color color) : mContext(context) {
-        mStatus = 0;
-        if (int status = SDL_GetRenderDrawColor( mContext.get(), &mOldColor.r, &mOldColor.g,
-                                                 &mOldColor.b, &mOldColor.a); status == 0 ) {
-            mStatus = SDL_SetRenderDrawColor( mContext.get(), color.r, color.g, color.b, color.a);
+    void GraphicsModel::redrawWindow(const std::shared_ptr<Window> &window) {
+        if (window) {
+            window->setBaseTextureDirty();
+            mRecompose = true;
         } else {
-            mStatus = status;
+            mRedrawBackground = true;
+        }
+    }
+
+    void GraphicsModel::composeFrame(std::shared_ptr<Screen> &screen) {
+        Size size{};
+        SDL_GetRendererOutputSize(mContext.get(), &size.w, &size.h);
+        bool full = mRedrawBackground || mRecompose;
+        if (!mBackBuffer || mBackBuffer.getSize() != size) {
+            mBackBuffer = Texture{mContext, size};
+            mBackBuffer.setCategory(TextureCategory::Screen);
+            mBackBuffer.setBlendMode(SDL_BLENDMODE_NONE);
+            full = true;
+        }
+
+        auto animator = [&](std::shared_ptr<Window> &window, std::vector<SDL_Rect> &damage) {
+            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Animate};
+            mContext.beginDamageTracking();
+            Animator::getAnimator().animate(window, mContext, mFrame);
+            auto drawn = mContext.endDamageTracking();
+            damage.insert(damage.end(), drawn.begin(), drawn.end());
+        };
+
+        std::vector<SDL_Rect> damage{};
+        {
+            RenderTargetGuard renderTargetGuard{mContext, mBackBuffer};
+            for (auto &content : *screen) {
+                if (auto window = std::dynamic_pointer_cast<Window>(content); window)
+                    full = full || window->baseTextureNeeded(Position<int>{});
+            }
+
+            if (!full) {
+                // Restore the areas animations drew last frame, then let the animations draw over them.
+                {
+                    FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Compose};
+                    for (auto &rect : mAnimationDamage)
+                        mContext.renderClear(rect);
+                }
+                for (auto &content : *screen) {
+                    if (auto window = std::dynamic_pointer_cast<Window>(content); window) {
+                        {
+                            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Compose};
+                            for (auto &rect : mAnimationDamage)
+                                window->drawBaseTexture(mContext, Position<int>{},
+                                                        Rectangle{rect.x, rect.y, rect.w, rect.h});
+                        }
+                        animator(window, damage);
+                    }
+                }
+
+                // An animation which drew outside the restored areas may have drawn over a later Window.
+                full = !std::all_of(damage.begin(), damage.end(), [this](const SDL_Rect &rect) {
+                    return std::any_of(mAnimationDamage.begin(), mAnimationDamage.end(), [&rect](const SDL_Rect &r) {
+                        return rect.x >= r.x && rect.y >= r.y && rect.x + rect.w <= r.x + r.w &&
+                               rect.y + rect.h <= r.y + r.h;
+                    });
+                });
+            }
+
+            if (full) {
+                ++mCompositionCounters.fullFrames;
+                damage.clear();
+                {
+                    FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Compose};
+                    mContext.renderClear();
+                }
+                for (auto &content : *screen) {
+                    if (auto window = std::dynamic_pointer_cast<Window>(content); window) {
+                        if (window->baseTextureNeeded(Position<int>{})) {
+                            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::BaseTexture};
+                            window->generateBaseTexture(mContext, Position<int>{});
+                        }
+                        {
+                            FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Compose};
+                            window->drawBaseTexture(mContext, Position<int>{});
+                        }
+                        animator(window, damage);
+                    }
+                }
+            }
         }
+
+        if (!full)
+            ++mCompositionCounters.partialFrames;
+
+        mergeRectangles(damage);
+        mAnimationDamage = std::move(damage);
+
+        FrameTiming::PhaseTimer phaseTimer{mFrameTiming, FramePhase::Present};
+        mContext.renderCopy(mBackBuffer);
+        mContext.submitCommandList();
+        mContext.renderPresent();
+    }
+
+    DrawColorGuard::DrawColorGuard(Context &context, SDL_Color color) : mContext(context) {
+        mOldColor = mContext.getDrawColor();
+        mStatus = mContext.setDrawColor(color);
     }
 
     DrawColorGuard::DrawColorGuard(Context &context, color::RGBA color) : DrawColorGuard(context,
                                                                                            color.toSdlColor()) {}
 
     int DrawColorGuard::setDrawColor(SDL_Color color) {
-        return SDL_SetRenderDrawColor(mContext.get(), color.r, color.g, color.b, color.a);
+        return mContext.setDrawColor(color);
     }
 
     color::RGBA getRGBA(SDL_PixelFormat *format, uint32_t pixel) {
-        uint8_t r, g, b, a;
-        SDL_GetRGBA(pixel, format, &r, &g, &b, &a);
-        return color::RGBA{(uint)r, (uint)g, (uint)b, (uint)a};
+        color::RGBA rgba{};
+        pixelsToRGBA(format, &pixel, 1, &rgba);
+        return rgba;
     }
 
     uint32_t mapRGBA(SDL_PixelFormat *format, const color::RGBA &color) {
-        auto c = color.toSdlColor();
-        return SDL_MapRGBA(format, c.r, c.g, c.b, c.a);
+        uint32_t pixel;
+        rgbaToPixels(format, &color, 1, &pixel);
+        return pixel;
     }
 }
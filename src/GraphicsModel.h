@@ -14,12 +14,24 @@
 
 #include <memory>
 #include <functional>
+#include <optional>
+#include <vector>
 #include <Utilities.h>
 #include "Visual.h"
 #include "Color.h"
 #include "Texture.h"
 #include "CommonSignals.h"
+#include "FrameTiming.h"
 
+/// Compare two SDL_Colors component by component.
+inline bool operator==(const SDL_Color &c0, const SDL_Color &c1) {
+    return c0.r == c1.r && c0.g == c1.g && c0.b == c1.b && c0.a == c1.a;
+}
+
+/// Compare two SDL_Rects, all zero is the disabled clip rectangle.
+inline bool operator==(const SDL_Rect &r0, const SDL_Rect &r1) {
+    return r0.x == r1.x && r0.y == r1.y && r0.w == r1.w && r0.h == r1.h;
+}
 
 namespace rose {
     class Application;
@@ -69,13 +81,60 @@ namespace rose::gm {
         constexpr explicit RenderFlip(SDL_RendererFlip flip) noexcept: mFlip(flip) {}
     };
 
+    /**
+     * @struct RenderStateCounters
+     * @brief Counts of render state operations issued to SDL and of those satisfied by the Context shadow state.
+     */
+    struct RenderStateCounters {
+        size_t issued{0};       ///< SDL render state set and get calls made.
+        size_t skipped{0};      ///< Render state sets and gets which did not need an SDL call.
+        size_t drawCalls{0};    ///< SDL copy, fill, line and point calls made.
+        size_t textureChanges{0};   ///< Copies from a different texture than the previous draw call.
+        size_t commands{0};     ///< Drawing operations recorded in the command list.
+        size_t batches{0};      ///< Batches submitted from the command list.
+    };
+
+    /**
+     * @struct RenderCommand
+     * @brief A drawing operation recorded in the Context command list with the render state it needs.
+     */
+    struct RenderCommand {
+        /// The operation.
+        enum Kind {
+            Copy,       ///< SDL_RenderCopy
+            CopyEx,     ///< SDL_RenderCopyEx
+            Fill,       ///< SDL_RenderFillRect
+            Line,       ///< SDL_RenderDrawLine
+            Point,      ///< SDL_RenderDrawPoint
+        };
+
+        Kind kind{Copy};
+        SDL_Texture *texture{nullptr};          ///< The source texture of a copy.
+        bool hasSrc{false};                     ///< The copy has a source rectangle.
+        bool hasDst{false};                     ///< The copy has a destination rectangle.
+        SDL_Rect src{};                         ///< The copy source rectangle.
+        SDL_Rect dst{};                         ///< The copy destination or fill rectangle.
+        SDL_Point p0{}, p1{};                   ///< The line end points, p0 for a point.
+        double angle{0.};                       ///< The CopyEx rotation.
+        bool hasCenter{false};                  ///< The CopyEx has a rotation center.
+        SDL_Point center{};                     ///< The CopyEx rotation center.
+        SDL_RendererFlip flip{SDL_FLIP_NONE};   ///< The CopyEx flip.
+        SDL_Color color{};                      ///< The draw color, or the texture color and alpha mod.
+        SDL_BlendMode blendMode{SDL_BLENDMODE_NONE};    ///< The draw blend mode, or the texture blend mode.
+        SDL_Rect clip{};                        ///< The clip rectangle, all zero when disabled.
+        SDL_Rect bounds{};                      ///< The pixels the operation may change.
+    };
+
     /**
      * @classs Context
      * @brief An abstraction of graphics rendering context.
+     * @details The Context shadows the draw color, draw blend mode, clip rectangle and render target of the
+     * renderer so setting a value which is already current, and reading the current value, do not call SDL.
+     * The draw color is applied to the renderer when it is next needed for drawing, so a DrawColorGuard which
+     * sets and restores a color around a drawing operation issues at most one SDL call. Code which changes
+     * the renderer state through the SDL API directly must call invalidateRenderState().
      */
     class Context {
-        friend class RenderTargetGuard;
-
     protected:
         /**
          * @brief A functor to destroy an SDL_Renderer
@@ -94,12 +153,69 @@ namespace rose::gm {
         using RendererPtr = std::unique_ptr<SDL_Renderer, RendererDestroy>; ///< An SDL_Renderer unique pointer
         RendererPtr mRenderer{};    ///< The Renderer.
 
-        SDL_Texture *mCurrentRenderTarget{nullptr};
+        SDL_Texture *mCurrentRenderTarget{nullptr};     ///< The current render target, nullptr for the window.
+
+        std::optional<SDL_Color> mDrawColor{};          ///< The draw color requested, if known.
+        std::optional<SDL_Color> mAppliedDrawColor{};   ///< The draw color set on the renderer, if known.
+        bool mDrawColorPending{false};                  ///< The requested draw color has changed since applied.
+        std::optional<SDL_BlendMode> mDrawBlendMode{};  ///< The draw blend mode, if known.
+        std::optional<SDL_Rect> mClipRect{};            ///< The clip rectangle, all zero when disabled, if known.
+        RenderStateCounters mStateCounters{};           ///< Render state operation counts.
+        SDL_Texture *mLastDrawTexture{nullptr};         ///< The texture of the last draw call, nullptr if not a copy.
+
+        bool mRecording{false};                         ///< Drawing operations are recorded in mCommands.
+        std::vector<RenderCommand> mCommands{};         ///< The command list.
+        static Context *sRecordingContext;              ///< The Context recording a command list, if any.
+
+        bool mTrackDamage{false};                       ///< The bounds of drawing operations are collected.
+        SDL_Texture *mDamageTarget{nullptr};            ///< The render target damage is tracked on.
+        SDL_Rect mDamageExtent{};                       ///< The size of mDamageTarget.
+        std::vector<SDL_Rect> mDamage{};                ///< The bounds of drawing on mDamageTarget.
+
+        /// Add the bounds of a drawing operation to the damage when tracking damage.
+        void damage(const SDL_Rect &bounds) {
+            if (mTrackDamage)
+                addDamage(bounds);
+        }
+
+        /// Clip bounds to the clip rectangle and target, and add them to the damage if drawn on mDamageTarget.
+        void addDamage(SDL_Rect bounds);
+
+        /// Count a draw call using texture, nullptr if the call is not a copy.
+        void countDraw(SDL_Texture *texture) {
+            ++mStateCounters.drawCalls;
+            if (texture && texture != mLastDrawTexture)
+                ++mStateCounters.textureChanges;
+            mLastDrawTexture = texture;
+        }
+
+        /// Record a copy, capturing the texture modulation and blend mode and the clip rectangle.
+        int recordCopy(RenderCommand command);
+
+        /// Record a fill, line or point, capturing the draw blend mode and clip rectangle.
+        int recordDraw(RenderCommand command);
+
+        /// Issue one batch of commands of the same kind and state.
+        int submitBatch(std::vector<RenderCommand> &commands, const std::vector<size_t> &batch);
+
+        /// Set the requested draw color on the renderer if it differs from the applied color.
+        int applyDrawColor();
+
+        /// Get the renderer after applying pending state, for drawing operations.
+        SDL_Renderer *drawRenderer() {
+            applyDrawColor();
+            return mRenderer.get();
+        }
 
     public:
 
         Context() = default;
 
+        ~Context() {
+            if (sRecordingContext == this)
+                sRecordingContext = nullptr;
+        }
+
         Context(const Context &context) = delete;
 
         Context(Context &&context) noexcept = default;
@@ -114,12 +230,107 @@ namespace rose::gm {
         /// Test for a valid Context
         explicit operator bool() const noexcept { return mRenderer.operator bool(); }
 
-        /// Get an opaque pointer for API calls.
-        [[nodiscard]] auto get() const { return mRenderer.get(); }
+        /**
+         * @brief Get an opaque pointer for API calls.
+         * @details Recorded commands are submitted and pending render state is applied first so drawing
+         * through the SDL API is ordered after drawing through the Context and uses the current draw color.
+         */
+        [[nodiscard]] SDL_Renderer *get() {
+            flushCommandList();
+            return drawRenderer();
+        }
 
         /// Set the draw blend mode.
-        void setDrawBlendMode(SDL_BlendMode blendMode) {
-            SDL_SetRenderDrawBlendMode(mRenderer.get(), blendMode);
+        int setDrawBlendMode(SDL_BlendMode blendMode);
+
+        /// Get the draw blend mode.
+        SDL_BlendMode getDrawBlendMode();
+
+        /**
+         * @brief Set the render target.
+         * @details Setting a texture target resets the clip rectangle, and restoring the window target restores
+         * the window clip rectangle, so the shadow clip rectangle is discarded when the target changes.
+         * @param texture The target texture, nullptr for the window.
+         * @return The status return from the SDL API, 0 if the target is unchanged.
+         */
+        int setRenderTarget(SDL_Texture *texture);
+
+        /// Get the current render target, nullptr for the window.
+        [[nodiscard]] SDL_Texture *getRenderTarget() const noexcept { return mCurrentRenderTarget; }
+
+        /**
+         * @brief Set the clip rectangle.
+         * @param clip The clip rectangle, nullptr to disable clipping.
+         * @return The status return from the SDL API, 0 if the clip rectangle is unchanged.
+         */
+        int setClipRect(const SDL_Rect *clip);
+
+        /// Get the clip rectangle, all zero if clipping is disabled.
+        SDL_Rect getClipRect();
+
+        /// Get the draw color.
+        SDL_Color getDrawColor();
+
+        /**
+         * @brief Discard the shadow render state.
+         * @details Call after changing the renderer state through the SDL API directly. The state is read
+         * back from the renderer when next needed.
+         */
+        void invalidateRenderState() {
+            mDrawColor.reset();
+            mAppliedDrawColor.reset();
+            mDrawColorPending = false;
+            mDrawBlendMode.reset();
+            mClipRect.reset();
+        }
+
+        /// Get the render state operation counts.
+        [[nodiscard]] const RenderStateCounters &renderStateCounters() const noexcept { return mStateCounters; }
+
+        /// Reset the render state operation counts.
+        void resetRenderStateCounters() { mStateCounters = RenderStateCounters{}; }
+
+        /**
+         * @brief Start recording drawing operations in a command list.
+         * @details While recording, renderCopy(), renderCopyEx(), fillRect(), drawLine() and drawPoint()
+         * capture the render state they need and are queued rather than issued. Queued commands are submitted
+         * when the render target changes, when get() is called, when a queued texture is destroyed, and by
+         * submitCommandList(). On submission commands which use the same texture or draw color and state are
+         * issued together, a command is moved ahead of earlier commands only if the pixels they change do not
+         * overlap, so the result is the same as drawing in order. Fills and points of a batch are issued with
+         * a single SDL call.
+         */
+        void beginCommandList();
+
+        /**
+         * @brief Submit recorded commands and continue recording.
+         * @return The status of the last failed SDL call, 0 if all succeeded.
+         */
+        int flushCommandList();
+
+        /**
+         * @brief Submit recorded commands and stop recording.
+         * @return The status of the last failed SDL call, 0 if all succeeded.
+         */
+        int submitCommandList();
+
+        /// True while drawing operations are recorded.
+        [[nodiscard]] bool recording() const noexcept { return mRecording; }
+
+        /**
+         * @brief Submit recorded commands which copy from a texture about to be destroyed.
+         * @param texture The texture.
+         */
+        static void textureReleased(SDL_Texture *texture);
+
+        /**
+         * @brief Submit recorded commands which copy from a texture about to be rewritten in place.
+         * @details Called before SDL_UpdateTexture() or SDL_LockTexture(), so copies recorded earlier draw the
+         * pixels the texture held when they were recorded.
+         * @param texture The texture.
+         */
+        static void textureModified(SDL_Texture *texture) {
+            textureReleased(texture);
         }
 
         /**
@@ -133,11 +344,35 @@ namespace rose::gm {
         void copyFullTexture(Texture &source, Texture &destination);
 
         /// Prepare for the start of a rendering iteration.
-        int renderClear() { return SDL_RenderClear(mRenderer.get()); }
+        int renderClear() {
+            flushCommandList();
+            return SDL_RenderClear(drawRenderer());
+        }
+
+        /**
+         * @brief Clear a rectangle of the render target to the draw color.
+         * @details Unlike renderClear() only the rectangle is changed. The blend mode is ignored.
+         * @param rect The rectangle.
+         * @return The return status of the API call.
+         */
+        int renderClear(const SDL_Rect &rect);
 
         /// Complete a rendering iteration.
         void renderPresent() { SDL_RenderPresent(mRenderer.get()); }
 
+        /**
+         * @brief Start collecting the bounds of drawing operations on the current render target.
+         * @details The bounds are clipped to the clip rectangle in effect and to the target. Drawing on other
+         * targets, such as textures generated while drawing, is not collected.
+         */
+        void beginDamageTracking();
+
+        /**
+         * @brief Stop collecting the bounds of drawing operations.
+         * @return The areas drawn since beginDamageTracking(), merged so no two overlap.
+         */
+        std::vector<SDL_Rect> endDamageTracking();
+
         /**
          * @brief Copy a Texture to the current render target using the size of the Texture and the size of the
          * target.
@@ -175,14 +410,24 @@ namespace rose::gm {
          * @return Status code returned by SDL_RenderCopyEx()
          */
         int renderCopyEx(Texture &texture, Rectangle src, Rectangle dst, double angle, RenderFlip renderFlip,
-                         std::optional<Position<int>> point = std::nullopt) const;
+                         std::optional<Position<int>> point = std::nullopt);
+
+        /**
+         * @brief Set the drawing color used for drawing Rectangles, lines and clearing.
+         * @details The color is applied to the renderer when it is next used for drawing.
+         * @param color The new drawing Color.
+         * @return Status code returned by the API.
+         */
+        int setDrawColor(SDL_Color color);
 
         /**
          * @brief Set the drawing color used for drawing Rectangles, lines and clearing.
          * @param color The new drawing Color.
          * @return Status code returned by the API.
          */
-        int setDrawColor(color::RGBA color);
+        int setDrawColor(color::RGBA color) {
+            return setDrawColor(color.toSdlColor());
+        }
 
         /**
          * @brief Set the drawing color used for drawing Rectangles, lines and clearing.
@@ -208,6 +453,12 @@ namespace rose::gm {
          */
         int drawPoint(const Position<int> &p, const color::RGBA &color);
 
+        /**
+         * @brief Render a line in the current draw color.
+         * @param p0 The start point.
+         * @param p1 The end point.
+         * @return The status return from the SDL API.
+         */
         int drawLine(const Position<int> &p0, const Position<int> &p1);
     };
 
@@ -245,7 +496,6 @@ namespace rose::gm {
     class RenderTargetGuard {
     protected:
         Context &mContext;                      ///< The Context being guarded
-        bool popped{false};                     ///< True if the target guard has already been popped off the stack.
         SDL_Texture *mLastTexture{nullptr};     ///< Save the current render target here.
         int status{0};                          ///< The return status from the last SDL API call.
 
@@ -306,7 +556,7 @@ namespace rose::gm {
          * @brief Set the old clip rectangle back on the renderer when destroyed.
          */
         ~DrawColorGuard() noexcept(false) {
-            if (SDL_SetRenderDrawColor(mContext.get(), mOldColor.r, mOldColor.g, mOldColor.b, mOldColor.a)) {
+            if (mContext.setDrawColor(mOldColor)) {
                 throw DrawColorGuardException(StringCompositor("Call to SDL_XxxRenderDrawColor failed:",
                                                                      SDL_GetError()));
             }
@@ -371,9 +621,9 @@ namespace rose::gm {
          */
         ~ClipRectangleGuard() {
             if (mOldClip.w == 0 && mOldClip.y == 0)
-                mStatus = SDL_RenderSetClipRect(mContext.get(), nullptr);
+                mStatus = mContext.setClipRect(nullptr);
             else
-                mStatus = SDL_RenderSetClipRect(mContext.get(), &mOldClip);
+                mStatus = mContext.setClipRect(&mOldClip);
         }
 
         /**
@@ -383,7 +633,7 @@ namespace rose::gm {
          * @param context The renderer to guard the clip rectangle of.
          */
         explicit ClipRectangleGuard(Context &context) : mContext(context) {
-            SDL_RenderGetClipRect(mContext.get(), &mOldClip);
+            mOldClip = mContext.getClipRect();
         }
 
         /**
@@ -392,8 +642,8 @@ namespace rose::gm {
          * @param clip The new clip rectangle.
          */
         ClipRectangleGuard(Context &context, const SDL_Rect &clip) : mContext(context) {
-            SDL_RenderGetClipRect(mContext.get(), &mOldClip);
-            mStatus = SDL_RenderSetClipRect(mContext.get(), &clip);
+            mOldClip = mContext.getClipRect();
+            mStatus = mContext.setClipRect(&clip);
         }
 
         /**
@@ -415,9 +665,9 @@ namespace rose::gm {
          * @param clip A, possibly invalid, RectangleInt.
          */
         ClipRectangleGuard(Context &context, const Rectangle &clip) : mContext(context) {
-            SDL_RenderGetClipRect(mContext.get(), &mOldClip);
+            mOldClip = mContext.getClipRect();
             SDL_Rect rect{clip.x, clip.y, clip.w, clip.h};
-            mStatus = SDL_RenderSetClipRect(mContext.get(), &rect);
+            mStatus = mContext.setClipRect(&rect);
         }
 
         /**
@@ -426,7 +676,7 @@ namespace rose::gm {
          * @return The ClipRectangleGuard.
          */
         ClipRectangleGuard &operator=(SDL_Rect &clip) {
-            mStatus = SDL_RenderSetClipRect(mContext.get(), &clip);
+            mStatus = mContext.setClipRect(&clip);
             return *this;
         }
 
@@ -438,13 +688,12 @@ namespace rose::gm {
          */
         ClipRectangleGuard &operator=(Rectangle &clip) {
             SDL_Rect rect{clip.x, clip.y, clip.w, clip.h};
-            mStatus = SDL_RenderSetClipRect(mContext.get(), &rect);
+            mStatus = mContext.setClipRect(&rect);
             return *this;
         }
 
         ClipRectangleGuard &intersection(Rectangle &clip) {
-            SDL_Rect current;
-            SDL_RenderGetClipRect(mContext.get(), &current);
+            SDL_Rect current = mContext.getClipRect();
             if (SDL_RectEmpty(&current)) {
                 operator=(clip);
             } else {
@@ -452,13 +701,129 @@ namespace rose::gm {
                 Rectangle r{current.x, current.y, current.w, current.h};
                 r = r.intersection(clip);
                 current = SDL_Rect{r.x, r.y, r.w, r.h};
-                mStatus = SDL_RenderSetClipRect(mContext.get(), &current);
+                mStatus = mContext.setClipRect(&current);
             }
             return *this;
         }
     };
 
+    /**
+     * @enum FramePacing
+     * @brief The policy GraphicsModel uses to pace frames.
+     */
+    enum class FramePacing : int {
+        VSyncOnly,      ///< Presents are synchronized to the display refresh, idle frames are paced by timer.
+        FixedRate,      ///< Frames are paced by a high resolution timer, VSYNC is not requested.
+        Adaptive,       ///< As VSyncOnly, presenting on fewer refreshes when frames are being missed.
+    };
+
+    /**
+     * @class FramePacer
+     * @brief Wait between frames according to a FramePacing policy, and count missed frames.
+     * @details When a frame has been presented on a renderer with VSYNC the present has already waited for the
+     * vertical blank, so the pacer does not wait again. Otherwise the pacer waits for a deadline which advances
+     * by one frame interval per frame, so timer error does not accumulate. A frame is missed when the time
+     * since the previous frame exceeds one and a half frame intervals, each whole interval skipped counts as a
+     * missed frame. Every policy is limited to the frame rate: VSyncOnly and Adaptive present on every n-th
+     * refresh, where n is the refresh rate divided by the frame rate rounded to the nearest whole number and at
+     * least 1. Frame indexed animations are designed for the DefaultFrameRate. The Adaptive policy raises the
+     * refresh divisor when more than MissedLimit frames in AdaptWindow are missed, and probes the next lower
+     * divisor, down to n, after a period without misses.
+     */
+    class FramePacer {
+    public:
+        /**
+         * @struct Statistics
+         * @brief Frame pacing counters.
+         */
+        struct Statistics {
+            uint64_t frames{0};             ///< Frames paced.
+            uint64_t missed{0};             ///< Frame intervals missed.
+            uint32_t divisor{1};            ///< The current refresh divisor.
+            double lastInterval{0.};        ///< The last frame interval in seconds.
+            double maxInterval{0.};         ///< The longest frame interval in seconds.
+        };
+
+        static constexpr int DefaultRefreshRate = 60;   ///< Used when the display does not report a rate.
+        static constexpr int DefaultFrameRate = 30;     ///< The frame rate when none is selected.
+        static constexpr uint32_t MaxDivisor = 4;       ///< The largest Adaptive refresh divisor above n.
+        static constexpr uint32_t AdaptWindow = 30;     ///< Frames over which Adaptive counts misses.
+        static constexpr uint32_t MissedLimit = 3;      ///< Misses in AdaptWindow which raise the divisor.
+        static constexpr uint32_t ProbeFrames = 300;    ///< Frames without misses before probing a lower divisor.
+
+    protected:
+        FramePacing mPacing{FramePacing::VSyncOnly};    ///< The pacing policy.
+        bool mVSync{false};             ///< The renderer synchronizes presents to the display refresh.
+        uint64_t mFrequency{1};         ///< Performance counter ticks per second.
+        uint64_t mRefreshPeriod{0};     ///< The display refresh period in counter ticks.
+        uint64_t mFixedInterval{0};     ///< The FixedRate interval in counter ticks.
+        uint64_t mDeadline{0};          ///< The end of the current frame interval.
+        uint64_t mLastFrame{0};         ///< When the last frame completed.
+        uint32_t mMinDivisor{1};        ///< The refresh divisor which gives the frame rate.
+        uint32_t mDivisor{1};           ///< The current refresh divisor.
+        uint32_t mWindowFrames{0};      ///< Frames in the current Adaptive window.
+        uint32_t mWindowMissed{0};      ///< Misses in the current Adaptive window.
+        uint32_t mCleanFrames{0};       ///< Consecutive frames without a miss.
+        uint32_t mProbeFrames{ProbeFrames}; ///< Clean frames required before the next probe.
+        uint32_t mSinceProbe{0};        ///< Frames since the divisor was lowered by a probe.
+        bool mProbing{false};           ///< A probe of a lower divisor is being evaluated.
+        Statistics mStatistics{};       ///< Pacing counters.
+
+        /// The current frame interval in counter ticks.
+        [[nodiscard]] uint64_t interval() const;
+
+        /// Adjust the Adaptive divisor after a frame.
+        void adapt(uint64_t missed);
+
+        /// Wait until the performance counter reaches target.
+        void waitUntil(uint64_t target) const;
+
+    public:
+        /**
+         * @brief Start pacing.
+         * @param pacing The policy.
+         * @param vsync True if the renderer synchronizes presents to the display refresh.
+         * @param refreshRate The display refresh rate in Hz, zero if unknown.
+         * @param frameRate The frame rate in Hz, zero for DefaultFrameRate. A rate at or above the refresh rate
+         * presents on every refresh.
+         */
+        void start(FramePacing pacing, bool vsync, int refreshRate, int frameRate);
+
+        /**
+         * @brief Complete a frame, waiting until the next frame should start.
+         * @param presented True if the frame was presented.
+         */
+        void next(bool presented);
+
+        /// Get the pacing policy.
+        [[nodiscard]] FramePacing pacing() const { return mPacing; }
+
+        /// Get the current frame interval in seconds.
+        [[nodiscard]] double frameInterval() const {
+            return static_cast<double>(interval()) / static_cast<double>(mFrequency);
+        }
+
+        /// Get the pacing counters.
+        [[nodiscard]] const Statistics &statistics() const { return mStatistics; }
+
+        /// Reset the pacing counters.
+        void resetStatistics() {
+            mStatistics = Statistics{};
+            mStatistics.divisor = mDivisor;
+        }
+    };
+
     class GraphicsModel {
+    public:
+        /**
+         * @struct CompositionCounters
+         * @brief Counts of composited frames by how the back buffer was drawn.
+         */
+        struct CompositionCounters {
+            uint64_t fullFrames{0};         ///< Frames drawn by composing every Window.
+            uint64_t partialFrames{0};      ///< Frames drawn by restoring the areas animations drew.
+        };
+
     protected:
         SdlWindow mSdlWindow{};         ///< The SDL_Window which provides the application "Screen"
 
@@ -468,10 +833,39 @@ namespace rose::gm {
 
         bool mRedrawBackground{true};   ///< When true the background Texture needs to be redrawn.
 
+        bool mRecompose{false};         ///< When true the screen is composed again from the Window base textures.
+
         Texture mBackground{};          ///< The background Texture.
 
         uint32_t mFrame{};              ///< The rendering frame.
 
+        bool mDeferredRendering{false}; ///< Record each frame in the Context command list and submit it batched.
+
+        FrameTiming mFrameTiming{};     ///< Per phase frame timing, populated when built with ROSE_FRAME_TIMING.
+
+        FramePacing mFramePacing{FramePacing::VSyncOnly};   ///< The frame pacing policy selected for initialize().
+
+        int mFrameRate{0};              ///< The frame rate, zero for FramePacer::DefaultFrameRate.
+
+        FramePacer mFramePacer{};       ///< Waits between frames in eventLoop().
+
+        bool mCompositedAnimation{false};   ///< Compose frames on mBackBuffer, redrawing only animated areas.
+
+        Texture mBackBuffer{};          ///< The composited frame.
+
+        std::vector<SDL_Rect> mAnimationDamage{};   ///< The areas of mBackBuffer animations drew last frame.
+
+        CompositionCounters mCompositionCounters{}; ///< Composited frame counts.
+
+        /**
+         * @brief Compose the frame on the back buffer and copy it to the screen.
+         * @details When the background has changed the whole back buffer is drawn. Otherwise only the areas
+         * drawn by animations in the last frame are restored from the Window base textures, and the animations
+         * are drawn over them. If an animation draws outside those areas the whole back buffer is drawn.
+         * @param screen The Screen object to draw.
+         */
+        void composeFrame(std::shared_ptr<Screen> &screen);
+
         std::vector<Rectangle> mDisplayBounds{};
 
     public:
@@ -491,8 +885,9 @@ namespace rose::gm {
          * background.<p/>
          * If neither mRedrawBackground nor mAnimation are true no rendering of the screen is required.
          * @param screen The Screen object to draw.
+         * @return True if a frame was presented.
          */
-        void drawAll(std::shared_ptr<Screen> &screen);
+        bool drawAll(std::shared_ptr<Screen> &screen);
 
         std::function<void(SDL_Event)> eventCallback{};
 
@@ -518,6 +913,70 @@ namespace rose::gm {
 
         void redrawBackground() { mRedrawBackground = true; }
 
+        /**
+         * @brief Generate the base texture of one Window again and compose the screen.
+         * @details Other Windows keep their base textures. If window is empty every Window is redrawn.
+         * @param window The Window.
+         */
+        void redrawWindow(const std::shared_ptr<Window> &window);
+
+        /**
+         * @brief Compose the screen from the existing Window base textures.
+         * @details Use when a Window is added, removed or moved without its contents changing. Closed
+         * PopupWindows are removed from the Screen.
+         */
+        void recomposeScreen() { mRecompose = true; }
+
+        /**
+         * @brief Record the drawing of each frame in the Context command list and submit it batched.
+         * @param deferredRendering True to enable.
+         */
+        void setDeferredRendering(bool deferredRendering) { mDeferredRendering = deferredRendering; }
+
+        /**
+         * @brief Access the frame timing.
+         * @details Phase times are only measured when Rose is configured with ROSE_FRAME_TIMING,
+         * FrameTiming::Enabled reports which.
+         * @return The FrameTiming.
+         */
+        FrameTiming& frameTiming() { return mFrameTiming; }
+
+        /**
+         * @brief Select the frame pacing policy, call before initialize().
+         * @details FixedRate creates the renderer without VSYNC so the timer alone sets the frame rate. The other
+         * policies present on the refreshes closest to the frame rate.
+         * @param pacing The policy.
+         * @param frameRate The frame rate in Hz, zero for FramePacer::DefaultFrameRate.
+         */
+        void setFramePacing(FramePacing pacing, int frameRate = 0) {
+            mFramePacing = pacing;
+            mFrameRate = frameRate;
+        }
+
+        /// Access the frame pacer.
+        FramePacer& framePacer() { return mFramePacer; }
+
+        /**
+         * @brief Compose frames on a persistent back buffer.
+         * @details While animations run each frame only restores the areas animations drew in the last frame
+         * and draws the animations there, rather than copying every Window base texture to the screen. The
+         * back buffer is then presented with one copy.
+         * @param compositedAnimation True to enable.
+         */
+        void setCompositedAnimation(bool compositedAnimation) {
+            mCompositedAnimation = compositedAnimation;
+            if (!mCompositedAnimation) {
+                mBackBuffer.reset();
+                mAnimationDamage.clear();
+            }
+        }
+
+        /// Get the areas of the back buffer animations drew in the last composited frame.
+        [[nodiscard]] const std::vector<SDL_Rect> &animationDamage() const { return mAnimationDamage; }
+
+        /// Get the composited frame counts.
+        [[nodiscard]] const CompositionCounters &compositionCounters() const { return mCompositionCounters; }
+
         [[nodiscard]] Padding windowBorders() const noexcept {
             Padding p{};
             SDL_GetWindowBordersSize(mSdlWindow.get(), &p.t, &p.l, &p.b, &p.r);
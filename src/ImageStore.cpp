@@ -6,6 +6,7 @@
  */
 
 #include <array>
+#include <vector>
 #include "ImageStore.h"
 #include "Font.h"
 #include "Surface.h"
@@ -72,10 +73,13 @@ namespace rose {
         int minY = surface->h;
         int maxX = 0, maxY = 0;
 
+        // Convert the rendered glyph once, then find the bounds of the visible pixels.
+        auto width = surface->w;
+        std::vector<uint8_t> rgba8(static_cast<size_t>(4 * width * surface->h));
+        surface.readRGBA8(Rectangle{0, 0, width, surface->h}, rgba8.data());
         for (auto y = 0; y < surface->h; ++y) {
-            for (auto x = 0; x < surface->w; ++x) {
-                auto rgba = gm::getRGBA(surface->format, surface.pixel(x, y));
-                if (rgba.a() > 0) {
+            for (auto x = 0; x < width; ++x) {
+                if (rgba8[4 * (y * width + x) + 3] > 0) {
                     minX = std::min(minX, x);
                     minY = std::min(minY, y);
                     maxX = std::max(maxX, x);
@@ -85,14 +89,11 @@ namespace rose {
         }
 
         gm::Surface minimal{maxX - minX + 1, maxY - minY + 1};
-        for (auto y = 0; y < minimal->h; ++y) {
-            for (auto x = 0; x < minimal->w; ++x) {
-                auto rgba = gm::getRGBA(surface->format, surface.pixel(minX + x, minY + y));
-                minimal.pixel(x, y) = gm::mapRGBA(minimal->format, rgba);
-            }
-        }
+        for (auto y = 0; y < minimal->h; ++y)
+            minimal.writeRGBA8(Rectangle{0, y, minimal->w, 1}, &rgba8[4 * ((minY + y) * width + minX)]);
 
         gm::Texture texture{minimal.toTexture(context)};
+        texture.setCategory(gm::TextureCategory::Image);
         mImageMap.emplace(iconImage.key, std::move(texture));
     }
 
@@ -110,6 +111,7 @@ namespace rose {
     }
 
     void ImageStore::setImage(ImageId imageId, gm::Texture &&texture) {
+        texture.setCategory(gm::TextureCategory::Image);
         mImageMap[imageId] = std::move(texture);
     }
 
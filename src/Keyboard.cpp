@@ -159,7 +159,7 @@ namespace rose {
                 else if (auto imageKey = key->getNode<ImageKey>(); imageKey)
                     imageKey->setKeyState(mKeyState);
             }
-            getApplication().redrawBackground();
+            getApplication().redrawWindow(getWindow());
         }
     }
 
@@ -267,6 +267,6 @@ namespace rose {
             setImage(ImageId::Lock);
         else
             setImage(ImageId::LockOpen);
-        getApplication().redrawBackground();
+        getApplication().redrawWindow(getWindow());
     }
 }
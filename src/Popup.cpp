@@ -32,7 +32,7 @@ namespace rose {
                         << wdg<TextButton>("Close", [&](ButtonStateChange buttonStateChange){
                             if (buttonStateChange == ButtonStateChange::Pushed) {
                                 mRemovePopup = true;
-                                getScreen()->getApplication().redrawBackground();
+                                getScreen()->getApplication().recomposeScreen();
                             }
                         }) << Theme::getTheme().SemiBevelFrame;
     }
@@ -38,21 +38,159 @@ namespace rose::gm {
         }
     }
 
-    uint32_t &Surface::pixel(int x, int y) const {
-        auto *pixels = (Uint32 *) get()->pixels;
-        return pixels[(y * get()->w) + x];
+    namespace {
+        /// Channel shifts known at compile time, for the common formats.
+        template<uint32_t R, uint32_t G, uint32_t B, uint32_t A>
+        struct FixedLayout {
+            static constexpr uint32_t r = R, g = G, b = B, a = A;
+            static constexpr bool alpha = true;
+        };
+
+        /// Channel shifts read from a packed 8888 SDL_PixelFormat.
+        struct FormatLayout {
+            uint32_t r, g, b, a;
+            bool alpha;
+
+            explicit FormatLayout(const SDL_PixelFormat *format) : r(format->Rshift), g(format->Gshift),
+                    b(format->Bshift), a(format->Ashift), alpha(format->Amask != 0) {}
+        };
+
+        /**
+         * Call function with the layout of a packed 8888 format. Return false, without calling function, if
+         * the format is not packed 8888.
+         */
+        template<class Function>
+        bool withLayout(const SDL_PixelFormat *format, Function &&function) {
+            switch (format->format) {
+                case SDL_PIXELFORMAT_RGBA8888:
+                    function(FixedLayout<24, 16, 8, 0>{});
+                    return true;
+                case SDL_PIXELFORMAT_ARGB8888:
+                    function(FixedLayout<16, 8, 0, 24>{});
+                    return true;
+                case SDL_PIXELFORMAT_ABGR8888:
+                    function(FixedLayout<0, 8, 16, 24>{});
+                    return true;
+                default:
+                    break;
+            }
+            if (!isPacked8888(format))
+                return false;
+            function(FormatLayout{format});
+            return true;
+        }
+
+        inline uint8_t toByte(float value) {
+            return static_cast<uint8_t>(value * 255.f);
+        }
+    }
+
+    void pixelsToRGBA8(const SDL_PixelFormat *format, const uint32_t *pixels, size_t count, uint8_t *rgba8) {
+        if (withLayout(format, [=](auto layout) {
+            for (size_t i = 0; i < count; ++i) {
+                auto p = pixels[i];
+                auto out = rgba8 + 4 * i;
+                out[0] = static_cast<uint8_t>(p >> layout.r);
+                out[1] = static_cast<uint8_t>(p >> layout.g);
+                out[2] = static_cast<uint8_t>(p >> layout.b);
+                out[3] = layout.alpha ? static_cast<uint8_t>(p >> layout.a) : 255u;
+            }
+        }))
+            return;
+
+        for (size_t i = 0; i < count; ++i) {
+            auto out = rgba8 + 4 * i;
+            SDL_GetRGBA(pixels[i], format, out, out + 1, out + 2, out + 3);
+        }
+    }
+
+    void rgba8ToPixels(const SDL_PixelFormat *format, const uint8_t *rgba8, size_t count, uint32_t *pixels) {
+        if (withLayout(format, [=](auto layout) {
+            for (size_t i = 0; i < count; ++i) {
+                auto in = rgba8 + 4 * i;
+                uint32_t p = (uint32_t) in[0] << layout.r | (uint32_t) in[1] << layout.g |
+                             (uint32_t) in[2] << layout.b;
+                if (layout.alpha)
+                    p |= (uint32_t) in[3] << layout.a;
+                pixels[i] = p;
+            }
+        }))
+            return;
+
+        for (size_t i = 0; i < count; ++i) {
+            auto in = rgba8 + 4 * i;
+            pixels[i] = SDL_MapRGBA(format, in[0], in[1], in[2], in[3]);
+        }
+    }
+
+    void pixelsToRGBA(const SDL_PixelFormat *format, const uint32_t *pixels, size_t count, color::RGBA *rgba) {
+        if (withLayout(format, [=](auto layout) {
+            for (size_t i = 0; i < count; ++i) {
+                auto p = pixels[i];
+                rgba[i] = color::RGBA{(uint) (p >> layout.r), (uint) (p >> layout.g), (uint) (p >> layout.b),
+                                      layout.alpha ? (uint) (p >> layout.a) : 255u};
+            }
+        }))
+            return;
+
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t r, g, b, a;
+            SDL_GetRGBA(pixels[i], format, &r, &g, &b, &a);
+            rgba[i] = color::RGBA{(uint) r, (uint) g, (uint) b, (uint) a};
+        }
+    }
+
+    void rgbaToPixels(const SDL_PixelFormat *format, const color::RGBA *rgba, size_t count, uint32_t *pixels) {
+        if (withLayout(format, [=](auto layout) {
+            for (size_t i = 0; i < count; ++i) {
+                auto &c = rgba[i];
+                uint32_t p = (uint32_t) toByte(c.r()) << layout.r | (uint32_t) toByte(c.g()) << layout.g |
+                             (uint32_t) toByte(c.b()) << layout.b;
+                if (layout.alpha)
+                    p |= (uint32_t) toByte(c.a()) << layout.a;
+                pixels[i] = p;
+            }
+        }))
+            return;
+
+        for (size_t i = 0; i < count; ++i) {
+            auto &c = rgba[i];
+            pixels[i] = SDL_MapRGBA(format, toByte(c.r()), toByte(c.g()), toByte(c.b()), toByte(c.a()));
+        }
     }
 
     color::RGBA Surface::color(int x, int y) const {
-        auto p = pixel(x, y);
-        uint8_t r, g, b, a;
-        SDL_GetRGBA(p, get()->format, &r, &g, &b, &a);
-        return color::RGBA{(uint)r, (uint)g, (uint)b, (uint)a};
+        color::RGBA rgba{};
+        pixelsToRGBA(get()->format, &pixel(x, y), 1, &rgba);
+        return rgba;
     }
 
     void Surface::setColor(int x, int y, color::RGBA color) {
-        auto c = color.toSdlColor();
-        pixel(x, y) = SDL_MapRGBA(get()->format, c.r, c.g, c.g, c.a);
+        rgbaToPixels(get()->format, &color, 1, &pixel(x, y));
+    }
+
+    void Surface::readRGBA8(const Rectangle &rect, uint8_t *rgba8) const {
+        for (int y = 0; y < rect.h; ++y)
+            pixelsToRGBA8(get()->format, row(rect.y + y, rect.x, rect.w).data(), static_cast<size_t>(rect.w),
+                          rgba8 + 4 * y * rect.w);
+    }
+
+    void Surface::writeRGBA8(const Rectangle &rect, const uint8_t *rgba8) {
+        for (int y = 0; y < rect.h; ++y)
+            rgba8ToPixels(get()->format, rgba8 + 4 * y * rect.w, static_cast<size_t>(rect.w),
+                          row(rect.y + y, rect.x, rect.w).data());
+    }
+
+    void Surface::readRGBA(const Rectangle &rect, color::RGBA *rgba) const {
+        for (int y = 0; y < rect.h; ++y)
+            pixelsToRGBA(get()->format, row(rect.y + y, rect.x, rect.w).data(), static_cast<size_t>(rect.w),
+                         rgba + y * rect.w);
+    }
+
+    void Surface::writeRGBA(const Rectangle &rect, const color::RGBA *rgba) {
+        for (int y = 0; y < rect.h; ++y)
+            rgbaToPixels(get()->format, rgba + y * rect.w, static_cast<size_t>(rect.w),
+                         row(rect.y + y, rect.x, rect.w).data());
     }
 
     bool Surface::createWithFormat(int width, int height, int depth, SDL_PixelFormatEnum format) {
@@ -92,6 +230,74 @@ namespace rose::gm {
         return std::move(texture);
     }
 
+    int Surface::updateTexture(Texture &texture) const {
+        return updateTexture(texture, Rectangle{0, 0, get()->w, get()->h});
+    }
+
+    int Surface::updateTexture(Texture &texture, const Rectangle &rect) const {
+        if (rect.w <= 0 || rect.h <= 0)
+            return 0;
+
+        Context::textureModified(texture.get());
+        auto textureFormat = texture.getFormat();
+        auto surfaceFormat = get()->format;
+        SDL_Rect r{rect.x, rect.y, rect.w, rect.h};
+        if (textureFormat == surfaceFormat->format) {
+            auto pixels = static_cast<const uint8_t *>(get()->pixels) + rect.y * get()->pitch +
+                          rect.x * surfaceFormat->BytesPerPixel;
+            return SDL_UpdateTexture(texture.get(), &r, pixels, get()->pitch);
+        }
+
+        if (texture.getAccess() == SDL_TEXTUREACCESS_STREAMING && surfaceFormat->BytesPerPixel == 4 &&
+            SDL_BYTESPERPIXEL(textureFormat) == 4) {
+            std::unique_ptr<SDL_PixelFormat, decltype(&SDL_FreeFormat)> format{SDL_AllocFormat(textureFormat),
+                                                                               &SDL_FreeFormat};
+            TextureLock textureLock{texture, rect};
+            if (!format || !textureLock)
+                return -1;
+            std::vector<uint8_t> rgba8(static_cast<size_t>(4 * rect.w));
+            for (int y = 0; y < rect.h; ++y) {
+                pixelsToRGBA8(surfaceFormat, row(rect.y + y, rect.x, rect.w).data(), rgba8.size() / 4, rgba8.data());
+                rgba8ToPixels(format.get(), rgba8.data(), rgba8.size() / 4, textureLock.row(y));
+            }
+            return 0;
+        }
+
+        Surface converted{SDL_ConvertSurfaceFormat(get(), textureFormat, 0)};
+        if (!converted)
+            return -1;
+        return converted.updateTexture(texture, rect);
+    }
+
+    int Surface::updateTexture(Texture &texture, const std::vector<Rectangle> &dirty) const {
+        for (auto &rect : dirty)
+            if (auto status = updateTexture(texture, rect); status)
+                return status;
+        return 0;
+    }
+
+    bool Surface::streamToTexture(Context &context, Texture &texture) const {
+        auto format = get()->format;
+        bool reuse = texture && texture.getAccess() == SDL_TEXTUREACCESS_STREAMING &&
+                     texture.getFormat() == format->format && texture.getSize() == Size{get()->w, get()->h};
+
+        if (!reuse) {
+            if (format->BytesPerPixel != 4) {
+                texture.reset(SDL_CreateTextureFromSurface(context.get(), get()));
+                if (!texture)
+                    throw SurfaceRuntimeError(StringCompositor("SDL_CreateTextureFromSurface: ", SDL_GetError()));
+                return false;
+            }
+            texture = Texture{context, static_cast<SDL_PixelFormatEnum>(format->format), SDL_TEXTUREACCESS_STREAMING,
+                              get()->w, get()->h};
+            texture.setBlendMode(format->Amask ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+        }
+
+        if (updateTexture(texture))
+            throw SurfaceRuntimeError(StringCompositor("SDL_UpdateTexture: ", SDL_GetError()));
+        return reuse;
+    }
+
     int Surface::setBlendMode(SDL_BlendMode blendMode) noexcept {
         return SDL_SetSurfaceBlendMode(get(), blendMode);
     }
@@ -10,6 +10,7 @@
 #include <exception>
 #include <filesystem>
 #include <memory>
+#include <vector>
 #include <SDL.h>
 #include "Color.h"
 #include "Texture.h"
@@ -27,6 +28,81 @@ namespace rose::gm {
         explicit SurfaceRuntimeError(const char *what) : std::runtime_error(what) {}
     };
 
+    /**
+     * @class PixelSpan
+     * @brief A run of 32 bit pixels within one row of a Surface.
+     */
+    class PixelSpan {
+        uint32_t *mData{nullptr};
+        size_t mSize{0};
+
+    public:
+        constexpr PixelSpan() noexcept = default;
+
+        constexpr PixelSpan(uint32_t *data, size_t size) noexcept : mData(data), mSize(size) {}
+
+        [[nodiscard]] constexpr uint32_t *data() const noexcept { return mData; }
+
+        [[nodiscard]] constexpr size_t size() const noexcept { return mSize; }
+
+        [[nodiscard]] constexpr bool empty() const noexcept { return mSize == 0; }
+
+        [[nodiscard]] constexpr uint32_t *begin() const noexcept { return mData; }
+
+        [[nodiscard]] constexpr uint32_t *end() const noexcept { return mData + mSize; }
+
+        constexpr uint32_t &operator[](size_t idx) const noexcept { return mData[idx]; }
+    };
+
+    /**
+     * @brief Test if a format packs four 8 bit channels, or three and an unused byte, in 32 bit pixels.
+     * @details Pixels of these formats are converted by shifting and masking, without calls to SDL.
+     * @param format The pixel format.
+     * @return True if the format is packed 8888.
+     */
+    inline bool isPacked8888(const SDL_PixelFormat *format) noexcept {
+        return format->BytesPerPixel == 4 && !format->Rloss && !format->Gloss && !format->Bloss &&
+               (!format->Amask || !format->Aloss);
+    }
+
+    /**
+     * @brief Convert pixels to 8 bit R, G, B, A bytes.
+     * @details Formats without an alpha channel convert to an alpha of 255.
+     * @param format The pixel format.
+     * @param pixels The source pixels.
+     * @param count The number of pixels.
+     * @param rgba8 The destination, 4 * count bytes.
+     */
+    void pixelsToRGBA8(const SDL_PixelFormat *format, const uint32_t *pixels, size_t count, uint8_t *rgba8);
+
+    /**
+     * @brief Convert 8 bit R, G, B, A bytes to pixels.
+     * @param format The pixel format.
+     * @param rgba8 The source, 4 * count bytes.
+     * @param count The number of pixels.
+     * @param pixels The destination pixels.
+     */
+    void rgba8ToPixels(const SDL_PixelFormat *format, const uint8_t *rgba8, size_t count, uint32_t *pixels);
+
+    /**
+     * @brief Convert pixels to color::RGBA.
+     * @param format The pixel format.
+     * @param pixels The source pixels.
+     * @param count The number of pixels.
+     * @param rgba The destination colors.
+     */
+    void pixelsToRGBA(const SDL_PixelFormat *format, const uint32_t *pixels, size_t count, color::RGBA *rgba);
+
+    /**
+     * @brief Convert color::RGBA to pixels.
+     * @details Components are converted the same way as color::RGBA::toSdlColor().
+     * @param format The pixel format.
+     * @param rgba The source colors.
+     * @param count The number of pixels.
+     * @param pixels The destination pixels.
+     */
+    void rgbaToPixels(const SDL_PixelFormat *format, const color::RGBA *rgba, size_t count, uint32_t *pixels);
+
     /**
     * @brief A functor to destroy an SDL_Surface
     */
@@ -81,13 +157,65 @@ namespace rose::gm {
         Surface(int width, int height, int depth, uint32_t rmask, uint32_t gmask, uint32_t bmask, uint32_t amask);
 
         /**
-         * @brief Provide access to a pixel of the Surface.
+         * @brief Provide access to a pixel of a 32 bit Surface.
          * @details The co-ordinates are not checked for out of range values.
          * @param x The X co-ordinate.
          * @param y The Y co-ordinate.
          * @return A reference to the pixel.
          */
-        [[nodiscard]] uint32_t &pixel(int x, int y) const;
+        [[nodiscard]] uint32_t &pixel(int x, int y) const {
+            return reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(get()->pixels) + y * get()->pitch)[x];
+        }
+
+        /**
+         * @brief Provide access to a row of a 32 bit Surface.
+         * @details Rows are located by the Surface pitch, which may exceed the width. The row is not checked
+         * for out of range values.
+         * @param y The Y co-ordinate.
+         * @return The PixelSpan of the row.
+         */
+        [[nodiscard]] PixelSpan row(int y) const {
+            return PixelSpan{&pixel(0, y), static_cast<size_t>(get()->w)};
+        }
+
+        /**
+         * @brief Provide access to part of a row of a 32 bit Surface.
+         * @param y The Y co-ordinate.
+         * @param x The X co-ordinate of the first pixel.
+         * @param width The number of pixels.
+         * @return The PixelSpan.
+         */
+        [[nodiscard]] PixelSpan row(int y, int x, int width) const {
+            return PixelSpan{&pixel(x, y), static_cast<size_t>(width)};
+        }
+
+        /**
+         * @brief Read a rectangle of a 32 bit Surface as 8 bit R, G, B, A bytes.
+         * @param rect The rectangle, which must be within the Surface.
+         * @param rgba8 The destination, 4 * rect.w * rect.h bytes, rows packed without padding.
+         */
+        void readRGBA8(const Rectangle &rect, uint8_t *rgba8) const;
+
+        /**
+         * @brief Write 8 bit R, G, B, A bytes to a rectangle of a 32 bit Surface.
+         * @param rect The rectangle, which must be within the Surface.
+         * @param rgba8 The source, 4 * rect.w * rect.h bytes, rows packed without padding.
+         */
+        void writeRGBA8(const Rectangle &rect, const uint8_t *rgba8);
+
+        /**
+         * @brief Read a rectangle of a 32 bit Surface as color::RGBA.
+         * @param rect The rectangle, which must be within the Surface.
+         * @param rgba The destination, rect.w * rect.h colors, rows packed without padding.
+         */
+        void readRGBA(const Rectangle &rect, color::RGBA *rgba) const;
+
+        /**
+         * @brief Write color::RGBA to a rectangle of a 32 bit Surface.
+         * @param rect The rectangle, which must be within the Surface.
+         * @param rgba The source, rect.w * rect.h colors, rows packed without padding.
+         */
+        void writeRGBA(const Rectangle &rect, const color::RGBA *rgba);
 
         /**
          * @brief Get a pixel color of the Surface.
@@ -145,6 +273,43 @@ namespace rose::gm {
          */
         Texture toTexture(Context &context);
 
+        /**
+         * @brief Upload the Surface into an existing Texture of the same size.
+         * @details The Texture must have SDL_TEXTUREACCESS_STATIC or SDL_TEXTUREACCESS_STREAMING access. When
+         * the formats match the pixels are uploaded with SDL_UpdateTexture(). Otherwise 32 bit pixels are
+         * converted directly into a locked streaming Texture, and other formats through a converted copy.
+         * @param texture The Texture.
+         * @return The SDL status, 0 on success.
+         */
+        int updateTexture(Texture &texture) const;
+
+        /**
+         * @brief Upload a rectangle of the Surface into the same rectangle of an existing Texture.
+         * @param texture The Texture.
+         * @param rect The rectangle, which must be within the Surface and the Texture.
+         * @return The SDL status, 0 on success.
+         */
+        int updateTexture(Texture &texture, const Rectangle &rect) const;
+
+        /**
+         * @brief Upload dirty rectangles of the Surface into an existing Texture.
+         * @param texture The Texture.
+         * @param dirty The rectangles which have changed since the last upload.
+         * @return The SDL status of the first failed upload, 0 on success.
+         */
+        int updateTexture(Texture &texture, const std::vector<Rectangle> &dirty) const;
+
+        /**
+         * @brief Upload the Surface to a streaming Texture, reusing the Texture when it can.
+         * @details If texture is a streaming Texture of the Surface size and format the pixels are uploaded
+         * into it. Otherwise a new streaming Texture is created, with SDL_BLENDMODE_BLEND if the Surface has an
+         * alpha channel. Surfaces which are not 32 bit fall back to SDL_CreateTextureFromSurface().
+         * @param context The Context.
+         * @param texture The Texture.
+         * @return True if the existing Texture was reused.
+         */
+        bool streamToTexture(Context &context, Texture &texture) const;
+
         /**
          * @brief Set the Surfacle SDL_BlendMode.
          * @param blendMode The blend mode, a value from SDL_BlendMode enum.
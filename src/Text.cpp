@@ -27,8 +27,13 @@ namespace rose {
     }
 
     Text::Status Text::createTextureBlended(gm::Context &context) {
-        if (mText.empty() && mSuffix.empty())
-            return TextEmpty;
+        if (mText.empty() && mSuffix.empty()) {
+            // Drop the Texture of the previous text so it is not drawn in place of nothing.
+            mTexture.reset(nullptr);
+            mTextSize = Size::Zero;
+            mTextureValid = true;
+            return mStatus = TextEmpty;
+        }
 
         if (!mFont) {
             FontCache &fontCache = FontCache::getFontCache();
@@ -65,9 +70,16 @@ namespace rose {
                     TTF_GlyphMetrics(mFont.get(), eM, nullptr, &em, nullptr, nullptr, nullptr);
                     mTextSize.w = mMaxSize * em;
                 }
-                mTexture.reset(SDL_CreateTextureFromSurface(context.get(), surface.get()));
-                if (mTexture)
+                // Text which renders to the same size, such as a clock, reuses the Texture.
+                try {
+                    surface.streamToTexture(context, mTexture);
+                    mTexture.setCategory(gm::TextureCategory::Text);
+                    mTextureValid = true;
                     return mStatus = OK;
+                } catch (const gm::SurfaceRuntimeError &e) {
+                    std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
+                    mStatus = TextureError;
+                }
             } else {
                 mStatus = SurfaceError;
             }
@@ -93,7 +105,7 @@ namespace rose {
         }
 
         mSaveToSettings = false;
-        mTexture.reset();
+        mTextureValid = false;
         if (mValidationPattern)
             mTextValidated = std::regex_match(mText, *mValidationPattern);
         else
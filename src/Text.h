@@ -69,6 +69,7 @@ namespace rose {
         std::shared_ptr<_TTF_Font> mFont{}; ///< The cached font used.
         int mPointSize;                     ///< The point (pixel) size of the font.
         gm::Texture mTexture{};             ///< The generated Texture.
+        bool mTextureValid{false};          ///< False when mTexture must be rendered again from the text.
         Size mTextSize{};                   ///< The size of the Texture in pixels.
         Status mStatus{OK};                 ///< The Status of the last operation.
         int mCaretLocation{0};              ///< The location of the caret.
@@ -90,14 +90,14 @@ namespace rose {
         } else
             mText.insert(mText.begin() + mCaretLocation, (toUpperCase ? std::toupper(text[0]) : text[0]));
         if (textUpdated())
-            getApplication().redrawBackground();
+            getApplication().redrawWindow(getWindow());
         ++mCaretLocation;
     }
 
     void TextField::keyboardFocusReceive(bool hasFocus) {
         setEditingMode(hasFocus, 0);
         mAnimationEnableState = hasFocus ? AnimationEnable::Enable : AnimationEnable::Disable;
-        getApplication().redrawBackground();
+        getApplication().redrawWindow(getWindow());
     }
 
     void TextField::eraseChar(int location) {
@@ -121,7 +121,7 @@ namespace rose {
                 case SDLK_BACKSPACE:
                     eraseChar(mCaretLocation - 1);
                     if (textUpdated())
-                        getApplication().redrawBackground();
+                        getApplication().redrawWindow(getWindow());
                     break;
                 case SDLK_LEFT:
                     mCaretLocation -= 2;
@@ -136,7 +136,7 @@ namespace rose {
                         eraseChar(mCaretLocation);
                     }
                     if (textUpdated())
-                        getApplication().redrawBackground();
+                        getApplication().redrawWindow(getWindow());
                     break;
                 default:
                     break;
@@ -8,12 +8,24 @@
 #include "Texture.h"
 #include "Types.h"
 #include "GraphicsModel.h"
+#include <algorithm>
+#include <iomanip>
 #include <SDL.h>
 
 namespace rose::gm {
 
+    void TextureDestroy::operator()(SDL_Texture *sdlTexture) {
+        if (sdlTexture != nullptr) {
+            Context::textureReleased(sdlTexture);
+            TextureMemory::getTextureMemory().destroyed(sdlTexture);
+            SDL_DestroyTexture(sdlTexture);
+        }
+    }
+
     Texture::Texture(Context &context, SDL_PixelFormatEnum format, SDL_TextureAccess access, int width, int height) {
         reset(SDL_CreateTexture(context.get(), format, access, width, height));
+        if (!operator bool() && TextureMemory::getTextureMemory().evict(TextureMemory::textureBytes(format, width, height)))
+            reset(SDL_CreateTexture(context.get(), format, access, width, height));
         if (!operator bool()) {
             throw TextureRuntimeError(
                     StringCompositor("SDL_CreateTexture: (", width, 'x', height, ") -- ",
@@ -23,6 +35,9 @@ namespace rose::gm {
 
     Texture::Texture(Context &context, Size size) {
         reset(SDL_CreateTexture(context.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size.w, size.h));
+        if (!operator bool() &&
+            TextureMemory::getTextureMemory().evict(TextureMemory::textureBytes(SDL_PIXELFORMAT_RGBA8888, size.w, size.h)))
+            reset(SDL_CreateTexture(context.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size.w, size.h));
         if (!operator bool()) {
             throw TextureRuntimeError(
                     StringCompositor("SDL_CreateTexture: (", size.w, 'x', size.h, ") -- ",
@@ -30,8 +45,224 @@ namespace rose::gm {
         }
     }
 
+    void Texture::reset(SDL_Texture *sdlTexture) {
+        std::unique_ptr<SDL_Texture,TextureDestroy>::reset(sdlTexture);
+        if (sdlTexture)
+            TextureMemory::getTextureMemory().created(sdlTexture);
+    }
+
+    void Texture::setCategory(TextureCategory category) {
+        if (operator bool())
+            TextureMemory::getTextureMemory().setCategory(get(), category);
+    }
+
     int Texture::setAlphaMod(float alpha) {
         uint8_t alphaMod = static_cast<uint8_t>(255.f * std::clamp(alpha, 0.f, 1.f));
         return SDL_SetTextureAlphaMod(get(), alphaMod);
     }
+
+    TextureLock::TextureLock(Texture &texture) : mTexture(texture.get()) {
+        Context::textureModified(mTexture);
+        mStatus = SDL_LockTexture(mTexture, nullptr, &mPixels, &mPitch);
+    }
+
+    TextureLock::TextureLock(Texture &texture, const Rectangle &rect) : mTexture(texture.get()) {
+        Context::textureModified(mTexture);
+        SDL_Rect r{rect.x, rect.y, rect.w, rect.h};
+        mStatus = SDL_LockTexture(mTexture, &r, &mPixels, &mPitch);
+    }
+
+    TextureLock::~TextureLock() {
+        if (mStatus == 0)
+            SDL_UnlockTexture(mTexture);
+    }
+
+    TextureMemory::TextureMemory() {
+        mFrameProtocol = GraphicsModelFrameProtocol::createSlot();
+        mFrameProtocol->receiver = [this](uint32_t) {
+            processEviction();
+        };
+        CommonSignals::getCommonSignals().frameSignal.connect(mFrameProtocol);
+    }
+
+    size_t TextureMemory::textureBytes(uint32_t format, int width, int height) {
+        auto pixels = static_cast<size_t>(std::max(width, 0)) * static_cast<size_t>(std::max(height, 0));
+        // FOURCC formats are planar YUV with chroma sampled at half resolution in each direction.
+        if (SDL_ISPIXELFORMAT_FOURCC(format))
+            return pixels + pixels / 2;
+        return pixels * std::max(static_cast<size_t>(SDL_BYTESPERPIXEL(format)), static_cast<size_t>(1));
+    }
+
+    const char *TextureMemory::categoryName(TextureCategory category) {
+        switch (category) {
+            case TextureCategory::Other:
+                return "Other";
+            case TextureCategory::Image:
+                return "Image";
+            case TextureCategory::Window:
+                return "Window";
+            case TextureCategory::Frame:
+                return "Frame";
+            case TextureCategory::Text:
+                return "Text";
+            case TextureCategory::Map:
+                return "Map";
+            case TextureCategory::Screen:
+                return "Screen";
+            default:
+                return "Unknown";
+        }
+    }
+
+    void TextureMemory::created(SDL_Texture *sdlTexture) {
+        Allocation allocation{};
+        int width = 0, height = 0;
+        if (SDL_QueryTexture(sdlTexture, &allocation.format, nullptr, &width, &height) == 0)
+            allocation.bytes = textureBytes(allocation.format, width, height);
+
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto [entry, inserted] = mAllocations.emplace(sdlTexture, allocation);
+        if (!inserted)
+            return;
+        ++mStatistics.textures;
+        mStatistics.bytes += allocation.bytes;
+        mStatistics.peakBytes = std::max(mStatistics.peakBytes, mStatistics.bytes);
+        ++mStatistics.categoryTextures[static_cast<size_t>(allocation.category)];
+        mStatistics.categoryBytes[static_cast<size_t>(allocation.category)] += allocation.bytes;
+        mStatistics.formatBytes[allocation.format] += allocation.bytes;
+        if (mStatistics.budget && mStatistics.bytes > mStatistics.budget)
+            mEvictionPending = true;
+    }
+
+    void TextureMemory::destroyed(SDL_Texture *sdlTexture) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto entry = mAllocations.find(sdlTexture);
+        if (entry == mAllocations.end())
+            return;
+        auto &allocation = entry->second;
+        --mStatistics.textures;
+        mStatistics.bytes -= allocation.bytes;
+        --mStatistics.categoryTextures[static_cast<size_t>(allocation.category)];
+        mStatistics.categoryBytes[static_cast<size_t>(allocation.category)] -= allocation.bytes;
+        if (auto format = mStatistics.formatBytes.find(allocation.format); format != mStatistics.formatBytes.end()) {
+            format->second -= allocation.bytes;
+            if (!format->second)
+                mStatistics.formatBytes.erase(format);
+        }
+        mAllocations.erase(entry);
+    }
+
+    void TextureMemory::setCategory(SDL_Texture *sdlTexture, TextureCategory category) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto entry = mAllocations.find(sdlTexture);
+        if (entry == mAllocations.end() || entry->second.category == category)
+            return;
+        auto &allocation = entry->second;
+        --mStatistics.categoryTextures[static_cast<size_t>(allocation.category)];
+        mStatistics.categoryBytes[static_cast<size_t>(allocation.category)] -= allocation.bytes;
+        allocation.category = category;
+        ++mStatistics.categoryTextures[static_cast<size_t>(allocation.category)];
+        mStatistics.categoryBytes[static_cast<size_t>(allocation.category)] += allocation.bytes;
+    }
+
+    void TextureMemory::setBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mStatistics.budget = bytes;
+        mEvictionPending = bytes && mStatistics.bytes > bytes;
+    }
+
+    size_t TextureMemory::budget() const {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return mStatistics.budget;
+    }
+
+    size_t TextureMemory::bytes() const {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return mStatistics.bytes;
+    }
+
+    TextureMemory::Statistics TextureMemory::statistics() const {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return mStatistics;
+    }
+
+    int TextureMemory::addEvictionHandler(int priority, EvictionHandler handler) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto id = mNextHandlerId++;
+        auto position = std::upper_bound(mHandlers.begin(), mHandlers.end(), priority,
+                                         [](int p, const Handler &h) { return p < h.priority; });
+        mHandlers.insert(position, Handler{id, priority, std::move(handler)});
+        return id;
+    }
+
+    void TextureMemory::removeEvictionHandler(int id) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mHandlers.erase(std::remove_if(mHandlers.begin(), mHandlers.end(),
+                                       [id](const Handler &h) { return h.id == id; }), mHandlers.end());
+    }
+
+    size_t TextureMemory::evict(size_t bytes) {
+        std::vector<Handler> handlers{};
+        size_t start;
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            if (mEvicting || !bytes)
+                return 0;
+            mEvicting = true;
+            handlers = mHandlers;
+            start = mStatistics.bytes;
+        }
+
+        // Handlers free memory by destroying Textures, so the lock is not held while they are called.
+        size_t freed = 0;
+        for (auto &handler : handlers) {
+            try {
+                handler.handler(bytes - freed);
+            } catch (const std::exception &e) {
+                std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
+            }
+
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            ++mStatistics.evictions;
+            freed = start > mStatistics.bytes ? start - mStatistics.bytes : 0;
+            if (freed >= bytes)
+                break;
+        }
+
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mStatistics.evictedBytes += freed;
+        mEvicting = false;
+        return freed;
+    }
+
+    void TextureMemory::processEviction() {
+        size_t excess;
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            if (!mEvictionPending)
+                return;
+            mEvictionPending = false;
+            if (!mStatistics.budget || mStatistics.bytes <= mStatistics.budget)
+                return;
+            excess = mStatistics.bytes - mStatistics.budget;
+        }
+
+        if (evict(excess) < excess)
+            std::cerr << __PRETTY_FUNCTION__ << " Texture memory over budget: " << statistics() << '\n';
+    }
+}
+
+std::ostream &operator<<(std::ostream &strm, const rose::gm::TextureMemory::Statistics &statistics) {
+    strm << statistics.textures << " textures " << statistics.bytes / 1024 << " KiB, peak "
+         << statistics.peakBytes / 1024 << " KiB";
+    if (statistics.budget)
+        strm << ", budget " << statistics.budget / 1024 << " KiB";
+    for (size_t i = 0; i < statistics.categoryBytes.size(); ++i) {
+        if (statistics.categoryTextures[i])
+            strm << ", " << rose::gm::TextureMemory::categoryName(static_cast<rose::gm::TextureCategory>(i)) << ' '
+                 << statistics.categoryTextures[i] << '/' << statistics.categoryBytes[i] / 1024 << " KiB";
+    }
+    for (auto &format : statistics.formatBytes)
+        strm << ", " << SDL_GetPixelFormatName(format.first) << ' ' << format.second / 1024 << " KiB";
+    return strm;
 }
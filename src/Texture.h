@@ -7,10 +7,16 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <ostream>
+#include <vector>
 #include <SDL.h>
 #include "Types.h"
+#include "CommonSignals.h"
 
 namespace rose::gm {
 
@@ -31,14 +37,26 @@ namespace rose::gm {
          * @brief Call the SDL API to destroy an SDL_Texture.
          * @param sdlTexture A pointer to the SDL_Texture to destroy.
          */
-        void operator()(SDL_Texture *sdlTexture) {
-            if (sdlTexture != nullptr)
-                SDL_DestroyTexture(sdlTexture);
-        }
+        void operator()(SDL_Texture *sdlTexture);
     };
 
     class Context;
 
+    /**
+     * @enum TextureCategory
+     * @brief The kind of owner holding a Texture, used to account for texture memory.
+     */
+    enum class TextureCategory : size_t {
+        Other,          ///< Not categorized.
+        Image,          ///< ImageStore images.
+        Window,         ///< Window base textures.
+        Frame,          ///< FrameElements borders and backgrounds.
+        Text,           ///< Rendered text.
+        Map,            ///< Map projection layers and overlays.
+        Screen,         ///< The screen background and back buffer.
+        Count,          ///< The number of categories.
+    };
+
     /**
      * @class Texture
      * @brief Abstraction of SDL_Texture
@@ -71,6 +89,19 @@ namespace rose::gm {
          */
         Texture(Context &context, Size size);
 
+        /**
+         * @brief Replace the managed SDL_Texture, accounting for the memory of both in TextureMemory.
+         * @details Hides std::unique_ptr::reset() so every texture adopted by a Texture is accounted for.
+         * @param sdlTexture The new SDL_Texture, or nullptr.
+         */
+        void reset(SDL_Texture *sdlTexture = nullptr);
+
+        /**
+         * @brief Set the owner category the Texture memory is accounted to.
+         * @param category The TextureCategory.
+         */
+        void setCategory(TextureCategory category);
+
         int setBlendMode(SDL_BlendMode blendMode) {
             return SDL_SetTextureBlendMode(get(), blendMode);
         }
@@ -81,6 +112,220 @@ namespace rose::gm {
             return size;
         }
 
+        /// Get the pixel format, a value from SDL_PixelFormatEnum.
+        [[nodiscard]] uint32_t getFormat() const {
+            uint32_t format{SDL_PIXELFORMAT_UNKNOWN};
+            SDL_QueryTexture(get(), &format, nullptr, nullptr, nullptr);
+            return format;
+        }
+
+        /// Get the texture access, a value from SDL_TextureAccess.
+        [[nodiscard]] int getAccess() const {
+            int access{-1};
+            SDL_QueryTexture(get(), nullptr, &access, nullptr, nullptr);
+            return access;
+        }
+
         int setAlphaMod(float alpha);
     };
+
+    /**
+     * @class TextureMemory
+     * @brief Account for the memory held by Textures, and keep it within an optional budget.
+     * @details Every SDL_Texture adopted by a Texture is recorded with its size in bytes, computed from its
+     * pixel format and size, and its TextureCategory. When a budget is set and the total goes over it eviction
+     * handlers are called at the start of the next frame, lowest priority value first, until the total is back
+     * within the budget. Handlers should drop Textures which can be rebuilt and which are not being displayed.
+     * A Texture which fails to be created calls the handlers immediately and retries once.
+     */
+    class TextureMemory {
+    public:
+        /**
+         * @brief An eviction handler.
+         * @details Called with the number of bytes to free. It may free more or less than requested.
+         */
+        using EvictionHandler = std::function<void(size_t bytes)>;
+
+        /**
+         * @struct Statistics
+         * @brief A snapshot of the texture memory in use.
+         */
+        struct Statistics {
+            size_t textures{0};                 ///< The number of Textures.
+            size_t bytes{0};                    ///< The total bytes held.
+            size_t peakBytes{0};                ///< The largest total held.
+            size_t budget{0};                   ///< The budget in bytes, 0 if there is none.
+            size_t evictions{0};                ///< The number of times eviction handlers were called.
+            size_t evictedBytes{0};             ///< The total bytes freed by eviction handlers.
+            std::array<size_t,static_cast<size_t>(TextureCategory::Count)> categoryTextures{};  ///< Textures by category.
+            std::array<size_t,static_cast<size_t>(TextureCategory::Count)> categoryBytes{};     ///< Bytes by category.
+            std::map<uint32_t,size_t> formatBytes{};    ///< Bytes by SDL_PixelFormatEnum.
+        };
+
+    protected:
+        /// The accounting record of an SDL_Texture.
+        struct Allocation {
+            size_t bytes{0};
+            uint32_t format{SDL_PIXELFORMAT_UNKNOWN};
+            TextureCategory category{TextureCategory::Other};
+        };
+
+        /// A registered eviction handler.
+        struct Handler {
+            int id{0};
+            int priority{0};
+            EvictionHandler handler{};
+        };
+
+        mutable std::mutex mMutex{};                        ///< Protect the records and statistics.
+        std::map<SDL_Texture*,Allocation> mAllocations{};   ///< The record of each SDL_Texture.
+        Statistics mStatistics{};                           ///< The running totals.
+        std::vector<Handler> mHandlers{};                   ///< Eviction handlers in priority order.
+        int mNextHandlerId{1};                              ///< The id of the next handler added.
+        bool mEvictionPending{false};                       ///< Set when the total goes over the budget.
+        bool mEvicting{false};                              ///< Set while handlers are called.
+
+        GraphicsModelFrameProtocol::slot_type mFrameProtocol{};    ///< Evict at the start of a frame.
+
+        TextureMemory();
+
+    public:
+        ~TextureMemory() = default;
+
+        TextureMemory(const TextureMemory &) = delete;
+
+        TextureMemory(TextureMemory &&) = delete;
+
+        TextureMemory &operator=(const TextureMemory &) = delete;
+
+        TextureMemory &operator=(TextureMemory &&) = delete;
+
+        /**
+         * @brief Get the TextureMemory singleton.
+         * @details The singleton is never destroyed. Textures held by other singletons, such as the ImageStore,
+         * are destroyed at exit and must still find it to account for their release.
+         */
+        static TextureMemory &getTextureMemory() {
+            static auto *instance = new TextureMemory{};
+            return *instance;
+        }
+
+        /**
+         * @brief The memory needed by a texture.
+         * @param format The pixel format from SDL_PixelFormatEnum.
+         * @param width The width in pixels.
+         * @param height The height in pixels.
+         * @return The size in bytes.
+         */
+        static size_t textureBytes(uint32_t format, int width, int height);
+
+        /// Get the name of a TextureCategory.
+        static const char *categoryName(TextureCategory category);
+
+        /// Record a texture adopted by a Texture.
+        void created(SDL_Texture *sdlTexture);
+
+        /// Remove the record of a texture being destroyed.
+        void destroyed(SDL_Texture *sdlTexture);
+
+        /// Set the category of a recorded texture.
+        void setCategory(SDL_Texture *sdlTexture, TextureCategory category);
+
+        /**
+         * @brief Set the budget.
+         * @param bytes The budget in bytes, 0 for no budget.
+         */
+        void setBudget(size_t bytes);
+
+        /// Get the budget in bytes, 0 if there is none.
+        [[nodiscard]] size_t budget() const;
+
+        /// Get the total bytes held.
+        [[nodiscard]] size_t bytes() const;
+
+        /// Get a snapshot of the texture memory in use.
+        [[nodiscard]] Statistics statistics() const;
+
+        /**
+         * @brief Add an eviction handler.
+         * @param priority Handlers with lower values are called first.
+         * @param handler The handler.
+         * @return An id used to remove the handler.
+         */
+        int addEvictionHandler(int priority, EvictionHandler handler);
+
+        /// Remove an eviction handler.
+        void removeEvictionHandler(int id);
+
+        /**
+         * @brief Call eviction handlers until the requested bytes are freed or there are no more handlers.
+         * @details Main thread only. Calls made from an eviction handler return 0.
+         * @param bytes The number of bytes to free.
+         * @return The number of bytes freed.
+         */
+        size_t evict(size_t bytes);
+
+        /**
+         * @brief Evict down to the budget if an eviction is pending.
+         * @details Called each frame from CommonSignals::frameSignal.
+         */
+        void processEviction();
+    };
+
+    /**
+     * @class TextureLock
+     * @brief A helper class to wrap the SDL_LockTexture and SDL_UnlockTexture API calls.
+     * @details The Texture must have SDL_TEXTUREACCESS_STREAMING access. The locked pixels are write only, the
+     * whole locked area should be written since SDL does not guarantee the previous contents. Changes are
+     * uploaded when the lock is destroyed.
+     */
+    class TextureLock {
+    protected:
+        int mStatus{-1};                ///< The return status returned by SDL_LockTexture.
+        SDL_Texture *mTexture;          ///< The texture being locked.
+        void *mPixels{nullptr};         ///< The locked pixels.
+        int mPitch{0};                  ///< The length of a locked row in bytes.
+
+    public:
+        TextureLock() = delete;
+
+        TextureLock(const TextureLock &) = delete;
+
+        TextureLock &operator=(const TextureLock &) = delete;
+
+        /**
+         * @brief Lock the whole Texture.
+         * @param texture The Texture.
+         */
+        explicit TextureLock(Texture &texture);
+
+        /**
+         * @brief Lock a rectangle of the Texture.
+         * @param texture The Texture.
+         * @param rect The rectangle to lock.
+         */
+        TextureLock(Texture &texture, const Rectangle &rect);
+
+        /**
+         * @brief Unlock the texture on destruction, uploading the changes.
+         */
+        ~TextureLock();
+
+        /// True if SDL_LockTexture returned 0.
+        explicit operator bool() const noexcept { return mStatus == 0; }
+
+        /// The locked pixels.
+        [[nodiscard]] void *pixels() const noexcept { return mPixels; }
+
+        /// The length of a locked row in bytes.
+        [[nodiscard]] int pitch() const noexcept { return mPitch; }
+
+        /// The start of a row of 32 bit pixels, relative to the locked rectangle.
+        [[nodiscard]] uint32_t *row(int y) const noexcept {
+            return reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(mPixels) + y * mPitch);
+        }
+    };
 }
+
+/// Write a summary of the texture memory in use to a stream.
+std::ostream &operator<<(std::ostream &strm, const rose::gm::TextureMemory::Statistics &statistics);
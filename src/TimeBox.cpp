@@ -88,7 +88,7 @@ namespace rose {
             }
         }
         if (redrawBackground) {
-            getApplication().redrawBackground();
+            getApplication().redrawWindow(getWindow());
         }
     }
 
@@ -135,7 +135,7 @@ namespace rose {
         if (auto first = begin(); first != end()) {
             if (auto hmLabel = (*first)->getNode<TextLabel>(); hmLabel) {
                 if (hmLabel->setText(date.str()))
-                    getApplication().redrawBackground();
+                    getApplication().redrawWindow(getWindow());
             }
         }
     }
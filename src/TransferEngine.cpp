@@ -0,0 +1,245 @@
+/**
+ * @file TransferEngine.cpp
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-06-28
+ */
+
+#include "TransferEngine.h"
+#include <iostream>
+
+namespace rose {
+
+    TransferEngine::TransferEngine() {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        mMulti = curl_multi_init();
+        mThread = std::thread(&TransferEngine::run, this);
+    }
+
+    TransferEngine::~TransferEngine() {
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            mRun = false;
+        }
+        mCondition.notify_all();
+        if (mThread.joinable())
+            mThread.join();
+
+        for (auto easy : mIdleHandles)
+            curl_easy_cleanup(easy);
+        curl_multi_cleanup(mMulti);
+        curl_global_cleanup();
+    }
+
+    void TransferEngine::submit(Request request) {
+        auto transfer = std::make_unique<Transfer>();
+        transfer->request = std::move(request);
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            mQueue.emplace_back(std::move(transfer));
+        }
+        mCondition.notify_one();
+    }
+
+    void TransferEngine::setConnectionLimits(long maxHost, long maxTotal) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mMaxHostConnections = maxHost;
+        mMaxTotalConnections = maxTotal;
+        mSettingsChanged = true;
+    }
+
+    void TransferEngine::setTimeout(long seconds) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mTimeout = seconds;
+    }
+
+    void TransferEngine::setAcceptEncoding(bool acceptEncoding) {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mAcceptEncoding = acceptEncoding;
+    }
+
+    TransferEngine::Statistics TransferEngine::statistics() const {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return mStatistics;
+    }
+
+    void TransferEngine::resetStatistics() {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mStatistics = Statistics{};
+    }
+
+    size_t TransferEngine::writeCallback(char *ptr, size_t size, size_t nmemb, void *userdata) {
+        auto transfer = static_cast<Transfer *>(userdata);
+        auto length = size * nmemb;
+        transfer->bytesDelivered += static_cast<curl_off_t>(length);
+        if (transfer->request.data && !transfer->request.data(ptr, length))
+            return 0;
+        return length;
+    }
+
+    size_t TransferEngine::headerCallback(char *ptr, size_t size, size_t nmemb, void *userdata) {
+        auto transfer = static_cast<Transfer *>(userdata);
+        auto length = size * nmemb;
+        if (transfer->request.header)
+            transfer->request.header(std::string_view{ptr, length});
+        return length;
+    }
+
+    void TransferEngine::run() {
+        while (mRun) {
+            std::deque<std::unique_ptr<Transfer>> queue{};
+            {
+                std::unique_lock<std::mutex> lock{mMutex};
+                if (mActive.empty())
+                    mCondition.wait(lock, [this] { return !mRun || !mQueue.empty(); });
+                if (!mRun)
+                    break;
+
+                if (mSettingsChanged) {
+                    curl_multi_setopt(mMulti, CURLMOPT_MAX_HOST_CONNECTIONS, mMaxHostConnections);
+                    curl_multi_setopt(mMulti, CURLMOPT_MAX_TOTAL_CONNECTIONS, mMaxTotalConnections);
+                    curl_multi_setopt(mMulti, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+                    mSettingsChanged = false;
+                }
+                queue.swap(mQueue);
+            }
+
+            startQueued(queue);
+
+            int running = 0;
+            curl_multi_perform(mMulti, &running);
+            completeFinished();
+
+            // Wait for socket activity, new requests are picked up at the end of the wait.
+            if (!mActive.empty())
+                curl_multi_wait(mMulti, nullptr, 0, 50, nullptr);
+        }
+
+        abandonAll();
+    }
+
+    void TransferEngine::abandonAll() {
+        std::deque<std::unique_ptr<Transfer>> queue{};
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            queue.swap(mQueue);
+        }
+
+        Response response{};
+        response.result = CURLE_ABORTED_BY_CALLBACK;
+        for (auto &transfer : queue)
+            if (transfer->request.completion)
+                transfer->request.completion(response);
+
+        for (auto &[easy, transfer] : mActive) {
+            curl_multi_remove_handle(mMulti, easy);
+            releaseHandle(*transfer);
+            if (transfer->request.completion)
+                transfer->request.completion(response);
+        }
+        mActive.clear();
+    }
+
+    void TransferEngine::releaseHandle(Transfer &transfer) {
+        curl_slist_free_all(transfer.headers);
+        transfer.headers = nullptr;
+        if (transfer.easy)
+            mIdleHandles.push_back(transfer.easy);
+        transfer.easy = nullptr;
+    }
+
+    void TransferEngine::startQueued(std::deque<std::unique_ptr<Transfer>> &queue) {
+        long timeout;
+        bool acceptEncoding;
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            timeout = mTimeout;
+            acceptEncoding = mAcceptEncoding;
+        }
+
+        while (!queue.empty()) {
+            auto transfer = std::move(queue.front());
+            queue.pop_front();
+
+            if (mIdleHandles.empty()) {
+                transfer->easy = curl_easy_init();
+            } else {
+                transfer->easy = mIdleHandles.back();
+                mIdleHandles.pop_back();
+                curl_easy_reset(transfer->easy);
+            }
+
+            if (!transfer->easy) {
+                if (transfer->request.completion)
+                    transfer->request.completion(Response{});
+                continue;
+            }
+
+            for (auto &header : transfer->request.headers)
+                transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+
+            auto easy = transfer->easy;
+            curl_easy_setopt(easy, CURLOPT_URL, transfer->request.url.c_str());
+            curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &TransferEngine::writeCallback);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+            curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &TransferEngine::headerCallback);
+            curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer.get());
+            curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(easy, CURLOPT_TIMEOUT, timeout);
+            if (acceptEncoding)
+                curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+
+            if (curl_multi_add_handle(mMulti, easy) == CURLM_OK) {
+                mActive[easy] = std::move(transfer);
+            } else {
+                releaseHandle(*transfer);
+                if (transfer->request.completion)
+                    transfer->request.completion(Response{});
+            }
+        }
+    }
+
+    void TransferEngine::completeFinished() {
+        int messages = 0;
+        while (auto message = curl_multi_info_read(mMulti, &messages)) {
+            if (message->msg != CURLMSG_DONE)
+                continue;
+
+            auto easy = message->easy_handle;
+            auto active = mActive.find(easy);
+            if (active == mActive.end())
+                continue;
+            auto transfer = std::move(active->second);
+            mActive.erase(active);
+
+            Response response{};
+            response.result = message->data.result;
+            if (response.result == CURLE_OK)
+                curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &response.status);
+            else
+                std::cerr << __PRETTY_FUNCTION__ << ' ' << transfer->request.url << ' '
+                          << curl_easy_strerror(response.result) << '\n';
+            curl_easy_getinfo(easy, CURLINFO_SIZE_DOWNLOAD_T, &response.bytesReceived);
+            curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME, &response.totalTime);
+            response.bytesDelivered = transfer->bytesDelivered;
+
+            {
+                std::lock_guard<std::mutex> lockGuard{mMutex};
+                ++mStatistics.transfers;
+                if (response.result != CURLE_OK)
+                    ++mStatistics.failures;
+                mStatistics.bytesReceived += response.bytesReceived;
+                mStatistics.bytesDelivered += response.bytesDelivered;
+                mStatistics.transferTime += response.totalTime;
+            }
+
+            curl_multi_remove_handle(mMulti, easy);
+            releaseHandle(*transfer);
+
+            if (transfer->request.completion)
+                transfer->request.completion(response);
+        }
+    }
+}
@@ -0,0 +1,181 @@
+/**
+ * @file TransferEngine.h
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-06-28
+ * @brief Perform HTTP transfers on a single curl multi handle driven by a dedicated I/O thread.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+namespace rose {
+
+    /**
+     * @class TransferEngine
+     * @brief Perform HTTP transfers on a single curl multi handle driven by a dedicated I/O thread.
+     * @details All transfers share the connection cache of one multi handle so connections to the same host
+     * are reused, and the number of concurrent connections to each host is bounded. Transfers are queued by
+     * submit() from any thread. The data, header and completion callbacks of a transfer are called on the
+     * I/O thread and must not block.
+     */
+    class TransferEngine {
+    public:
+        /// The status reported when a transfer fails without an HTTP response.
+        static constexpr long TransferFailed = 599;
+
+        /**
+         * @struct Response
+         * @brief The result of a transfer.
+         */
+        struct Response {
+            long status{TransferFailed};        ///< The HTTP status, or TransferFailed.
+            CURLcode result{CURLE_OK};          ///< The curl result code.
+            curl_off_t bytesReceived{0};        ///< Body bytes received over the wire.
+            curl_off_t bytesDelivered{0};       ///< Body bytes delivered to the data callback after decoding.
+            double totalTime{0.};               ///< Total transfer time in seconds.
+        };
+
+        /**
+         * @struct Statistics
+         * @brief Totals over all completed transfers.
+         */
+        struct Statistics {
+            size_t transfers{0};                ///< Transfers completed.
+            size_t failures{0};                 ///< Transfers which failed without an HTTP response.
+            curl_off_t bytesReceived{0};        ///< Body bytes received over the wire.
+            curl_off_t bytesDelivered{0};       ///< Body bytes delivered after decoding.
+            double transferTime{0.};            ///< Sum of transfer times in seconds.
+        };
+
+        /// Receive a block of body data, return false to abort the transfer.
+        using DataCallback = std::function<bool(const char *data, size_t size)>;
+
+        /// Receive one response header line.
+        using HeaderCallback = std::function<void(std::string_view header)>;
+
+        /// Receive the result of a transfer.
+        using CompletionCallback = std::function<void(const Response &response)>;
+
+        /**
+         * @struct Request
+         * @brief A transfer request.
+         */
+        struct Request {
+            std::string url{};                  ///< The URL to fetch.
+            std::vector<std::string> headers{}; ///< Additional request headers.
+            DataCallback data{};                ///< Body data receiver.
+            HeaderCallback header{};            ///< Optional response header receiver.
+            CompletionCallback completion{};    ///< Called when the transfer is complete.
+        };
+
+    protected:
+        /// A transfer in progress.
+        struct Transfer {
+            Request request{};
+            CURL *easy{nullptr};
+            curl_slist *headers{nullptr};
+            curl_off_t bytesDelivered{0};
+        };
+
+        TransferEngine();
+
+        CURLM *mMulti{nullptr};                     ///< The multi handle.
+        std::vector<CURL*> mIdleHandles{};          ///< Easy handles available for reuse, I/O thread only.
+        std::map<CURL*, std::unique_ptr<Transfer>> mActive{};  ///< Transfers on the multi handle, I/O thread only.
+
+        mutable std::mutex mMutex{};                ///< Protect the queue, settings and statistics.
+        std::condition_variable mCondition{};       ///< Wake the I/O thread when idle.
+        std::deque<std::unique_ptr<Transfer>> mQueue{};    ///< Transfers waiting to start.
+        std::atomic_bool mRun{true};                ///< Cleared to stop the I/O thread.
+        std::thread mThread{};                      ///< The I/O thread.
+
+        long mMaxHostConnections{4};                ///< Concurrent connections allowed per host.
+        long mMaxTotalConnections{16};              ///< Concurrent connections allowed in total.
+        long mTimeout{60};                          ///< Transfer timeout in seconds.
+        bool mAcceptEncoding{true};                 ///< Negotiate compressed content encodings.
+        Statistics mStatistics{};                   ///< Totals over completed transfers.
+        bool mSettingsChanged{true};                ///< Settings must be applied to the multi handle.
+
+        /// The I/O thread.
+        void run();
+
+        /// Start queued transfers, I/O thread only.
+        void startQueued(std::deque<std::unique_ptr<Transfer>> &queue);
+
+        /// Complete finished transfers, I/O thread only.
+        void completeFinished();
+
+        /// Fail all transfers which have not completed, called by the I/O thread at shutdown.
+        void abandonAll();
+
+        /// Return an easy handle to the idle pool, I/O thread only.
+        void releaseHandle(Transfer &transfer);
+
+        static size_t writeCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
+
+        static size_t headerCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
+
+    public:
+        ~TransferEngine();
+
+        TransferEngine(const TransferEngine&) = delete;
+
+        TransferEngine(TransferEngine&&) = delete;
+
+        TransferEngine& operator=(const TransferEngine&) = delete;
+
+        TransferEngine& operator=(TransferEngine&&) = delete;
+
+        static TransferEngine& getEngine() {
+            static TransferEngine instance{};
+            return instance;
+        }
+
+        /**
+         * @brief Queue a transfer.
+         * @param request The request.
+         */
+        void submit(Request request);
+
+        /**
+         * @brief Set connection limits.
+         * @param maxHost The maximum number of concurrent connections to one host.
+         * @param maxTotal The maximum number of concurrent connections.
+         */
+        void setConnectionLimits(long maxHost, long maxTotal);
+
+        /**
+         * @brief Set the timeout for transfers started after the call.
+         * @param seconds The timeout in seconds.
+         */
+        void setTimeout(long seconds);
+
+        /**
+         * @brief Negotiate compressed transfers for transfers started after the call.
+         * @details When enabled an Accept-Encoding header listing every encoding libcurl supports is sent, and
+         * the body is decoded before it is passed to the data callback. Enabled by default.
+         * @param acceptEncoding True to enable.
+         */
+        void setAcceptEncoding(bool acceptEncoding);
+
+        /// Get the totals over all completed transfers.
+        Statistics statistics() const;
+
+        /// Reset the transfer totals.
+        void resetStatistics();
+    };
+}
+
@@ -70,6 +70,8 @@ namespace rose {
         static constexpr std::string_view SetAppSize{"SetAppSize"};
         static constexpr std::string_view SetAppPosition{"SetAppPosition"};
         static constexpr std::string_view SetAppState{"SetAppState"};
+        static constexpr std::string_view SetFramePacing{"SetFramePacing"};
+        static constexpr std::string_view SetFrameRate{"SetFrameRate"};
     }
 
     struct FrameSettings {
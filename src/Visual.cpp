@@ -43,8 +43,10 @@ namespace rose {
     void Window::generateBaseTexture(gm::Context &context, const Position<int> &containerPosition) {
         if (baseTextureNeeded(containerPosition)) {
             mBaseTexture = gm::Texture{context, mScreenRect.size()};
+            mBaseTexture.setCategory(gm::TextureCategory::Window);
         }
 
+        mBaseTextureDirty = false;
         gm::RenderTargetGuard renderTargetGuard(context, mBaseTexture);
         context.setDrawColor(color::DarkBaseColor);
         context.renderClear();
@@ -64,6 +66,22 @@ namespace rose {
         }
     }
 
+    void Window::drawBaseTexture(gm::Context &context, const Position<int> &containerPosition,
+                                 const Rectangle &area) {
+        setScreenRectangle(containerPosition);
+        auto rect = mScreenRect.intersection(area);
+        if (rect.w <= 0 || rect.h <= 0)
+            return;
+
+        if (mBaseTexture) {
+            context.renderCopy(mBaseTexture, Rectangle{rect.x - mScreenRect.x, rect.y - mScreenRect.y, rect.w, rect.h},
+                               rect);
+        } else {
+            gm::ClipRectangleGuard clipRectangleGuard{context, rect};
+            draw(context, containerPosition);
+        }
+    }
+
     void Window::draw(gm::Context &context, const Position<int> &containerPosition) {
         setScreenRectangle(containerPosition);
         for (auto &content : (*this)) {
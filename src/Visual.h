@@ -316,6 +316,7 @@ namespace rose {
     protected:
         bool mModalWindow{};
         gm::Texture mBaseTexture{};     ///< The base texture which animations draw over.
+        bool mBaseTextureDirty{true};   ///< The contents have changed since the base texture was generated.
 
     public:
         ~Window() override = default;
@@ -350,6 +351,13 @@ namespace rose {
             setScreenRectangle(containerPosition);
             return !mBaseTexture || mBaseTexture.getSize() != mScreenRect.size();
         }
+
+        /// Mark the base texture out of date so it is generated again before the next frame.
+        void setBaseTextureDirty() { mBaseTextureDirty = true; }
+
+        /// True if the base texture is out of date.
+        [[nodiscard]] bool baseTextureDirty() const { return mBaseTextureDirty; }
+
         /**
          * @brief Create a Texture for the Window that can be drawn over by animations.
          * @param context The gm::Context to use.
@@ -364,6 +372,14 @@ namespace rose {
          */
         void drawBaseTexture(gm::Context &context, const Position<int> &containerPosition);
 
+        /**
+         * @brief Draw the part of the base texture for the window inside an area of the screen.
+         * @param context The gm::Context to use.
+         * @param containerPosition The container position.
+         * @param area The area of the screen.
+         */
+        void drawBaseTexture(gm::Context &context, const Position<int> &containerPosition, const Rectangle &area);
+
         /// Layout the contents of the Window
         Rectangle layout(gm::Context &context, const Rectangle &screenRect) override;
 
@@ -6,10 +6,13 @@
  */
 
 #include "WebCache.h"
+#include "TimerTick.h"
+#include "TransferEngine.h"
+#include <array>
+#include <cctype>
+#include <set>
 #include <iomanip>
-#include <curlpp/Easy.hpp>
-#include <curlpp/Options.hpp>
-#include <curlpp/Infos.hpp>
+#include <sstream>
 
 namespace rose {
     WebCache::WebCache(const std::string& rootUri, const path& xdgDir, const std::string& storeRoot, std::chrono::system_clock::duration duration) {
@@ -25,49 +28,531 @@ namespace rose {
 
         mFrameProtocol = GraphicsModelFrameProtocol::createSlot();
         mFrameProtocol->receiver = [&](uint32_t frame) {
-            if (!processFutures()) {
+            if (mRefreshDue.exchange(false))
+                refreshExpired();
+            if (!mRetry.empty())
+                processRetries();
+            if (!processFutures() && !mRefreshScheduled && mRetry.empty()) {
                 CommonSignals::getCommonSignals().frameSignal.disconnect(mFrameProtocol);
             }
         };
 
         mStoreStatus = status(mStoreRoot);
+        loadIndex();
     }
 
-    WebCache::result_t
-    WebCache::fetch(WebCache::key_t key, const std::string &itemUrl, const path &itemPath, const path &tempPath,
-                    std::optional<time_t> cacheFileTime) {
-        std::ofstream strm{tempPath.c_str(), std::ofstream::trunc};
-        long responseCode{599};
+    WebCache::~WebCache() {
+        if (mTimerTick)
+            mTimerTick->minuteSignal.disconnect(mRefreshSlot);
+        saveIndex();
+    }
 
-        if (strm) {
-            try {
-                std::list<std::string> headers;
+    void WebCache::loadIndex() {
+        auto indexPath = mStoreRoot;
+        indexPath.append(IndexName);
 
-                if (cacheFileTime) {
-                    std::stringstream ss;
-                    ss << "If-Modified-Since: " << std::put_time(std::gmtime(&cacheFileTime.value()), "%a, %d %b %Y %T %Z");
-                    headers.push_back(ss.str());
+        std::error_code ec{};
+        mIndex.clear();
+        if (std::ifstream strm{indexPath}; strm) {
+            int pending;
+            IndexEntry entry{};
+            std::string name{};
+            while (strm >> pending >> entry.size >> entry.lastAccess && std::getline(strm >> std::ws, name)) {
+                entry.pending = pending != 0;
+                mIndex[name] = entry;
+                mLastAccess = std::max(mLastAccess, entry.lastAccess);
+            }
+
+            // Remove temp files of fetches which did not complete and entries whose file is gone.
+            for (auto entry = mIndex.begin(); entry != mIndex.end();) {
+                auto itemPath = mStoreRoot;
+                itemPath.append(entry->first);
+                if (entry->second.pending) {
+                    auto tempPath = mStoreRoot;
+                    tempPath.append('.' + entry->first);
+                    remove(tempPath, ec);
+                    entry->second.pending = false;
+                    mIndexDirty = true;
+                }
+                if (!exists(itemPath, ec)) {
+                    entry = mIndex.erase(entry);
+                    mIndexDirty = true;
+                } else {
+                    ++entry;
+                }
+            }
+        } else {
+            // No index, walk the store once to build it.
+            for (auto &dirEntry : recursive_directory_iterator{mStoreRoot, ec}) {
+                if (!dirEntry.is_regular_file(ec))
+                    continue;
+                auto fileName = dirEntry.path().filename().string();
+                if (fileName.front() == '.') {
+                    auto isMeta = fileName.size() > 5 && fileName.substr(fileName.size() - 5) == ".meta";
+                    if (fileName != IndexName && !isMeta)
+                        remove(dirEntry.path(), ec);
+                    continue;
                 }
 
-                curlpp::options::Url url(itemUrl);
-                curlpp::options::WriteStream ws(&strm);
-                curlpp::Easy request;
-                request.setOpt(new curlpp::options::HttpHeader(headers));
-                request.setOpt(url);
-                request.setOpt(ws);
-                request.perform();
-                responseCode = curlpp::infos::ResponseCode::get(request);
-            } catch (const cURLpp::RuntimeError &e) {
-                std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
-            } catch (const cURLpp::LogicError &e) {
-                std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
+                IndexEntry entry{};
+                entry.size = dirEntry.file_size(ec);
+                entry.lastAccess = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        fileClockToSystemClock(dirEntry.last_write_time(ec)).time_since_epoch()).count();
+                mLastAccess = std::max(mLastAccess, entry.lastAccess);
+                mIndex[dirEntry.path().lexically_relative(mStoreRoot).generic_string()] = entry;
+            }
+            mIndexDirty = true;
+        }
+    }
+
+    void WebCache::saveIndex() {
+        if (!mIndexDirty)
+            return;
+
+        auto indexPath = mStoreRoot;
+        indexPath.append(IndexName);
+        auto tempPath = indexPath;
+        tempPath += ".tmp";
+
+        if (std::ofstream strm{tempPath, std::ofstream::trunc}; strm) {
+            for (auto &[name, entry] : mIndex)
+                strm << (entry.pending ? 1 : 0) << ' ' << entry.size << ' ' << entry.lastAccess << ' ' << name << '\n';
+            if (!strm)
+                return;
+        }
+
+        std::error_code ec{};
+        rename(tempPath, indexPath, ec);
+        if (ec)
+            std::cerr << __PRETTY_FUNCTION__ << ' ' << indexPath << ' ' << ec.message() << '\n';
+        else
+            mIndexDirty = false;
+    }
+
+    void WebCache::touchIndex(const std::string &itemName, bool pending) {
+        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        mLastAccess = std::max(now, mLastAccess + 1);
+
+        auto &entry = mIndex[itemName];
+        entry.lastAccess = mLastAccess;
+        if (pending)
+            entry.pending = true;
+        mIndexDirty = true;
+    }
+
+    void WebCache::setStoreBudget(std::uintmax_t maxBytes, size_t maxItems) {
+        mMaxStoreBytes = maxBytes;
+        mMaxStoreItems = maxItems;
+        enforceBudget();
+        saveIndex();
+    }
+
+    void WebCache::enforceBudget() {
+        if (!mMaxStoreBytes && !mMaxStoreItems)
+            return;
+
+        std::uintmax_t bytes;
+        size_t items;
+        std::tie(bytes, items) = storeUsage();
+        auto overBudget = [&]() {
+            return (mMaxStoreBytes && bytes > mMaxStoreBytes) || (mMaxStoreItems && items > mMaxStoreItems);
+        };
+        if (!overBudget())
+            return;
+
+        std::set<std::string> managed{};
+        for (auto &item : mItemMap)
+            managed.insert(translateItemLocalId(item.second));
+
+        // Candidates ordered with unmanaged items first, then by last access.
+        std::vector<std::tuple<bool, long long, std::string>> candidates{};
+        for (auto &[name, entry] : mIndex)
+            if (!entry.pending)
+                candidates.emplace_back(managed.find(name) != managed.end(), entry.lastAccess, name);
+        std::sort(candidates.begin(), candidates.end());
+
+        std::error_code ec{};
+        for (auto &candidate : candidates) {
+            if (!overBudget())
+                break;
+            auto &name = std::get<2>(candidate);
+            auto itemPath = mStoreRoot;
+            itemPath.append(name);
+            auto metaPath = mStoreRoot;
+            metaPath.append('.' + name + ".meta");
+            remove(itemPath, ec);
+            remove(metaPath, ec);
+
+            bytes -= mIndex[name].size;
+            --items;
+            mIndex.erase(name);
+            mIndexDirty = true;
+        }
+    }
+
+    void WebCache::setRefreshSchedule(std::shared_ptr<TimerTick> timerTick, std::chrono::seconds jitter) {
+        mRefreshJitter = jitter;
+        mItemExpiry.clear();
+        mRefreshScheduled = true;
+
+        mRefreshSlot = TickProtocol::createSlot();
+        mRefreshSlot->receiver = [&](int minutes) {
+            // Runs on the timer thread, the check is made from the frame signal on the main thread.
+            mRefreshDue = true;
+        };
+
+        mTimerTick = std::move(timerTick);
+        if (mTimerTick)
+            mTimerTick->minuteSignal.connect(mRefreshSlot);
+
+        CommonSignals::getCommonSignals().frameSignal.connect(mFrameProtocol);
+    }
+
+    std::chrono::system_clock::time_point WebCache::computeExpiry(const item_map_t::value_type &item) {
+        auto itemPath = mStoreRoot;
+        itemPath.append(translateItemLocalId(item.second));
+
+        std::error_code ec{};
+        auto writeTime = last_write_time(itemPath, ec);
+        if (ec)
+            return std::chrono::system_clock::time_point{};
+
+        WebCacheMetadata metadata{};
+        metadata.read(itemMetadataPath(item.second));
+        auto validFrom = metadata.fetchTime.time_since_epoch().count() ? metadata.fetchTime :
+                         fileClockToSystemClock(writeTime);
+
+        std::chrono::seconds jitter{0};
+        if (mRefreshJitter.count() > 0)
+            jitter = std::chrono::seconds{std::hash<std::string>{}(mRootURI + item.second) %
+                                          static_cast<size_t>(mRefreshJitter.count() + 1)};
+
+        return validFrom + mCacheValidDuration + jitter;
+    }
+
+    void WebCache::refreshExpired() {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto now = std::chrono::system_clock::now();
+        for (auto &item : mItemMap) {
+            auto expiry = mItemExpiry.find(item.first);
+            if (expiry == mItemExpiry.end())
+                expiry = mItemExpiry.emplace(item.first, computeExpiry(item)).first;
+
+            if (expiry->second <= now) {
+                // Hold the item while the fetch is in flight, the expiry is recomputed when it completes.
+                expiry->second = std::chrono::system_clock::time_point::max();
+                asyncFetchItem(item);
+            }
+        }
+        saveIndex();
+    }
+
+    uint32_t WebCacheMetadata::crc32(uint32_t crc, const char *data, size_t size) {
+        static const auto table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t n = 0; n < t.size(); ++n) {
+                auto c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1u) ? 0xEDB88320u ^ (c >> 1u) : c >> 1u;
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFFu] ^ (crc >> 8u);
+        return ~crc;
+    }
+
+    std::string WebCache::urlHost(const std::string &url) {
+        auto start = url.find("://");
+        start = start == std::string::npos ? 0 : start + 3;
+        auto end = url.find_first_of("/?#", start);
+        auto host = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (auto at = host.rfind('@'); at != std::string::npos)
+            host.erase(0, at + 1);
+        return host;
+    }
+
+    void WebCache::completeFetch(key_t key, long status, const WebCachePayload &payload) {
+        mItemExpiry.erase(key);
+
+        auto item = mItemMap.find(key);
+        if (item != mItemMap.end()) {
+            auto itemName = translateItemLocalId(item->second);
+            auto itemPath = mStoreRoot;
+            itemPath.append(itemName);
+            std::error_code ec{};
+            if (auto size = file_size(itemPath, ec); !ec) {
+                auto &entry = mIndex[itemName];
+                entry.size = size;
+                entry.pending = false;
+                touchIndex(itemName);
+            } else {
+                mIndex.erase(itemName);
+                mIndexDirty = true;
+            }
+        }
+
+        if (item == mItemMap.end() || !retryable(status)) {
+            if (item != mItemMap.end())
+                mHosts[urlHost(constructUrl(item->second))].failures = 0;
+            mRetry.erase(key);
+            if (!mServeStale || (status != 304 && status != CacheUnchanged))
+                transmitLoaded(key, status, payload);
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto &retry = mRetry[key];
+        ++retry.attempts;
+
+        auto &host = mHosts[urlHost(constructUrl(item->second))];
+        ++host.failures;
+        if (host.failures >= mHostFailureBudget && host.pausedUntil <= now) {
+            host.pausedUntil = now + mHostPause;
+            std::cerr << __PRETTY_FUNCTION__ << " pausing fetches from " << urlHost(constructUrl(item->second))
+                      << " after " << host.failures << " failures\n";
+        }
+
+        if (retry.attempts >= mRetryLimit) {
+            mRetry.erase(key);
+            transmitLoaded(key, status);
+            return;
+        }
+
+        // Exponential backoff with a random jitter of up to half the delay.
+        auto delay = std::min(std::chrono::milliseconds{mRetryBase.count() << std::min(retry.attempts - 1, 20u)},
+                              mRetryMaximum);
+        std::uniform_int_distribution<long long> jitter{0, delay.count() / 2};
+        retry.nextAttempt = now + delay - std::chrono::milliseconds{jitter(mRandom)};
+
+        if (host.pausedUntil > now) {
+            retry.nextAttempt = std::max(retry.nextAttempt, host.pausedUntil);
+            transmitLoaded(key, CacheHostPaused);
+        } else {
+            transmitLoaded(key, CacheRetryScheduled);
+        }
+    }
+
+    void WebCache::processRetries() {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        auto now = std::chrono::steady_clock::now();
+        for (auto &[key, retry] : mRetry) {
+            if (retry.nextAttempt > now)
+                continue;
+
+            auto item = mItemMap.find(key);
+            if (item == mItemMap.end())
+                continue;
+
+            if (auto &host = mHosts[urlHost(constructUrl(item->second))]; host.pausedUntil > now) {
+                retry.nextAttempt = host.pausedUntil;
+                continue;
             }
 
-            strm.close();
-            if (responseCode == 200)
-                rename(tempPath, itemPath);
+            // Hold the item until the fetch completes.
+            retry.nextAttempt = std::chrono::steady_clock::time_point::max();
+            asyncFetchItem(*item, true);
         }
-        return std::make_tuple(responseCode, key);
+        saveIndex();
+
+        // Items removed from the cache are not retried.
+        for (auto retry = mRetry.begin(); retry != mRetry.end();) {
+            if (mItemMap.find(retry->first) == mItemMap.end())
+                retry = mRetry.erase(retry);
+            else
+                ++retry;
+        }
+    }
+
+    bool WebCacheMetadata::read(const path &metaPath) {
+        std::ifstream strm{metaPath};
+        if (!strm)
+            return false;
+
+        std::string line{};
+        while (std::getline(strm, line)) {
+            if (auto colon = line.find(':'); colon != std::string::npos) {
+                auto name = line.substr(0, colon);
+                auto value = colon + 2 <= line.size() ? line.substr(colon + 2) : std::string{};
+                if (name == "ETag")
+                    eTag = value;
+                else if (name == "Last-Modified")
+                    lastModified = value;
+                else if (name == "Fetched")
+                    fetchTime = std::chrono::system_clock::from_time_t(std::strtol(value.c_str(), nullptr, 10));
+                else if (name == "CRC32")
+                    checksum = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 16));
+                else if (name == "Size")
+                    size = std::strtoull(value.c_str(), nullptr, 10);
+            }
+        }
+        return true;
+    }
+
+    bool WebCacheMetadata::write(const path &metaPath) const {
+        std::ofstream strm{metaPath, std::ofstream::trunc};
+        if (!strm)
+            return false;
+
+        if (!eTag.empty())
+            strm << "ETag: " << eTag << '\n';
+        if (!lastModified.empty())
+            strm << "Last-Modified: " << lastModified << '\n';
+        strm << "Fetched: " << std::chrono::system_clock::to_time_t(fetchTime) << '\n';
+        if (checksum)
+            strm << "CRC32: " << std::hex << std::setw(8) << std::setfill('0') << checksum.value() << std::dec
+                 << "\nSize: " << size << '\n';
+        return static_cast<bool>(strm);
+    }
+
+    void WebCacheMetadata::captureHeader(std::string_view header) {
+        while (!header.empty() && (header.back() == '\r' || header.back() == '\n' || header.back() == ' '))
+            header.remove_suffix(1);
+
+        if (header.substr(0, 5) == "HTTP/") {
+            eTag.clear();
+            lastModified.clear();
+            return;
+        }
+
+        auto colon = header.find(':');
+        if (colon == std::string_view::npos)
+            return;
+
+        auto name = header.substr(0, colon);
+        auto value = header.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ')
+            value.remove_prefix(1);
+
+        auto nameIs = [&name](std::string_view target) {
+            return name.size() == target.size() &&
+                   std::equal(name.begin(), name.end(), target.begin(), [](char a, char b) {
+                       return std::tolower(static_cast<unsigned char>(a)) == b;
+                   });
+        };
+
+        if (nameIs("etag"))
+            eTag = std::string{value};
+        else if (nameIs("last-modified"))
+            lastModified = std::string{value};
+    }
+
+    WebCachePayload WebCache::readPayload(const path &filePath) {
+        std::ifstream strm{filePath, std::ifstream::binary};
+        if (!strm)
+            return nullptr;
+
+        std::error_code ec{};
+        auto size = file_size(filePath, ec);
+        auto payload = std::make_shared<std::string>();
+        if (!ec)
+            payload->reserve(size);
+        payload->assign(std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>());
+        return payload;
+    }
+
+    std::future<WebCache::fetch_result_t>
+    WebCache::fetchAsync(WebCache::key_t key, const std::string &itemUrl, const path &itemPath, const path &tempPath,
+                         std::optional<time_t> cacheFileTime, const path &metaPath, WebCacheMetadata metadata,
+                         bool keepPayload) {
+        auto promise = std::make_shared<std::promise<fetch_result_t>>();
+        auto future = promise->get_future();
+
+        auto strm = std::make_shared<std::ofstream>(tempPath.c_str(), std::ofstream::trunc);
+        if (!*strm) {
+            promise->set_value(std::make_tuple(TransferEngine::TransferFailed, key, nullptr));
+            return future;
+        }
+
+        TransferEngine::Request request{};
+        request.url = itemUrl;
+
+        // Validators are only sent when there is a local copy to revalidate.
+        if (cacheFileTime) {
+            if (!metadata.eTag.empty())
+                request.headers.push_back("If-None-Match: " + metadata.eTag);
+
+            if (!metadata.lastModified.empty()) {
+                request.headers.push_back("If-Modified-Since: " + metadata.lastModified);
+            } else {
+                std::stringstream ss;
+                ss << "If-Modified-Since: "
+                   << std::put_time(std::gmtime(&cacheFileTime.value()), "%a, %d %b %Y %T %Z");
+                request.headers.push_back(ss.str());
+            }
+        }
+
+        auto received = std::make_shared<WebCacheMetadata>();
+        request.header = [received](std::string_view header) {
+            received->captureHeader(header);
+        };
+
+        auto body = keepPayload ? std::make_shared<std::string>() : nullptr;
+
+        received->checksum = 0;
+        request.data = [strm, received, body](const char *data, size_t size) -> bool {
+            received->checksum = WebCacheMetadata::crc32(received->checksum.value(), data, size);
+            received->size += size;
+            if (body)
+                body->append(data, size);
+            strm->write(data, static_cast<std::streamsize>(size));
+            return static_cast<bool>(*strm);
+        };
+
+        request.completion = [strm, promise, key, itemPath, tempPath, metaPath, metadata, received, body]
+                (const TransferEngine::Response &response) {
+            strm->close();
+            auto status = response.status;
+            if (status == 200 && metadata.checksum && metadata.checksum == received->checksum &&
+                metadata.size == received->size)
+                status = CacheUnchanged;
+
+            std::optional<WebCacheMetadata> update{};
+            std::error_code ec{};
+            if (status != 200)
+                remove(tempPath, ec);
+
+            if (status == CacheUnchanged) {
+                // The local copy is identical, keep it so consumers need not parse it again.
+                update = *received;
+            } else if (status == 200) {
+                rename(tempPath, itemPath, ec);
+                if (ec)
+                    std::cerr << __PRETTY_FUNCTION__ << ' ' << itemPath << ' ' << ec.message() << '\n';
+                else
+                    update = *received;
+            } else if (status == 304) {
+                // The local copy is current, keep it and start a new validity period.
+                update = metadata;
+                if (!received->eTag.empty())
+                    update->eTag = received->eTag;
+                if (!received->lastModified.empty())
+                    update->lastModified = received->lastModified;
+            }
+
+            if (update && !metaPath.empty()) {
+                update->fetchTime = std::chrono::system_clock::now();
+                update->write(metaPath);
+            }
+            WebCachePayload payload{};
+            if (status == 200 && !ec)
+                payload = body;
+            promise->set_value(std::make_tuple(status, key, payload));
+        };
+
+        TransferEngine::getEngine().submit(std::move(request));
+        return future;
+    }
+
+    WebCache::result_t
+    WebCache::fetch(WebCache::key_t key, const std::string &itemUrl, const path &itemPath, const path &tempPath,
+                    std::optional<time_t> cacheFileTime) {
+        auto[status, fetchKey, payload] = fetchAsync(key, itemUrl, itemPath, tempPath, cacheFileTime).get();
+        return std::make_tuple(status, fetchKey);
     }
 
 }
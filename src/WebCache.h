@@ -9,6 +9,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <filesystem>
@@ -16,6 +17,7 @@
 #include <mutex>
 #include <optional>
 #include <fstream>
+#include <random>
 #include <list>
 #include <utility>
 #include <future>
@@ -24,6 +26,8 @@
 
 namespace rose {
 
+    class TimerTick;
+
     struct WebCacheItem {
         uint32_t key;
         std::string_view name;
@@ -31,8 +35,60 @@ namespace rose {
 
     using WebCacheProtocol = Protocol<uint32_t,long>;
 
+    /// A shared, immutable copy of the content of a cache item.
+    using WebCachePayload = std::shared_ptr<const std::string>;
+
+    /// Protocol for delivering the content of a cache item with its key and status.
+    using WebCachePayloadProtocol = Protocol<uint32_t,long,WebCachePayload>;
+
     using namespace std::filesystem;
 
+    /**
+     * @struct WebCacheMetadata
+     * @brief The response validators and fetch time of a cache item.
+     * @details Stored in a sidecar file next to the item so revalidation uses the server's own validators
+     * rather than the local file time, which may be skewed on systems without a real time clock. The CRC32
+     * and size of the item body identify downloads which are identical to the local copy.
+     */
+    struct WebCacheMetadata {
+        std::string eTag{};                                     ///< The ETag returned by the server.
+        std::string lastModified{};                             ///< The Last-Modified value returned by the server.
+        std::chrono::system_clock::time_point fetchTime{};      ///< When the item was last fetched or revalidated.
+        std::optional<uint32_t> checksum{};                     ///< The CRC32 of the item body.
+        std::uintmax_t size{0};                                 ///< The size of the item body.
+
+        /**
+         * @brief Update a CRC32 with a block of data.
+         * @param crc The CRC of the preceding data, 0 to start.
+         * @param data The data.
+         * @param size The size of the data.
+         * @return The updated CRC.
+         */
+        static uint32_t crc32(uint32_t crc, const char *data, size_t size);
+
+        /**
+         * @brief Read metadata from a sidecar file.
+         * @param metaPath The sidecar path.
+         * @return True if the file was read.
+         */
+        bool read(const path &metaPath);
+
+        /**
+         * @brief Write metadata to a sidecar file.
+         * @param metaPath The sidecar path.
+         * @return True if the file was written.
+         */
+        bool write(const path &metaPath) const;
+
+        /**
+         * @brief Capture validators from a response header line.
+         * @details A status line resets the validators so only those of the final response are kept when
+         * redirects are followed.
+         * @param header The header line.
+         */
+        void captureHeader(std::string_view header);
+    };
+
     /**
      * @class WebCache
      * @brief Fetch web resources caching them in the local filesystem following XDG specifications.
@@ -44,9 +100,22 @@ namespace rose {
         using key_t = uint32_t;
         using local_id_t = std::string;
         using result_t = std::tuple<long, key_t>;
+        using fetch_result_t = std::tuple<long, key_t, WebCachePayload>;
         using item_map_t = std::map<key_t, local_id_t>;
 
-        using AsyncList = std::vector<std::future<result_t>>;
+        using AsyncList = std::vector<std::future<fetch_result_t>>;
+
+        /// Status transmitted for a local copy which is available but has not been revalidated.
+        static constexpr long CacheStale = 1001;
+
+        /// Status transmitted when a new copy was received which is identical to the local copy.
+        static constexpr long CacheUnchanged = 1002;
+
+        /// Status transmitted when a fetch failed and a retry has been scheduled.
+        static constexpr long CacheRetryScheduled = 1003;
+
+        /// Status transmitted when a fetch failed and fetches from the host are paused.
+        static constexpr long CacheHostPaused = 1004;
 
         /**
          * @brief Convert a filesystem time to a system clock time point.
@@ -76,6 +145,9 @@ namespace rose {
 
         WebCacheProtocol::signal_type cacheLoaded{};
 
+        /// Transmitted with cacheLoaded when payload delivery is enabled, see setPayloadDelivery().
+        WebCachePayloadProtocol::signal_type payloadLoaded{};
+
     protected:
         std::error_code mEc{};          ///< The last error code returned from a std::filesystem operation.
         std::string mRootURI{};         ///< The root URI for items in the cache.
@@ -90,23 +162,175 @@ namespace rose {
         /// The duration local files are considered valid. The interval between cache refresh checks.
         std::chrono::system_clock::duration mCacheValidDuration{};
 
-        void asyncFetchItem(item_map_t::value_type& item) {
+        bool mRefreshScheduled{false};                  ///< True when expired items are refreshed on schedule.
+        std::shared_ptr<TimerTick> mTimerTick{};        ///< The source of refresh schedule signals.
+        Protocol<int>::slot_type mRefreshSlot{};        ///< Receive minute signals from mTimerTick.
+        std::atomic_bool mRefreshDue{false};            ///< Set from the timer thread when a refresh check is due.
+        std::chrono::seconds mRefreshJitter{};          ///< The maximum per item delay added to the expiry time.
+
+        bool mServeStale{false};                        ///< True to announce local copies before revalidation.
+        bool mDeliverPayload{false};                    ///< True to deliver item content with payloadLoaded.
+        bool mLocalItemsAnnounced{false};               ///< True once local copies have been announced.
+
+        /// The time each item is next due to be refreshed, computed when needed.
+        std::map<key_t, std::chrono::system_clock::time_point> mItemExpiry{};
+
+        /// The retry state of an item whose last fetch failed.
+        struct RetryState {
+            unsigned attempts{0};                               ///< Consecutive failed attempts.
+            std::chrono::steady_clock::time_point nextAttempt{};    ///< When the next attempt may be made.
+        };
+
+        /// The failure state of a host.
+        struct HostState {
+            unsigned failures{0};                               ///< Consecutive failed fetches.
+            std::chrono::steady_clock::time_point pausedUntil{};    ///< Fetches are paused until this time.
+        };
+
+        /// An entry in the store index.
+        struct IndexEntry {
+            std::uintmax_t size{0};             ///< The size of the item file.
+            long long lastAccess{0};            ///< Last access in milliseconds since the epoch, strictly increasing.
+            bool pending{false};                ///< A fetch was started, a temp file may exist.
+        };
+
+        /// The store index keyed by item path relative to the store root.
+        std::map<std::string, IndexEntry> mIndex{};
+        bool mIndexDirty{false};                ///< The index has changed since it was saved.
+        long long mLastAccess{0};               ///< The most recent access stamp issued.
+        std::uintmax_t mMaxStoreBytes{0};       ///< The store byte budget, 0 for no limit.
+        size_t mMaxStoreItems{0};               ///< The store item budget, 0 for no limit.
+
+        /// The name of the persisted store index.
+        static constexpr std::string_view IndexName = ".index";
+
+        /**
+         * @brief Load the store index, removing temp files left by interrupted fetches.
+         * @details If there is no index it is rebuilt by walking the store once.
+         */
+        void loadIndex();
+
+        /// Save the store index if it has changed.
+        void saveIndex();
+
+        /**
+         * @brief Record an access to an item in the store index.
+         * @param itemName The item path relative to the store root.
+         * @param pending True when a fetch is starting.
+         */
+        void touchIndex(const std::string &itemName, bool pending = false);
+
+        /**
+         * @brief Remove items from the store until it is within budget.
+         * @details Items which are no longer in the item map are removed first, then the least recently
+         * accessed. Items with a fetch in flight are not removed.
+         */
+        void enforceBudget();
+
+        std::map<key_t, RetryState> mRetry{};                   ///< Items waiting to be retried.
+        std::map<std::string, HostState> mHosts{};              ///< Failure state by host.
+        std::chrono::milliseconds mRetryBase{30000};            ///< The delay before the first retry.
+        std::chrono::milliseconds mRetryMaximum{1800000};       ///< The maximum delay between retries.
+        unsigned mRetryLimit{8};                                ///< Attempts before an item is abandoned.
+        unsigned mHostFailureBudget{5};                         ///< Consecutive failures before a host is paused.
+        std::chrono::milliseconds mHostPause{900000};           ///< How long a host is paused.
+        std::mt19937 mRandom{std::random_device{}()};           ///< Source of retry jitter.
+
+        /**
+         * @brief Test if a status is a failure which may succeed if retried.
+         * @param status The status.
+         * @return True for transfer failures, 408, 429 and 5xx responses.
+         */
+        static bool retryable(long status) {
+            return status == 408 || status == 429 || (status >= 500 && status < 600);
+        }
+
+        /**
+         * @brief Extract the host, and port if present, from a URL.
+         * @param url The URL.
+         * @return The host.
+         */
+        static std::string urlHost(const std::string &url);
+
+        /**
+         * @brief Handle a completed fetch: update retry and host state and transmit the result.
+         * @param key The item key.
+         * @param status The fetch status.
+         * @param payload The payload, if any.
+         */
+        void completeFetch(key_t key, long status, const WebCachePayload &payload);
+
+        /**
+         * @brief Start fetches for items whose retry time has passed.
+         */
+        void processRetries();
+
+        /**
+         * @brief Compute the time an item is due to be refreshed.
+         * @details The expiry is the fetch time from the item metadata, or the local file time, plus the cache
+         * valid duration plus a deterministic per item jitter in [0..mRefreshJitter]. Items without a local copy
+         * are due immediately.
+         * @param item The item.
+         * @return The expiry time.
+         */
+        std::chrono::system_clock::time_point computeExpiry(const item_map_t::value_type &item);
+
+        /**
+         * @brief Fetch items whose expiry time has passed.
+         */
+        void refreshExpired();
+
+        /**
+         * @brief Transmit cacheLoaded, and payloadLoaded if payload delivery is enabled.
+         * @param key The item key.
+         * @param status The status.
+         * @param payload The item content, if available.
+         */
+        void transmitLoaded(key_t key, long status, const WebCachePayload &payload = nullptr) {
+            if (mDeliverPayload)
+                payloadLoaded.transmit(key, status, payload);
+            cacheLoaded.transmit(key, status);
+        }
+
+        void asyncFetchItem(item_map_t::value_type& item, bool retrying = false) {
+            // Respect the backoff of an item waiting to be retried.
+            if (auto retry = mRetry.find(item.first); !retrying && retry != mRetry.end() &&
+                    retry->second.nextAttempt > std::chrono::steady_clock::now())
+                return;
+
+            // Hold items from a paused host until the pause ends, whoever asked for the fetch.
+            if (auto host = mHosts.find(urlHost(constructUrl(item.second))); host != mHosts.end() &&
+                    host->second.pausedUntil > std::chrono::steady_clock::now()) {
+                auto &retry = mRetry[item.first];
+                retry.nextAttempt = std::max(retry.nextAttempt, host->second.pausedUntil);
+                transmitLoaded(item.first, CacheHostPaused);
+                return;
+            }
+
             auto itemPath = mStoreRoot;
             auto tempPath = mStoreRoot;
+            auto metaPath = itemMetadataPath(item.second);
             auto itemName = translateItemLocalId(item.second);
             itemPath.append(itemName);
             tempPath.append('.' + itemName);
             if (!itemPath.empty()) {
                 std::optional<time_t> cacheFileTime{};
-                if (exists(itemPath))
-                    if (cacheFileTime = cacheTime(itemPath); !cacheFileTime) {
-                        cacheLoaded.transmit(item.first, 503);
+                WebCacheMetadata metadata{};
+                if (exists(itemPath)) {
+                    metadata.read(metaPath);
+                    if (cacheFileTime = cacheTime(itemPath, metadata); !cacheFileTime) {
+                        mItemExpiry.erase(item.first);
+                        mRetry.erase(item.first);
+                        if (!mServeStale)
+                            transmitLoaded(item.first, 503);
                         return;
                     }
+                }
 
+                touchIndex(itemName, true);
                 mAsyncList.emplace_back(
-                        std::async(std::launch::async, fetch, item.first, constructUrl(item.second), itemPath, tempPath,
-                                   cacheFileTime));
+                        fetchAsync(item.first, constructUrl(item.second), itemPath, tempPath, cacheFileTime,
+                                   metaPath, metadata, mDeliverPayload));
                 CommonSignals::getCommonSignals().frameSignal.connect(mFrameProtocol);
             }
         }
@@ -114,7 +338,7 @@ namespace rose {
     public:
         WebCache() = delete;
 
-        virtual ~WebCache() = default;
+        virtual ~WebCache();
 
         /**
          * @brief Constructor
@@ -185,13 +409,27 @@ namespace rose {
          */
         path itemLocalPath(key_t key) {
             if (auto item = mItemMap.find(key); item != mItemMap.end()) {
+                auto itemName = translateItemLocalId(item->second);
+                if (mIndex.find(itemName) != mIndex.end())
+                    touchIndex(itemName);
                 auto itemPath = mStoreRoot;
-                itemPath.append(translateItemLocalId(item->second));
+                itemPath.append(itemName);
                 return itemPath;
             }
             return path{};
         }
 
+        /**
+         * @brief Get the filesystem path of the metadata sidecar of a local item.
+         * @param localId The item local id.
+         * @return The sidecar path.
+         */
+        path itemMetadataPath(const local_id_t &localId) {
+            auto metaPath = mStoreRoot;
+            metaPath.append('.' + translateItemLocalId(localId) + ".meta");
+            return metaPath;
+        }
+
         /**
          * @brief Get the local path to an item if it is known and exists in the local store.
          * @param key The item key.
@@ -212,15 +450,53 @@ namespace rose {
          * empty std::optional otherwise.
          */
         std::optional<time_t> cacheTime(const path &itemPath) {
+            return cacheTime(itemPath, WebCacheMetadata{});
+        }
+
+        /**
+         * @brief Get the time the item was cached if the cache time has expired.
+         * @details The age of the item is measured from the fetch time in the metadata when it is known, so a
+         * revalidated item is valid for a new period without rewriting the file.
+         * @param itemPath The item path (returned by itemLocalPath()).
+         * @param metadata The item metadata.
+         * @return A time_t expressing the last write time of the local file if cache time has expired, an
+         * empty std::optional otherwise.
+         */
+        std::optional<time_t> cacheTime(const path &itemPath, const WebCacheMetadata &metadata) {
             auto cacheFiletime = fileClockToSystemClock(std::filesystem::last_write_time(itemPath));
-            auto cacheFileAge = std::chrono::system_clock::now() - cacheFiletime;
+            auto validFrom = metadata.fetchTime.time_since_epoch().count() ? metadata.fetchTime : cacheFiletime;
+            auto cacheFileAge = std::chrono::system_clock::now() - validFrom;
             if (cacheFileAge > mCacheValidDuration)
                 return std::chrono::system_clock::to_time_t(cacheFiletime);
             return std::nullopt;
         }
 
         /**
-         * @brief Fetch a cache item.
+         * @brief Queue the fetch of a cache item on the TransferEngine.
+         * @details The item is streamed into tempPath and renamed to itemPath when the server returns a new
+         * copy. When a local copy exists the request is made conditional using the validators in metadata,
+         * falling back to cacheFileTime. The CRC32 of the body is computed while it is streamed, if it matches
+         * the checksum in metadata the local copy is kept and the status is CacheUnchanged. On a 200, 304 or
+         * CacheUnchanged result the metadata is updated and written to metaPath, if it is not empty. The future
+         * is ready when the transfer is complete.
+         * @param key The item key.
+         * @param itemUrl The item url (returned by constructUrl()).
+         * @param itemPath The full item path.
+         * @param tempPath The path the item is streamed to while it is transferred.
+         * @param cacheFileTime The std::optional returned by cacheTime(), empty if there is no local copy.
+         * @param metaPath The path of the metadata sidecar file.
+         * @param metadata The metadata read from the sidecar file.
+         * @param keepPayload If true the body of a new copy is also kept in memory and returned.
+         * @return A future for a tuple containing the returned HTTP status code, the item key and the payload
+         * if it was kept.
+         */
+        static std::future<fetch_result_t>
+        fetchAsync(WebCache::key_t key, const std::string &itemUrl, const path &itemPath, const path &tempPath,
+                   std::optional<time_t> cacheFileTime, const path &metaPath = path{},
+                   WebCacheMetadata metadata = WebCacheMetadata{}, bool keepPayload = false);
+
+        /**
+         * @brief Fetch a cache item, blocking until the transfer is complete.
          * @param key The item key.
          * @param itemUrl The item url (returned by constructUrl()).
          * @param itemPath The full item path.
@@ -252,9 +528,19 @@ namespace rose {
             AsyncList asyncList{};
             std::lock_guard<std::mutex> lockGuard{mMutex};
 
+            if (mServeStale && !mLocalItemsAnnounced) {
+                mLocalItemsAnnounced = true;
+                for (auto &item : mItemMap)
+                    if (auto itemPath = localItemExists(item.first); itemPath)
+                        transmitLoaded(item.first, CacheStale, mDeliverPayload ? readPayload(*itemPath) : nullptr);
+            }
+
             for (auto &item : mItemMap) {
                 asyncFetchItem(item);
             }
+
+            // Record pending fetches so their temp files are found if the fetches are interrupted.
+            saveIndex();
             return !mAsyncList.empty();
         }
 
@@ -262,6 +548,7 @@ namespace rose {
             auto item = mItemMap.find(key);
             if (item != mItemMap.end()) {
                 asyncFetchItem(*item);
+                saveIndex();
             }
             return !mAsyncList.empty();
         }
@@ -270,18 +557,142 @@ namespace rose {
             return !mAsyncList.empty();
         }
 
+        /**
+         * @brief Refresh expired items on a schedule.
+         * @details Each TimerTick minute signal marks a refresh check due, the check runs on the next frame
+         * signal and issues conditional fetches only for items whose expiry has passed. A deterministic per item
+         * jitter spreads the expiry of items, and of items in different caches, so they are not all fetched in
+         * the same second.
+         * @param timerTick The source of minute signals, may be null if the caller calls refreshDue().
+         * @param jitter The maximum delay added to the expiry of an item.
+         */
+        void setRefreshSchedule(std::shared_ptr<TimerTick> timerTick, std::chrono::seconds jitter);
+
+        /**
+         * @brief Serve local copies while they are revalidated.
+         * @details When enabled the first fetchAll() immediately transmits CacheStale for every item with a
+         * local copy, so consumers can use it without waiting for the network. Items are then revalidated in
+         * the background and cacheLoaded is transmitted again only when a new copy is received or the fetch
+         * fails; 304 responses, unchanged copies and items that are still valid are not signaled.
+         * @param serveStale True to enable.
+         */
+        void setServeStale(bool serveStale) {
+            mServeStale = serveStale;
+        }
+
+        /**
+         * @brief Deliver item content in memory.
+         * @details When enabled payloadLoaded is transmitted before each cacheLoaded. For a new copy (200) the
+         * payload is the body kept in memory as it was received, for CacheStale it is the local copy read
+         * once, so consumers can parse it without reading the item back from storage. For other statuses the
+         * payload is null.
+         * @param deliverPayload True to enable.
+         */
+        void setPayloadDelivery(bool deliverPayload) {
+            mDeliverPayload = deliverPayload;
+        }
+
+        /**
+         * @brief Read the content of a file into a payload.
+         * @param filePath The file path.
+         * @return The payload, null if the file could not be read.
+         */
+        static WebCachePayload readPayload(const path &filePath);
+
+        /**
+         * @brief Set the retry policy for failed fetches.
+         * @details Fetches which fail with a transfer failure, 408, 429 or a 5xx status are retried after
+         * an exponential backoff starting at base and doubling to maximum, with a random jitter of up to half
+         * the delay. CacheRetryScheduled is transmitted in place of the failure status. After limit attempts
+         * the failure status is transmitted and the item is not retried until it is fetched again.
+         * @param base The delay before the first retry.
+         * @param maximum The maximum delay.
+         * @param limit The maximum number of attempts.
+         */
+        void setRetryPolicy(std::chrono::milliseconds base, std::chrono::milliseconds maximum, unsigned limit) {
+            mRetryBase = base;
+            mRetryMaximum = maximum;
+            mRetryLimit = limit;
+        }
+
+        /**
+         * @brief Set the per host failure budget.
+         * @details After failures consecutive failed fetches from one host, fetches from that host are paused
+         * for pause and items which fail are signaled with CacheHostPaused. Items from a paused host requested by
+         * fetchAll(), fetchItem() or a scheduled refresh are not fetched, they are signaled with CacheHostPaused
+         * and retried when the pause ends. A successful fetch resets the count.
+         * @param failures The number of consecutive failures allowed.
+         * @param pause How long to pause fetches from the host.
+         */
+        void setHostFailureBudget(unsigned failures, std::chrono::milliseconds pause) {
+            mHostFailureBudget = failures;
+            mHostPause = pause;
+        }
+
+        /**
+         * @brief Limit the size of the backing store.
+         * @details The store is brought within budget immediately and after each new item is received. Items
+         * are removed least recently accessed first, access is recorded when an item is fetched or its path is
+         * requested with itemLocalPath() or localItemExists(). Items no longer managed by the cache are removed
+         * first.
+         * @param maxBytes The maximum total size of items, 0 for no limit.
+         * @param maxItems The maximum number of items, 0 for no limit.
+         */
+        void setStoreBudget(std::uintmax_t maxBytes, size_t maxItems);
+
+        /**
+         * @brief Get the total size and number of items in the backing store according to the index.
+         * @return A pair holding the total size and the number of items.
+         */
+        std::pair<std::uintmax_t, size_t> storeUsage() const {
+            std::uintmax_t bytes = 0;
+            for (auto &entry : mIndex)
+                bytes += entry.second.size;
+            return std::make_pair(bytes, mIndex.size());
+        }
+
+        /**
+         * @brief Test if fetches are waiting to be retried.
+         * @return True if any item is waiting to be retried.
+         */
+        bool pendingRetries() const {
+            return !mRetry.empty();
+        }
+
+        /**
+         * @brief Mark a refresh check due on the next frame. Safe to call from any thread.
+         */
+        void refreshDue() {
+            mRefreshDue = true;
+        }
+
+        /**
+         * @brief Get the time an item is next due to be refreshed.
+         * @param key The item key.
+         * @return The expiry time if the item is known.
+         */
+        std::optional<std::chrono::system_clock::time_point> itemExpiry(key_t key) {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            if (auto item = mItemMap.find(key); item != mItemMap.end()) {
+                if (auto expiry = mItemExpiry.find(key); expiry != mItemExpiry.end())
+                    return expiry->second;
+                return mItemExpiry[key] = computeExpiry(*item);
+            }
+            return std::nullopt;
+        }
+
         bool processFutures() {
             if (mAsyncList.empty())
                 return false;
 
             std::lock_guard<std::mutex> lockGuard{mMutex};
-            std::chrono::milliseconds span{100};
             for (auto &item : mAsyncList) {
                 try {
                     if (item.valid()) {
-                        if (auto futureStatus = item.wait_for(span); futureStatus == std::future_status::ready) {
-                            auto[status, key] = item.get();
-                            cacheLoaded.transmit(key,status);
+                        if (auto futureStatus = item.wait_for(std::chrono::milliseconds{0});
+                                futureStatus == std::future_status::ready) {
+                            auto[status, key, payload] = item.get();
+                            completeFetch(key, status, payload);
                         }
                     }
                 } catch (const std::exception &e) {
@@ -290,9 +701,14 @@ namespace rose {
             }
 
             mAsyncList.erase(std::remove_if(mAsyncList.begin(), mAsyncList.end(),
-                                           [](std::future<result_t> &f) -> bool { return !f.valid(); }),
+                                           [](std::future<fetch_result_t> &f) -> bool { return !f.valid(); }),
                             mAsyncList.end());
 
+            if (mAsyncList.empty()) {
+                enforceBudget();
+                saveIndex();
+            }
+
             return !mAsyncList.empty();
         }
     };
@@ -0,0 +1,186 @@
+/**
+ * @file WorkerPool.cpp
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-07-04
+ */
+
+#include "WorkerPool.h"
+#include <algorithm>
+
+namespace rose {
+
+    WorkerPool::WorkerPool(size_t threadCount, bool connectFrameSignal) {
+        if (!threadCount)
+            threadCount = defaultThreadCount();
+        for (size_t n = 0; n < threadCount; ++n)
+            mThreads.emplace_back(&WorkerPool::run, this);
+
+        if (connectFrameSignal) {
+            mFrameProtocol = GraphicsModelFrameProtocol::createSlot();
+            mFrameProtocol->receiver = [this](uint32_t) {
+                processContinuations();
+            };
+            CommonSignals::getCommonSignals().frameSignal.connect(mFrameProtocol);
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            mRun = false;
+        }
+        mCondition.notify_all();
+        for (auto &thread : mThreads)
+            if (thread.joinable())
+                thread.join();
+    }
+
+    size_t WorkerPool::defaultThreadCount() {
+        auto cores = static_cast<size_t>(std::thread::hardware_concurrency());
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    size_t WorkerPool::queued() const {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return mQueue.size();
+    }
+
+    WorkerPool::Statistics WorkerPool::statistics() const {
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        return mStatistics;
+    }
+
+    void WorkerPool::enqueue(TaskPriority priority, CancellationToken token, std::function<void()> run,
+                             std::function<void()> cancelled) {
+        {
+            std::lock_guard<std::mutex> lockGuard{mMutex};
+            Task task{};
+            task.priority = priority;
+            task.sequence = mSequence++;
+            task.token = std::move(token);
+            task.run = std::move(run);
+            task.cancelled = std::move(cancelled);
+            mQueue.push(std::move(task));
+            mStatistics.maxQueued = std::max(mStatistics.maxQueued, mQueue.size());
+        }
+        mCondition.notify_one();
+    }
+
+    void WorkerPool::run() {
+        while (true) {
+            Task task{};
+            {
+                std::unique_lock<std::mutex> lock{mMutex};
+                mCondition.wait(lock, [this] { return !mRun || !mQueue.empty(); });
+                if (!mRun)
+                    break;
+                task = mQueue.top();
+                mQueue.pop();
+                if (task.token.cancelled())
+                    ++mStatistics.tasksCancelled;
+                else
+                    ++mStatistics.tasksRun;
+            }
+
+            if (task.token.cancelled()) {
+                if (task.cancelled)
+                    task.cancelled();
+            } else {
+                task.run();
+            }
+        }
+    }
+
+    void WorkerPool::postContinuation(std::function<void()> continuation) {
+        std::lock_guard<std::mutex> lockGuard{mContinuationMutex};
+        mContinuations.emplace_back(std::move(continuation));
+        mContinuationCount = mContinuations.size();
+    }
+
+    size_t WorkerPool::processContinuations() {
+        if (!mContinuationCount)
+            return 0;
+
+        std::vector<std::function<void()>> continuations{};
+        {
+            std::lock_guard<std::mutex> lockGuard{mContinuationMutex};
+            continuations.swap(mContinuations);
+            mContinuationCount = 0;
+        }
+
+        for (auto &continuation : continuations) {
+            try {
+                continuation();
+            } catch (const std::exception &e) {
+                std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
+            }
+        }
+
+        std::lock_guard<std::mutex> lockGuard{mMutex};
+        mStatistics.continuationsRun += continuations.size();
+        return continuations.size();
+    }
+
+    bool WorkerPool::parallelFor(int count, const std::function<bool(int, int)> &rangeFunction,
+                                 TaskPriority priority) {
+        if (count <= 0)
+            return true;
+
+        // Several chunks per thread so a slow chunk does not leave the other threads idle.
+        struct State {
+            std::function<bool(int, int)> function{};
+            int count{0};
+            int chunk{1};
+            int next{0};
+            int running{0};
+            bool result{true};
+            std::mutex mutex{};
+            std::condition_variable condition{};
+        };
+
+        auto state = std::make_shared<State>();
+        state->function = rangeFunction;
+        state->count = count;
+        state->chunk = std::max(1, count / static_cast<int>(4 * (threadCount() + 1)));
+
+        auto claimChunks = [state]() {
+            while (true) {
+                int begin;
+                {
+                    std::lock_guard<std::mutex> lockGuard{state->mutex};
+                    if (state->next >= state->count || !state->result)
+                        return;
+                    begin = state->next;
+                    state->next = std::min(state->count, begin + state->chunk);
+                    ++state->running;
+                }
+
+                bool result = false;
+                try {
+                    result = state->function(begin, std::min(state->count, begin + state->chunk));
+                } catch (const std::exception &e) {
+                    std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
+                }
+
+                {
+                    std::lock_guard<std::mutex> lockGuard{state->mutex};
+                    --state->running;
+                    state->result &= result;
+                }
+                state->condition.notify_all();
+            }
+        };
+
+        auto helpers = std::min(threadCount(), static_cast<size_t>((count + state->chunk - 1) / state->chunk));
+        for (size_t n = 1; n < helpers; ++n)
+            enqueue(priority, CancellationToken{}, claimChunks, {});
+
+        // Helpers which start after the last chunk is claimed find nothing to do, so only running chunks
+        // are waited on.
+        claimChunks();
+        std::unique_lock<std::mutex> lock{state->mutex};
+        state->condition.wait(lock, [&state] { return state->running == 0; });
+        return state->result;
+    }
+}
@@ -0,0 +1,264 @@
+/**
+ * @file WorkerPool.h
+ * @author Richard Buckley <richard.buckley@ieee.org>
+ * @version 1.0
+ * @date 2021-07-04
+ * @brief A bounded pool of worker threads for CPU bound background work, with priorities, cancellation
+ * and continuations run on the main thread.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "CommonSignals.h"
+
+namespace rose {
+
+    /**
+     * @enum TaskPriority
+     * @brief The priority of a WorkerPool task. Queued tasks of higher priority start first.
+     */
+    enum class TaskPriority : int {
+        Low,            ///< Bulk work where latency does not matter.
+        Normal,         ///< Work which updates what is displayed.
+        High,           ///< Work the user is waiting for.
+    };
+
+    /**
+     * @class TaskCancelled
+     * @brief The exception a task future holds when the task was cancelled before it started.
+     */
+    class TaskCancelled : public std::runtime_error {
+    public:
+        TaskCancelled() : std::runtime_error("Task cancelled.") {}
+    };
+
+    /**
+     * @class CancellationToken
+     * @brief A shared cancellation flag.
+     * @details Copies share the flag. A task is not started if its token is cancelled while it is queued, and
+     * its continuation is not run if the token is cancelled before the continuation is. A running task may
+     * poll cancelled() to abandon work early.
+     */
+    class CancellationToken {
+        std::shared_ptr<std::atomic_bool> mCancelled{std::make_shared<std::atomic_bool>(false)};
+
+    public:
+        /// Cancel all work holding a copy of this token.
+        void cancel() { *mCancelled = true; }
+
+        /// True if cancel() has been called on any copy.
+        [[nodiscard]] bool cancelled() const { return *mCancelled; }
+
+        /// The flag, for code which polls a std::atomic_bool.
+        [[nodiscard]] const std::atomic_bool &flag() const { return *mCancelled; }
+    };
+
+    /**
+     * @class WorkerPool
+     * @brief Run CPU bound background work on a fixed number of threads.
+     * @details The pool is sized to leave a core for the main (render) thread, so background work does not
+     * oversubscribe the cores and starve the frame loop. Tasks are queued by priority, and first in first out
+     * within a priority. Continuations are queued by worker threads and run on the main thread when
+     * CommonSignals::frameSignal is transmitted, or by calling processContinuations(). Work which waits on
+     * I/O belongs on the TransferEngine, not here.
+     */
+    class WorkerPool {
+    public:
+        /**
+         * @struct Statistics
+         * @brief Totals over the life of the pool.
+         */
+        struct Statistics {
+            size_t tasksRun{0};                 ///< Tasks run to completion or exception.
+            size_t tasksCancelled{0};           ///< Tasks dropped because their token was cancelled.
+            size_t continuationsRun{0};         ///< Continuations run on the main thread.
+            size_t maxQueued{0};                ///< The largest number of tasks waiting to start.
+        };
+
+    protected:
+        /// A queued task.
+        struct Task {
+            TaskPriority priority{TaskPriority::Normal};
+            uint64_t sequence{0};
+            CancellationToken token{};
+            std::function<void()> run{};
+            std::function<void()> cancelled{};
+
+            /// Order for std::priority_queue: higher priority, then lower sequence, on top.
+            bool operator<(const Task &other) const {
+                if (priority != other.priority)
+                    return priority < other.priority;
+                return sequence > other.sequence;
+            }
+        };
+
+        std::vector<std::thread> mThreads{};        ///< The worker threads.
+        mutable std::mutex mMutex{};                ///< Protect the queue and statistics.
+        std::condition_variable mCondition{};       ///< Wake idle workers.
+        std::priority_queue<Task> mQueue{};         ///< Tasks waiting to start.
+        uint64_t mSequence{0};                      ///< Sequence number of the next task.
+        bool mRun{true};                            ///< Cleared to stop the workers.
+        Statistics mStatistics{};                   ///< Totals over the life of the pool.
+
+        std::mutex mContinuationMutex{};            ///< Protect the continuation queue.
+        std::vector<std::function<void()>> mContinuations{};    ///< Continuations waiting for the main thread.
+        std::atomic_size_t mContinuationCount{0};   ///< The size of mContinuations, read without locking.
+
+        GraphicsModelFrameProtocol::slot_type mFrameProtocol{};  ///< Run continuations each frame.
+
+        /// A worker thread.
+        void run();
+
+        /// Queue a task.
+        void enqueue(TaskPriority priority, CancellationToken token, std::function<void()> run,
+                     std::function<void()> cancelled);
+
+    public:
+        /**
+         * @brief Constructor.
+         * @param threadCount The number of worker threads, 0 for defaultThreadCount().
+         * @param connectFrameSignal If true continuations are run from CommonSignals::frameSignal.
+         */
+        explicit WorkerPool(size_t threadCount = 0, bool connectFrameSignal = true);
+
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+
+        WorkerPool(WorkerPool&&) = delete;
+
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        WorkerPool& operator=(WorkerPool&&) = delete;
+
+        /// Get the library wide pool.
+        static WorkerPool& getWorkerPool() {
+            static WorkerPool instance{};
+            return instance;
+        }
+
+        /// The number of cores less one for the main thread, and at least one.
+        static size_t defaultThreadCount();
+
+        /// The number of worker threads.
+        [[nodiscard]] size_t threadCount() const { return mThreads.size(); }
+
+        /// The number of tasks waiting to start.
+        [[nodiscard]] size_t queued() const;
+
+        /// Get the totals over the life of the pool.
+        [[nodiscard]] Statistics statistics() const;
+
+        /**
+         * @brief Queue work and get a future for the result.
+         * @details If the token is cancelled before the work starts it is not run and the future holds
+         * TaskCancelled. An exception thrown by the work is delivered through the future.
+         * @param work A callable taking no arguments.
+         * @param priority The task priority.
+         * @param token The cancellation token.
+         * @return A std::future for the result of work. Unlike a std::async future it does not block when it
+         * is destroyed.
+         */
+        template<class Work>
+        auto submit(Work &&work, TaskPriority priority = TaskPriority::Normal,
+                    CancellationToken token = CancellationToken{}) -> std::future<std::invoke_result_t<Work>> {
+            using Result = std::invoke_result_t<Work>;
+            auto promise = std::make_shared<std::promise<Result>>();
+            auto future = promise->get_future();
+            enqueue(priority, std::move(token),
+                    [promise, work = std::forward<Work>(work)]() mutable {
+                        try {
+                            if constexpr (std::is_void_v<Result>) {
+                                work();
+                                promise->set_value();
+                            } else {
+                                promise->set_value(work());
+                            }
+                        } catch (...) {
+                            promise->set_exception(std::current_exception());
+                        }
+                    },
+                    [promise]() {
+                        promise->set_exception(std::make_exception_ptr(TaskCancelled{}));
+                    });
+            return future;
+        }
+
+        /**
+         * @brief Queue work with a continuation run on the main thread with its result.
+         * @details The continuation is not run if the token is cancelled before it runs, so an object which
+         * owns the token may safely capture this in the continuation and cancel the token in its destructor.
+         * If the work throws the exception is reported and the continuation is not run.
+         * @param work A callable taking no arguments.
+         * @param continuation A callable taking the result of work, or no arguments if work returns void.
+         * @param priority The task priority.
+         * @param token The cancellation token.
+         */
+        template<class Work, class Continuation>
+        void submitWithContinuation(Work &&work, Continuation &&continuation, TaskPriority priority = TaskPriority::Normal,
+                    CancellationToken token = CancellationToken{}) {
+            using Result = std::invoke_result_t<Work>;
+            enqueue(priority, token,
+                    [this, token, work = std::forward<Work>(work),
+                     continuation = std::forward<Continuation>(continuation)]() mutable {
+                        try {
+                            if constexpr (std::is_void_v<Result>) {
+                                work();
+                                postContinuation([token, continuation = std::move(continuation)]() mutable {
+                                    if (!token.cancelled())
+                                        continuation();
+                                });
+                            } else {
+                                postContinuation([token, continuation = std::move(continuation),
+                                                  result = work()]() mutable {
+                                    if (!token.cancelled())
+                                        continuation(std::move(result));
+                                });
+                            }
+                        } catch (const std::exception &e) {
+                            std::cerr << __PRETTY_FUNCTION__ << ' ' << e.what() << '\n';
+                        }
+                    }, {});
+        }
+
+        /**
+         * @brief Queue a function to run on the main thread at the start of the next frame. Safe to call from
+         * any thread.
+         * @param continuation The function.
+         */
+        void postContinuation(std::function<void()> continuation);
+
+        /**
+         * @brief Run the queued continuations. Main thread only.
+         * @details Called each frame from CommonSignals::frameSignal. Continuations queued while running are
+         * left for the next call.
+         * @return The number of continuations run.
+         */
+        size_t processContinuations();
+
+        /**
+         * @brief Run a function over ranges of [0, count) on the pool and the calling thread.
+         * @details The range is split into chunks which the calling thread and up to threadCount() workers
+         * claim until none remain. The calling thread only waits on chunks already running, so it is safe to
+         * call from a task running on the pool. Once a call returns false no further chunks are started.
+         * @param count The size of the range.
+         * @param rangeFunction The function, called with the first and one past the last index of a chunk.
+         * @param priority The priority of the helper tasks.
+         * @return True if every call to rangeFunction returned true.
+         */
+        bool parallelFor(int count, const std::function<bool(int, int)> &rangeFunction,
+                         TaskPriority priority = TaskPriority::Normal);
+    };
+}
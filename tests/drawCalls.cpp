@@ -0,0 +1,72 @@
+//
+// Created by richard on 2021-06-30.
+//
+
+/**
+ * @file drawCalls.cpp
+ * @brief Compare SDL draw calls, texture changes and frame time for a grid of TextButtons drawn directly and
+ * through the Context command list.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include "Application.h"
+#include "Button.h"
+#include "Manager.h"
+#include "Theme.h"
+
+using namespace rose;
+
+static constexpr int GridColumns = 8;
+static constexpr int GridRows = 6;
+static constexpr int FrameCount = 100;
+
+/**
+ * @class DrawCallBenchmark
+ * @brief An Application which redraws the whole screen a number of times and reports the Context counters.
+ */
+class DrawCallBenchmark : public Application {
+public:
+    DrawCallBenchmark(int argc, char **argv) : Application(argc, argv) {}
+
+    void measure(const std::string &name, bool deferred) {
+        mGraphicsModel.setDeferredRendering(deferred);
+        context().resetRenderStateCounters();
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < FrameCount; ++frame) {
+            mGraphicsModel.redrawBackground();
+            mGraphicsModel.drawAll(mScreen);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+
+        auto counters = context().renderStateCounters();
+        std::cout << std::setw(10) << std::left << name
+                  << " draw calls/frame: " << std::setw(6) << counters.drawCalls / FrameCount
+                  << " texture changes/frame: " << std::setw(6) << counters.textureChanges / FrameCount
+                  << " batches/frame: " << std::setw(6) << counters.batches / FrameCount
+                  << " state calls/frame: " << std::setw(6) << counters.issued / FrameCount
+                  << " frame time: " << elapsed.count() / FrameCount << "us\n";
+    }
+};
+
+int main(int argc, char **argv) {
+    Environment &environment{Environment::getEnvironment()};
+    DrawCallBenchmark application{argc, argv};
+
+    application.initialize(environment.appName(), Size{800, 480});
+
+    Theme &theme{Theme::getTheme()};
+    std::shared_ptr<Grid> grid{};
+    application.screen() << wdg<Window>()
+                         << wdg<Grid>(GridColumns) >> grid;
+
+    for (int i = 0; i < GridColumns * GridRows; ++i)
+        grid << wdg<TextButton>(std::string{"Btn "} + std::to_string(i)) << theme.SemiBevelFrame << endw;
+
+    application.layout();
+
+    std::cout << GridColumns * GridRows << " TextButtons, " << FrameCount << " frames\n";
+    application.measure("Direct", false);
+    application.measure("Deferred", true);
+}
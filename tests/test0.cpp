@@ -44,7 +44,8 @@ int main(int argc, char **argv) {
                          << wdg<TextButton>(Id{"lblHello"}, [&](ButtonStateChange buttonStateChange){
                                  if (buttonStateChange == rose::ButtonStateChange::Pushed) {
                                      std::cout << "Local Button state: Pushed\n";
-                                     application.screen() << wdg<Dialog>()
+                                     auto dialog = wdg<Dialog>();
+                                     application.screen() << dialog
                                                           << Position<int>{}
                                                           << wdg<Column>() >> column
                                                           << wdg<Grid>(2)
@@ -59,7 +60,7 @@ int main(int argc, char **argv) {
                                                             << RegexPattern{FloatPattern} << endw;
 //                                     if (!application.keyboardFound())
                                          column << wdg<Keyboard>();
-                                     application.layout();
+                                     application.layout(dialog);
                                  }
                              })
                             << theme.SemiBevelFrame